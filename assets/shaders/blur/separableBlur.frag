@@ -0,0 +1,35 @@
+#version 430 core
+
+#include "targetUV.glsl"
+
+// One direction of a separable Gaussian, using the bilinear merged taps of BlurKernel.
+// MAX_RADIUS is injected by SeparableBlur.
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUVScale;     // Used part of the source
+uniform vec2 texelStep;         // One target texel along the blur direction, in source texture coordinates
+uniform int tapCount;           // Merged taps on one side, center included
+uniform float weights[MAX_RADIUS + 1];
+uniform float offsets[MAX_RADIUS + 1];
+
+vec3 Sample(vec2 uv)
+{
+    return texture(sourceTexture, ClampToUsed(sourceTexture, uv, sourceUVScale)).rgb;
+}
+
+void main()
+{
+    vec2 uv = TexCoords * sourceUVScale;
+
+    vec3 result = Sample(uv) * weights[0];
+    for (int i = 1; i < tapCount; ++i)
+    {
+        vec2 offset = texelStep * offsets[i];
+        result += (Sample(uv + offset) + Sample(uv - offset)) * weights[i];
+    }
+
+    FragColor = vec4(result, 1.0);
+}
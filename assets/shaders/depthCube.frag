@@ -0,0 +1,10 @@
+#version 430 core
+
+in vec3 fWorldPos;
+flat in vec4 fLight;
+
+void main()
+{
+    // Linear distance to the light, normalized by its range, independent of the face
+    gl_FragDepth = distance(fWorldPos, fLight.xyz) / fLight.w;
+}
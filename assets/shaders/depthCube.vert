@@ -0,0 +1,17 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+
+#define MAX_CUBES 8
+
+uniform mat4 modelMatrix;
+// Cube of every instance, a caster is drawn once per point light that can see it
+uniform int cubeSlots[MAX_CUBES];
+
+out vec3 gWorldPos;
+flat out int gCube;
+
+void main()
+{
+    gWorldPos = vec3(modelMatrix * vec4(aPos, 1.0));
+    gCube = cubeSlots[gl_InstanceID];
+}
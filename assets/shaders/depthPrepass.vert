@@ -0,0 +1,12 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 mvpMatrix;
+
+// Must match vertex.vert bit for bit, the lit pass tests against this depth
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = mvpMatrix * vec4(aPos, 1.0);
+}
@@ -0,0 +1,89 @@
+#version 430 core
+
+#include "targetUV.glsl"
+
+// 13-tap downsample from "Next Generation Post Processing in Call of Duty: Advanced Warfare".
+// The first pass (prefilter) reads the full resolution scene and applies the brightness threshold.
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUVScale;     // Used part of the source
+
+uniform bool prefilter;
+uniform float threshold = 1.0;
+uniform float knee = 0.5;       // Width of the soft threshold, in brightness units
+
+float Luminance(vec3 color)
+{
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+vec3 Sample(vec2 uv)
+{
+    return texture(sourceTexture, ClampToUsed(sourceTexture, uv, sourceUVScale)).rgb;
+}
+
+vec3 Threshold(vec3 color)
+{
+    // Quadratic knee around the threshold instead of a hard cut, so the bloom does not pop
+    float brightness = Luminance(color);
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 1e-4);
+    float contribution = max(soft, brightness - threshold) / max(brightness, 1e-4);
+    return color * contribution;
+}
+
+// Karis average: weighs each box by 1 / (1 + luma), so single very bright pixels do not flicker
+vec3 KarisAverage(vec3 box, inout float weightSum, float boxWeight)
+{
+    float weight = boxWeight / (1.0 + Luminance(box));
+    weightSum += weight;
+    return box * weight;
+}
+
+void main()
+{
+    vec2 uv = TexCoords * sourceUVScale;
+    vec2 texel = 1.0 / vec2(textureSize(sourceTexture, 0));
+
+    vec3 a = Sample(uv + texel * vec2(-2.0,  2.0));
+    vec3 b = Sample(uv + texel * vec2( 0.0,  2.0));
+    vec3 c = Sample(uv + texel * vec2( 2.0,  2.0));
+    vec3 d = Sample(uv + texel * vec2(-2.0,  0.0));
+    vec3 e = Sample(uv);
+    vec3 f = Sample(uv + texel * vec2( 2.0,  0.0));
+    vec3 g = Sample(uv + texel * vec2(-2.0, -2.0));
+    vec3 h = Sample(uv + texel * vec2( 0.0, -2.0));
+    vec3 i = Sample(uv + texel * vec2( 2.0, -2.0));
+    vec3 j = Sample(uv + texel * vec2(-1.0,  1.0));
+    vec3 k = Sample(uv + texel * vec2( 1.0,  1.0));
+    vec3 l = Sample(uv + texel * vec2(-1.0, -1.0));
+    vec3 m = Sample(uv + texel * vec2( 1.0, -1.0));
+
+    // Five overlapping 2x2 boxes: the center one weighs 0.5, the corner ones 0.125 each
+    vec3 center = (j + k + l + m) * 0.25;
+    vec3 topLeft = (a + b + d + e) * 0.25;
+    vec3 topRight = (b + c + e + f) * 0.25;
+    vec3 bottomLeft = (d + e + g + h) * 0.25;
+    vec3 bottomRight = (e + f + h + i) * 0.25;
+
+    vec3 result;
+    if (prefilter)
+    {
+        float weightSum = 0.0;
+        result  = KarisAverage(center, weightSum, 0.5);
+        result += KarisAverage(topLeft, weightSum, 0.125);
+        result += KarisAverage(topRight, weightSum, 0.125);
+        result += KarisAverage(bottomLeft, weightSum, 0.125);
+        result += KarisAverage(bottomRight, weightSum, 0.125);
+        result = Threshold(result / weightSum);
+    }
+    else
+    {
+        result = center * 0.5 + (topLeft + topRight + bottomLeft + bottomRight) * 0.125;
+    }
+
+    FragColor = vec4(result, 1.0);
+}
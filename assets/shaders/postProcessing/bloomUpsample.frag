@@ -0,0 +1,31 @@
+#version 430 core
+
+#include "targetUV.glsl"
+
+// 3x3 tent filter upsample, added on top of the next larger mip with additive blending.
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUVScale;     // Used part of the source
+uniform float filterRadius = 1.0;   // In source texels
+
+vec3 Sample(vec2 uv)
+{
+    return texture(sourceTexture, ClampToUsed(sourceTexture, uv, sourceUVScale)).rgb;
+}
+
+void main()
+{
+    vec2 uv = TexCoords * sourceUVScale;
+    vec2 offset = filterRadius / vec2(textureSize(sourceTexture, 0));
+
+    vec3 result = Sample(uv) * 4.0;
+    result += (Sample(uv + vec2(-offset.x, 0.0)) + Sample(uv + vec2(offset.x, 0.0)) +
+               Sample(uv + vec2(0.0, -offset.y)) + Sample(uv + vec2(0.0, offset.y))) * 2.0;
+    result += Sample(uv + vec2(-offset.x, -offset.y)) + Sample(uv + vec2(offset.x, -offset.y)) +
+              Sample(uv + vec2(-offset.x, offset.y)) + Sample(uv + vec2(offset.x, offset.y));
+
+    FragColor = vec4(result / 16.0, 1.0);
+}
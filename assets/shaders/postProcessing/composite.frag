@@ -1,15 +1,15 @@
 #version 430 core
 
+#include "targetUV.glsl"
+#include "stages/bloomCompositeStage.glsl"
+
 in vec2 TexCoords;
 out vec4 FragColor;
 
 uniform sampler2D sceneTexture;
-uniform sampler2D bloomTexture;
 
 void main()
 {
-    vec4 sceneResult = texture(sceneTexture, TexCoords);
-    vec4 bloomResult = texture(bloomTexture, TexCoords);
-
-    FragColor = sceneResult + bloomResult;
-}
\ No newline at end of file
+    vec4 sceneResult = texture(sceneTexture, TargetUV(sceneTexture));
+    FragColor = BloomCompositeStage(sceneResult, TexCoords);
+}
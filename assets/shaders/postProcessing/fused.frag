@@ -0,0 +1,30 @@
+#version 430 core
+
+// Uber-pass for a run of per-pixel post-processing effects, built by PostProcessingManager.
+// Every stage file declares its uniforms and a vec4 Stage(vec4 color, vec2 screenUV) function.
+// FUSED_STAGES is defined per effect chain as the stage calls in order; the stages a chain
+// does not call are compiled out along with their uniforms.
+
+#include "targetUV.glsl"
+#include "stages/bloomCompositeStage.glsl"
+#include "stages/invertStage.glsl"
+#include "stages/fogStage.glsl"
+
+#ifndef FUSED_STAGES
+#define FUSED_STAGES
+#endif
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D inputTexture;
+
+void main()
+{
+    vec2 screenUV = TexCoords;
+    vec4 color = texture(inputTexture, TargetUV(inputTexture));
+
+    FUSED_STAGES
+
+    FragColor = color;
+}
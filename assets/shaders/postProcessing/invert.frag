@@ -1,5 +1,8 @@
 #version 430 core
 
+#include "targetUV.glsl"
+#include "stages/invertStage.glsl"
+
 in vec2 TexCoords;
 out vec4 FragColor;
 
@@ -7,7 +10,7 @@ uniform sampler2D inputTexture;
 
 void main()
 {
-    vec4 color = texture(inputTexture, TexCoords);
+    vec4 color = texture(inputTexture, TargetUV(inputTexture));
 
-    FragColor = vec4(1 - color.rgb, 1);
-}
\ No newline at end of file
+    FragColor = InvertStage(color, TexCoords);
+}
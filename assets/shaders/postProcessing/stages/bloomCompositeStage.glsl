@@ -0,0 +1,15 @@
+// bloomCompositeStage.glsl - Per-pixel part of BloomEffect, adds the blurred bright pixels over the scene
+#pragma once
+
+#include "targetUV.glsl"
+
+uniform sampler2D bloomTexture;     // Half resolution, top of the bloom mip chain
+uniform vec2 bloomUVScale;          // Used part of the bloom texture
+uniform float bloomIntensity = 1.0;
+uniform bool bloomOnly;             // Debug view without the scene
+
+vec4 BloomCompositeStage(vec4 color, vec2 screenUV)
+{
+    vec3 bloomResult = texture(bloomTexture, ClampToUsed(bloomTexture, screenUV * bloomUVScale, bloomUVScale)).rgb * bloomIntensity;
+    return bloomOnly ? vec4(bloomResult, 1.0) : vec4(color.rgb + bloomResult, color.a);
+}
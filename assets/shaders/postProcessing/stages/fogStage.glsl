@@ -0,0 +1,67 @@
+// fogStage.glsl - Per-pixel part of FogEffect, blends towards the fog color by scene depth
+#pragma once
+
+#include "targetUV.glsl"
+
+uniform sampler2D depthTexture;
+
+uniform vec3 fogColor = vec3(0.5, 0.6, 0.7);
+uniform float fogDensity = 0.05;
+uniform float fogStart = 10.0;
+uniform float fogEnd = 100.0;
+uniform int fogMode = 0; // 0 = Linear, 1 = Exponential, 2 = Exponential Squared
+uniform int fogDebugMode = 0; // 0 = Normal, 1 = Depth, 2 = Linear Depth, 3 = Fog Factor
+
+uniform float fogNearPlane = 0.1;
+uniform float fogFarPlane = 1000.0;
+
+// Linearize depth from [0,1] to actual view-space depth
+float LinearizeDepth(float depth)
+{
+    float z = depth * 2.0 - 1.0; // Back to NDC 
+    return (2.0 * fogNearPlane * fogFarPlane) / (fogFarPlane + fogNearPlane - z * (fogFarPlane - fogNearPlane));
+}
+
+float CalculateFogFactor(float depth)
+{
+    float fogFactor = 0.0;
+    
+    if (fogMode == 0) // Linear
+    {
+        fogFactor = (fogEnd - depth) / (fogEnd - fogStart);
+    }
+    else if (fogMode == 1) // Exponential
+    {
+        fogFactor = exp(-fogDensity * depth);
+    }
+    else if (fogMode == 2) // Exponential Squared
+    {
+        fogFactor = exp(-pow(fogDensity * depth, 2.0));
+    }
+    
+    return clamp(fogFactor, 0.0, 1.0);
+}
+
+vec4 FogStage(vec4 color, vec2 screenUV)
+{
+    float depth = texture(depthTexture, TargetUV(depthTexture)).r;
+    
+    // Debug modes
+    if (fogDebugMode == 1) // Raw depth
+        return vec4(vec3(depth), 1.0);
+    
+    // Linearize depth
+    float linearDepth = LinearizeDepth(depth);
+    
+    if (fogDebugMode == 2) // Linearized depth (normalized for visualization)
+        return vec4(vec3(linearDepth / fogFarPlane), 1.0);
+    
+    // Calculate fog factor
+    float fogFactor = CalculateFogFactor(linearDepth);
+    
+    if (fogDebugMode == 3) // Fog factor
+        return vec4(vec3(fogFactor), 1.0);
+    
+    // Mix scene color with fog color
+    return vec4(mix(fogColor, color.rgb, fogFactor), color.a);
+}
@@ -0,0 +1,7 @@
+// invertStage.glsl - Per-pixel part of InvertEffect
+#pragma once
+
+vec4 InvertStage(vec4 color, vec2 screenUV)
+{
+    return vec4(1 - color.rgb, 1);
+}
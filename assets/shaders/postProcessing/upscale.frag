@@ -0,0 +1,34 @@
+#version 430 core
+
+// Stretches the used part of a lower resolution frame over the viewport, see DynamicResolution.
+// Bilinear filtering softens the image, an unsharp mask over the four source neighbours brings the
+// edges back. The result is clamped to the neighbourhood so the sharpening cannot ring.
+
+#include "targetUV.glsl"
+
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D sourceTexture;
+uniform vec2 sourceUVScale;         // Used part of the source
+uniform float sharpness = 0.5;
+
+void main()
+{
+    vec2 uv = ClampToUsed(sourceTexture, TexCoords * sourceUVScale, sourceUVScale);
+    vec2 texel = 1.0 / vec2(textureSize(sourceTexture, 0));
+
+    vec4 center = texture(sourceTexture, uv);
+    vec3 north = texture(sourceTexture, ClampToUsed(sourceTexture, uv + vec2(0.0, texel.y), sourceUVScale)).rgb;
+    vec3 south = texture(sourceTexture, ClampToUsed(sourceTexture, uv - vec2(0.0, texel.y), sourceUVScale)).rgb;
+    vec3 east = texture(sourceTexture, ClampToUsed(sourceTexture, uv + vec2(texel.x, 0.0), sourceUVScale)).rgb;
+    vec3 west = texture(sourceTexture, ClampToUsed(sourceTexture, uv - vec2(texel.x, 0.0), sourceUVScale)).rgb;
+
+    vec3 minimum = min(center.rgb, min(min(north, south), min(east, west)));
+    vec3 maximum = max(center.rgb, max(max(north, south), max(east, west)));
+
+    vec3 blurred = (north + south + east + west) * 0.25;
+    vec3 sharpened = center.rgb + (center.rgb - blurred) * sharpness;
+
+    FragColor = vec4(clamp(sharpened, minimum, maximum), center.a);
+}
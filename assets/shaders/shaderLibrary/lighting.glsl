@@ -1,27 +1,104 @@
 // lighting.glsl - Reusable lighting functions
+#pragma once
 
+// Shadow atlas holding the depth tiles of every shadowing light, and the point light
+// shadow cubes storing the distance to the light divided by its range.
+// SHADOW_LEGACY_PCF reads raw depth, otherwise the samplers compare in hardware.
+#ifdef SHADOW_LEGACY_PCF
 uniform sampler2D shadowMap;
+uniform samplerCubeArray pointShadowMaps;
+#else
+uniform sampler2DShadow shadowMap;
+uniform samplerCubeArrayShadow pointShadowMaps;
+#endif
 
 layout(std140, binding = 0) uniform LightBlock
 {
-    vec4 positions[4];
-    vec4 directions[4];
-    vec4 colors[4];     // .rgb = color, .w = intensity
-    ivec4 lightTypes[4];
-    int numLights;
+    mat4 viewMatrix;
+    uvec4 clusterGrid;      // xyz = cluster counts
+    vec4 clusterParams;     // xy = tile size in pixels, z = slice scale, w = slice bias
+    ivec4 lightCounts;      // x = directional, y = point + spot
 };
 
-// From openGL tutorial
-float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
+struct LightSource
 {
+    vec4 positionRange;     // xyz = position, w = range
+    vec4 directionCutoff;   // xyz = direction, w = cosine of the spot cutoff (-2 for point lights)
+    vec4 color;             // rgb = color, w = intensity
+    ivec4 shadow;           // x = first index into the shadow buffer or cube (-1 without a shadow), y = cascade count, z = 1 to blend cascades, w = 1 for a shadow cube
+};
+
+// Directional lights first, followed by the clustered point and spot lights
+layout(std430, binding = 1) readonly buffer LightBuffer
+{
+    LightSource lights[];
+};
+
+// Per cluster: x = offset into clusterLightIndices, y = number of lights
+layout(std430, binding = 2) readonly buffer ClusterBuffer
+{
+    uvec2 clusters[];
+};
+
+layout(std430, binding = 3) readonly buffer ClusterIndexBuffer
+{
+    uint clusterLightIndices[];
+};
+
+struct ShadowTile
+{
+    mat4 lightSpaceMatrix;
+    vec4 atlasRect;         // xy = uv offset of the tile in the atlas, zw = uv size of the tile
+    vec4 cascadeRange;      // xy = view depth range covered by a directional light cascade
+};
+
+layout(std430, binding = 4) readonly buffer ShadowBuffer
+{
+    ShadowTile shadows[];
+};
+
+// Upper bound of the directional light count bucket, injected by the shader variant system
+#ifndef MAX_DIRECTIONAL_LIGHTS
+#define MAX_DIRECTIONAL_LIGHTS 4
+#endif
+
+#define SHADOW_TAPS 4
+// Kernel radius in texels, each tap already filters a 2x2 footprint
+#define SHADOW_KERNEL_RADIUS 1.5
+
+const vec2 POISSON_TAPS[SHADOW_TAPS] = vec2[](
+    vec2(-0.94201624, -0.39906216), vec2(0.94558609, -0.76890725),
+    vec2(-0.09418410, -0.92938870), vec2(0.34495938, 0.29387760));
+
+// Per-pixel rotation of the Poisson taps (interleaved gradient noise), trades banding for fine noise
+mat2 ShadowKernelRotation()
+{
+    float noise = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float angle = noise * 6.28318531;
+    float c = cos(angle);
+    float s = sin(angle);
+    return mat2(c, s, -s, c);
+}
+
+// From openGL tutorial, sampling the light's tile of the shadow atlas
+float ShadowCalculation(int shadowIndex, vec3 fragPos, vec3 normal, vec3 lightDir)
+{
+    ShadowTile tile = shadows[shadowIndex];
+    vec4 fragPosLightSpace = tile.lightSpaceMatrix * vec4(fragPos, 1.0);
+
+    // Behind a perspective light
+    if (fragPosLightSpace.w <= 0.0)
+        return 0.0;
+
     // Perform perspective divide
     vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
     
     // Transform to [0,1] range
     projCoords = projCoords * 0.5 + 0.5;
-    
-    // Get closest depth value from light's perspective
-    float closestDepth = texture(shadowMap, projCoords.xy).r;
+
+    // Keep fragments outside light frustum in light (from tutorial "Over sampling")
+    if (projCoords.z > 1.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+        return 0.0;
     
     // Get depth of current fragment from light's perspective
     float currentDepth = projCoords.z;
@@ -29,84 +106,183 @@ float ShadowCalculation(vec4 fragPosLightSpace, vec3 normal, vec3 lightDir)
     // Calculate bias (from tutorial "Shadow acne")
     float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
     
-    // PCF (Percentage Closer Filtering) for soft shadows
-    float shadow = 0.0;
+    // PCF (Percentage Closer Filtering) for soft shadows, the taps never leave the tile
     vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    vec2 tileMin = tile.atlasRect.xy + 0.5 * texelSize;
+    vec2 tileMax = tile.atlasRect.xy + tile.atlasRect.zw - 0.5 * texelSize;
+    vec2 atlasCoords = tile.atlasRect.xy + projCoords.xy * tile.atlasRect.zw;
+
+    float shadow = 0.0;
+#ifdef SHADOW_LEGACY_PCF
     for(int x = -1; x <= 1; ++x)
     {
         for(int y = -1; y <= 1; ++y)
         {
-            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            float pcfDepth = texture(shadowMap, clamp(atlasCoords + vec2(x, y) * texelSize, tileMin, tileMax)).r;
             shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
     }
     shadow /= 9.0;
-    
-    // Keep fragments outside light frustum in light (from tutorial "Over sampling")
-    if(projCoords.z > 1.0)
-        shadow = 0.0;
+#else
+    // Every tap is a bilinear 2x2 compare, four rotated taps cover about the same area as the 3x3 PCF
+    mat2 rotation = ShadowKernelRotation();
+    for (int i = 0; i < SHADOW_TAPS; ++i)
+    {
+        vec2 offset = rotation * POISSON_TAPS[i] * SHADOW_KERNEL_RADIUS * texelSize;
+        shadow += 1.0 - texture(shadowMap, vec3(clamp(atlasCoords + offset, tileMin, tileMax), currentDepth - bias));
+    }
+    shadow /= float(SHADOW_TAPS);
+#endif
     
     return shadow;
 }
 
+#ifdef SHADOW_LEGACY_PCF
+// Offsets around the sampled direction of a shadow cube, in texels at the sampled distance
+const vec3 CUBE_PCF_OFFSETS[9] = vec3[](
+    vec3(0, 0, 0),
+    vec3(1, 1, 1), vec3(1, -1, 1), vec3(-1, -1, 1), vec3(-1, 1, 1),
+    vec3(1, 1, -1), vec3(1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1));
+#endif
+
+// Omnidirectional shadow of a point light
+float PointShadowCalculation(int cube, vec3 fragPos, vec3 normal, vec3 lightDir, vec4 positionRange)
+{
+    vec3 fromLight = fragPos - positionRange.xyz;
+    float distance = length(fromLight);
+    float currentDepth = distance / positionRange.w;
+    if (currentDepth >= 1.0)
+        return 0.0;
+
+    // Same slope scaled bias as the atlas, in units of the light's range
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005) / positionRange.w;
+
+    // Size of a texel at this distance, a cube face spans 90 degrees
+    float texelSize = 2.0 * distance / float(textureSize(pointShadowMaps, 0).x);
+
+    float shadow = 0.0;
+#ifdef SHADOW_LEGACY_PCF
+    for (int i = 0; i < 9; ++i)
+    {
+        float closestDepth = texture(pointShadowMaps, vec4(fromLight + CUBE_PCF_OFFSETS[i] * texelSize, float(cube))).r;
+        shadow += currentDepth - bias > closestDepth ? 1.0 : 0.0;
+    }
+    shadow /= 9.0;
+#else
+    // The same rotated Poisson taps, spread in the plane facing the light
+    vec3 direction = fromLight / distance;
+    vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(direction, tangent);
+    mat2 rotation = ShadowKernelRotation();
+    for (int i = 0; i < SHADOW_TAPS; ++i)
+    {
+        vec2 offset = rotation * POISSON_TAPS[i] * SHADOW_KERNEL_RADIUS * texelSize;
+        vec3 sampleDirection = fromLight + tangent * offset.x + bitangent * offset.y;
+        shadow += 1.0 - texture(pointShadowMaps, vec4(sampleDirection, float(cube)), currentDepth - bias);
+    }
+    shadow /= float(SHADOW_TAPS);
+#endif
+    return shadow;
+}
+
+// Fraction of a cascade over which it cross-fades into the next one
+#define CASCADE_BLEND_BAND 0.1
+
+// Picks the cascade of a directional light by view depth
+float DirectionalShadow(ivec4 shadow, vec3 fragPos, vec3 normal, vec3 lightDir)
+{
+    float viewDepth = -(viewMatrix * vec4(fragPos, 1.0)).z;
+    for (int c = 0; c < shadow.y; ++c)
+    {
+        int index = shadow.x + c;
+        vec2 range = shadows[index].cascadeRange.xy;
+        if (viewDepth > range.y) continue;
+
+        float result = ShadowCalculation(index, fragPos, normal, lightDir);
+
+        // Cross-fade into the next cascade near the far end of this one
+        float blend = (range.y - viewDepth) / ((range.y - range.x) * CASCADE_BLEND_BAND);
+        if (shadow.z != 0 && c + 1 < shadow.y && blend < 1.0)
+            result = mix(ShadowCalculation(index + 1, fragPos, normal, lightDir), result, blend);
+
+        return result;
+    }
+
+    // Beyond the shadow distance
+    return 0.0;
+}
+
+// Original falloff curve, windowed so it reaches zero at the light's range
+float Attenuation(float distance, float range)
+{
+    float ratio = distance / range;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    return window * window / (1.0 + 0.09 * distance + 0.032 * distance * distance);
+}
+
+uint ClusterIndex(vec3 fragPos)
+{
+    float viewDepth = -(viewMatrix * vec4(fragPos, 1.0)).z;
+    int slice = int(log(max(viewDepth, 1e-4)) * clusterParams.z + clusterParams.w);
+    slice = clamp(slice, 0, int(clusterGrid.z) - 1);
+    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / clusterParams.xy), ivec2(0), ivec2(clusterGrid.xy) - 1);
+    return uint(tile.x) + clusterGrid.x * (uint(tile.y) + clusterGrid.y * uint(slice));
+}
+
+// Directional lights affect every fragment; point and spot lights are looked up in the
+// fragment's cluster, so only the lights that can reach it are evaluated.
 vec3 calculateLighting(vec3 fragPos, vec3 normal)
 {
     vec3 ambient = vec3(0.3);
     vec3 result = ambient;
     vec3 norm = normalize(normal);
 
-    for (int i = 0; i < numLights && i < 4; ++i)
+    for (int n = 0; n < MAX_DIRECTIONAL_LIGHTS; ++n)
     {
-        vec3 lightPos = positions[i].xyz;
-        vec3 lightDir = normalize(lightPos - fragPos);
-        float diff = 0.0;
-        vec3 diffuse = vec3(0.0);
-        float attenuation = 1.0;
-        float intensity = colors[i].w;  // Get intensity from color alpha channel
-    
-        int lightType = lightTypes[i].x; // Access first component
-        
-        if (lightType == 0) // Point light
-        {
-            diff = max(dot(norm, lightDir), 0.0);
-            diffuse = diff * colors[i].rgb * intensity;
-            
-            float distance = length(lightPos - fragPos);
-            attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
-            
-            result += diffuse * attenuation;
-        }
-        else if (lightType == 1) // Directional light
+        if (n >= lightCounts.x) break;
+
+        vec3 lightDir = normalize(-lights[n].directionCutoff.xyz);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lights[n].color.rgb * lights[n].color.w;
+
+        float shadow = 0.0;
+#ifdef SHADOW_RECEIVE
+        if (lights[n].shadow.x >= 0)
         {
-            lightDir = normalize(-directions[i].xyz);
-            diff = max(dot(norm, lightDir), 0.0);
-            diffuse = diff * colors[i].rgb * intensity;
-            
-            // Calculate shadow for directional light (first light only for now)
-            float shadow = 0.0;
-            if (i == 0)
-            {
-                shadow = ShadowCalculation(FragPosLightSpace, norm, lightDir);
-            }
-            
-            result += diffuse * (1.0 - shadow);
+            shadow = DirectionalShadow(lights[n].shadow, fragPos, norm, lightDir);
         }
-        else if (lightType == 2) // Spot light
+#endif
+
+        result += diffuse * (1.0 - shadow);
+    }
+
+    uvec2 cluster = clusters[ClusterIndex(fragPos)];
+    for (uint n = 0u; n < cluster.y; ++n)
+    {
+        LightSource light = lights[clusterLightIndices[cluster.x + n]];
+
+        vec3 toLight = light.positionRange.xyz - fragPos;
+        float distance = length(toLight);
+        vec3 lightDir = toLight / max(distance, 1e-4);
+
+        // Point lights store a cutoff below any cosine, so this is 1 for them
+        float spot = step(light.directionCutoff.w, dot(lightDir, normalize(-light.directionCutoff.xyz)));
+
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * light.color.rgb * light.color.w;
+
+        float shadow = 0.0;
+#ifdef SHADOW_RECEIVE
+        if (light.shadow.x >= 0 && diff > 0.0)
         {
-            vec3 spotDir = normalize(-directions[i].xyz);
-            float theta = dot(lightDir, spotDir);
-            float cutoff = 0.9;
-            
-            if (theta > cutoff)
-            {
-                diff = max(dot(norm, lightDir), 0.0);
-                diffuse = diff * colors[i].rgb * intensity;
-                float distance = length(lightPos - fragPos);
-                attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * distance * distance);
-                result += diffuse * attenuation;
-            }
+            shadow = light.shadow.w != 0
+                ? PointShadowCalculation(light.shadow.x, fragPos, norm, lightDir, light.positionRange)
+                : ShadowCalculation(light.shadow.x, fragPos, norm, lightDir);
         }
+#endif
+
+        result += diffuse * Attenuation(distance, light.positionRange.w) * spot * (1.0 - shadow);
     }
-    
+
     return result;
-}
\ No newline at end of file
+}
@@ -0,0 +1,18 @@
+// targetUV.glsl - Sampling post-processing inputs
+#pragma once
+
+// Framebuffers are allocated in 64 pixel buckets and only their bottom-left corner holds the
+// image. The input of a full screen pass has the same size in use as the output, so the pixel
+// being shaded maps to the same pixel of the input, however large the input was allocated.
+vec2 TargetUV(sampler2D source)
+{
+    return gl_FragCoord.xy / vec2(textureSize(source, 0));
+}
+
+// Clamps a coordinate half a texel inside the used part of a source, so bilinear taps never reach
+// the stale rest of the allocation. uvScale is FrameBuffer::GetUVScaleX/Y of the source.
+vec2 ClampToUsed(sampler2D source, vec2 uv, vec2 uvScale)
+{
+    vec2 halfTexel = 0.5 / vec2(textureSize(source, 0));
+    return clamp(uv, halfTexel, uvScale - halfTexel);
+}
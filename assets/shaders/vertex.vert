@@ -7,13 +7,14 @@ layout (location = 4) in vec3 aBitangent;
 
 uniform mat4 mvpMatrix;
 uniform mat4 modelMatrix;
-uniform mat4 lightSpaceMatrix;
 
 out vec3 fPos;
 out vec3 fNor;
 out vec2 uv;
 out mat3 TBN;
-out vec4 FragPosLightSpace;
+
+// Identical to the depth prepass, so the lit pass passes its depth test exactly
+invariant gl_Position;
 
 void main()
 {
@@ -31,8 +32,6 @@ void main()
    TBN = mat3(T, B, N);
    fNor = N;
 
-   FragPosLightSpace = lightSpaceMatrix * worldPos;
-
    uv = aUv;
    gl_Position = mvpMatrix * vec4(aPos, 1.0);
 }
\ No newline at end of file
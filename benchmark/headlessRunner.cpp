@@ -0,0 +1,423 @@
+// Headless benchmark runner: renders a registered scene offscreen along a scripted camera path
+// and writes CPU/GPU frame time percentiles, draw calls and triangles as JSON.
+//
+// Usage: HeadlessRunner [--scene NAME] [--width W] [--height H] [--warmup N] [--frames N]
+//                       [--effects Name,Name|all] [--orbit-radius R] [--orbit-height Y]
+//                       [--context hidden|egl|osmesa] [--output PATH] [--capture-frames N] [--list-scenes]
+//                       [--legacy-shadow-filtering]
+//                       [--stress-objects N] [--stress-layout grid|scatter] [--stress-depth D] [--stress-fan-out F]
+//                       [--stress-mesh-diversity R] [--stress-material-diversity R] [--stress-point-lights N]
+//                       [--stress-spot-lights N] [--stress-directional-lights N] [--stress-moving R] [--stress-seed S]
+//
+// Any --stress-* option generates a "Custom Stress Scene" with those settings and benchmarks it.
+
+#include "core/camera.h"
+#include "core/defaultScenes.h"
+#include "core/objectSystems/components/Light.h"
+#include "core/profiler.h"
+#include "core/rendering/frameBuffer.h"
+#include "core/rendering/frameGraph.h"
+#include "core/rendering/postProcessing/postProcessingEffectBase.h"
+#include "core/rendering/postProcessing/postProcessingManager.h"
+#include "core/rendering/renderStats.h"
+#include "core/sceneManager.h"
+#include "core/stressSceneGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        std::string scene = "Default Scene 1";
+        int width = 1280;
+        int height = 720;
+        int warmupFrames = 60;
+        int frames = 600;
+        std::string effects;            // Comma separated effect names, or "all"
+        float orbitRadius = 10.0f;
+        float orbitHeight = 3.0f;
+        std::string context = "hidden"; // hidden: invisible native window, egl/osmesa: GLFW null platform
+        std::string output = "benchmark.json";
+        int captureFrames = 0;
+        bool listScenes = false;
+        bool legacyShadowFiltering = false; // 3x3 PCF instead of the comparison sampler kernel, see Scene::SetLegacyShadowFiltering
+        core::StressSceneGenerator::Settings stress;
+        bool customStress = false;
+    };
+
+    constexpr const char* CUSTOM_STRESS_SCENE = "Custom Stress Scene";
+    constexpr float FIXED_DELTA_TIME = 1.0f / 60.0f;    // Scene updates do not depend on the frame rate
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--list-scenes")
+            {
+                options.listScenes = true;
+                continue;
+            }
+            if (arg == "--legacy-shadow-filtering")
+            {
+                options.legacyShadowFiltering = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                printf("[RUNNER] Missing value for %s\n", arg.c_str());
+                return false;
+            }
+
+            const char* value = argv[++i];
+            if (arg == "--scene") options.scene = value;
+            else if (arg == "--width") options.width = std::atoi(value);
+            else if (arg == "--height") options.height = std::atoi(value);
+            else if (arg == "--warmup") options.warmupFrames = std::atoi(value);
+            else if (arg == "--frames") options.frames = std::atoi(value);
+            else if (arg == "--effects") options.effects = value;
+            else if (arg == "--orbit-radius") options.orbitRadius = static_cast<float>(std::atof(value));
+            else if (arg == "--orbit-height") options.orbitHeight = static_cast<float>(std::atof(value));
+            else if (arg == "--context") options.context = value;
+            else if (arg == "--output") options.output = value;
+            else if (arg == "--capture-frames") options.captureFrames = std::atoi(value);
+            else if (arg.rfind("--stress-", 0) == 0)
+            {
+                core::StressSceneGenerator::Settings& stress = options.stress;
+                if (arg == "--stress-objects") stress.objectCount = std::atoi(value);
+                else if (arg == "--stress-layout") stress.layout = std::string(value) == "scatter" ? core::StressSceneGenerator::Layout::Scatter : core::StressSceneGenerator::Layout::Grid;
+                else if (arg == "--stress-depth") stress.hierarchyDepth = std::atoi(value);
+                else if (arg == "--stress-fan-out") stress.fanOut = std::atoi(value);
+                else if (arg == "--stress-mesh-diversity") stress.meshDiversity = static_cast<float>(std::atof(value));
+                else if (arg == "--stress-material-diversity") stress.materialDiversity = static_cast<float>(std::atof(value));
+                else if (arg == "--stress-point-lights") stress.pointLights = std::atoi(value);
+                else if (arg == "--stress-spot-lights") stress.spotLights = std::atoi(value);
+                else if (arg == "--stress-directional-lights") stress.directionalLights = std::atoi(value);
+                else if (arg == "--stress-moving") stress.movingFraction = static_cast<float>(std::atof(value));
+                else if (arg == "--stress-seed") stress.seed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+                else
+                {
+                    printf("[RUNNER] Unknown option %s\n", arg.c_str());
+                    return false;
+                }
+                options.customStress = true;
+                options.scene = CUSTOM_STRESS_SCENE;
+            }
+            else
+            {
+                printf("[RUNNER] Unknown option %s\n", arg.c_str());
+                return false;
+            }
+        }
+
+        if (options.width <= 0 || options.height <= 0 || options.frames <= 0 || options.warmupFrames < 0)
+        {
+            printf("[RUNNER] Size and frame counts must be positive\n");
+            return false;
+        }
+        return true;
+    }
+
+    GLFWwindow* CreateContext(const Options& options)
+    {
+        if (options.context != "hidden")
+        {
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+            // The null platform needs no display server, the context comes from EGL (surfaceless) or OSMesa
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+            printf("[RUNNER] --context %s needs GLFW 3.4 or newer\n", options.context.c_str());
+            return nullptr;
+#endif
+        }
+
+        glfwSetErrorCallback([](int error, const char* description)
+        {
+            printf("[RUNNER] GLFW error %d: %s\n", error, description);
+        });
+
+        if (!glfwInit())
+            return nullptr;
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        if (options.context == "egl")
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        else if (options.context == "osmesa")
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        else if (options.context != "hidden")
+        {
+            printf("[RUNNER] Unknown context %s, expected hidden, egl or osmesa\n", options.context.c_str());
+            return nullptr;
+        }
+
+        GLFWwindow* window = glfwCreateWindow(options.width, options.height, "HeadlessRunner", nullptr, nullptr);
+        if (!window)
+            return nullptr;
+
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+        {
+            glfwDestroyWindow(window);
+            return nullptr;
+        }
+        return window;
+    }
+
+    /// <summary>
+    /// Enables the post-processing effects named in a comma separated list, or all of them.
+    /// </summary>
+    void EnableEffects(core::postProcessing::PostProcessingManager& manager, const std::string& list)
+    {
+        for (const auto& effect : manager.GetEffects())
+        {
+            if (list == "all")
+            {
+                manager.EnableEffect(effect);
+                continue;
+            }
+
+            size_t begin = 0;
+            while (begin <= list.size())
+            {
+                size_t end = std::min(list.find(',', begin), list.size());
+                if (list.compare(begin, end - begin, effect->GetName()) == 0)
+                    manager.EnableEffect(effect);
+                begin = end + 1;
+            }
+        }
+    }
+
+    nlohmann::json Summarize(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double p)
+        {
+            size_t rank = static_cast<size_t>(std::lround(p / 100.0 * (samples.size() - 1)));
+            return samples[std::min(rank, samples.size() - 1)];
+        };
+
+        nlohmann::json summary;
+        summary["samples"] = samples.size();
+        if (samples.empty())
+            return summary;
+
+        summary["min"] = samples.front();
+        summary["average"] = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        summary["p50"] = percentile(50.0);
+        summary["p90"] = percentile(90.0);
+        summary["p95"] = percentile(95.0);
+        summary["p99"] = percentile(99.0);
+        summary["max"] = samples.back();
+        return summary;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    GLFWwindow* window = CreateContext(options);
+    if (!window)
+    {
+        printf("[RUNNER] Could not create an OpenGL 4.3 context (%s)\n", options.context.c_str());
+        glfwTerminate();
+        return 1;
+    }
+    printf("[RUNNER] %s, %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+    // Same state the editor sets up
+    glEnable(GL_DEPTH_TEST);
+    glFrontFace(GL_CCW);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    GLuint uboLights = 0;
+    glGenBuffers(1, &uboLights);
+    glBindBuffer(GL_UNIFORM_BUFFER, uboLights);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(core::LightData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, uboLights);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    int exitCode = 0;
+    {
+        auto sceneManager = std::make_shared<core::SceneManager>();
+        core::DefaultScenes::Register(*sceneManager);
+        if (options.customStress)
+            sceneManager->RegisterScene(CUSTOM_STRESS_SCENE, core::StressSceneGenerator::CreateFactory(options.stress));
+
+        if (options.listScenes)
+        {
+            for (const auto& name : sceneManager->GetSceneNames())
+                printf("%s\n", name.c_str());
+        }
+        else if (!sceneManager->LoadScene(options.scene, uboLights))
+        {
+            printf("[RUNNER] Could not load scene '%s', see --list-scenes\n", options.scene.c_str());
+            exitCode = 1;
+        }
+        else
+        {
+            auto scene = sceneManager->GetCurrentScene();
+            scene->SetLegacyShadowFiltering(options.legacyShadowFiltering);
+            auto postProcessing = std::make_shared<core::postProcessing::PostProcessingManager>();
+            postProcessing->Initialize();
+            if (!options.effects.empty())
+                EnableEffects(*postProcessing, options.effects);
+
+            const unsigned width = static_cast<unsigned>(options.width);
+            const unsigned height = static_cast<unsigned>(options.height);
+            core::FrameBuffer sceneBuffer("SceneFBO", { width, height, core::AttachmentType::COLOR_DEPTH });
+            core::FrameBuffer outputBuffer("OutputFBO", { width, height, core::AttachmentType::COLOR_ONLY });
+            core::FrameGraph frameGraph;
+            core::Camera camera(glm::vec3(0.0f, options.orbitHeight, options.orbitRadius), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            // One query per measured frame, read once the run is over so the loop never waits on the GPU
+            std::vector<GLuint> queries(options.frames);
+            glGenQueries(options.frames, queries.data());
+
+            std::vector<double> cpuFrameMs;
+            std::vector<double> drawCalls;
+            std::vector<double> triangles;
+            cpuFrameMs.reserve(options.frames);
+            drawCalls.reserve(options.frames);
+            triangles.reserve(options.frames);
+
+            if (options.captureFrames > 0)
+                core::Profiler::CaptureFrames(options.captureFrames, "runnerTrace.json");
+
+            const int totalFrames = options.warmupFrames + options.frames;
+            for (int frame = 0; frame < totalFrames; ++frame)
+            {
+                core::Profiler::EndFrame();
+                FINALENGINE_PROFILE_ZONE("Frame");
+
+                const int measured = frame - options.warmupFrames;
+                if (measured == 0)
+                    glFinish(); // Start the measured frames with an idle GPU
+
+                // The path depends on the frame index only, so every run and machine sees the same views
+                float angle = 2.0f * 3.14159265f * frame / totalFrames;
+                camera.position = glm::vec3(std::sin(angle) * options.orbitRadius, options.orbitHeight, std::cos(angle) * options.orbitRadius);
+                camera.LookAt(glm::vec3(0.0f));
+
+                auto cpuBegin = std::chrono::steady_clock::now();
+                scene->Update(FIXED_DELTA_TIME);
+                core::RenderStats::Reset();
+                if (measured >= 0)
+                    glBeginQuery(GL_TIME_ELAPSED, queries[measured]);
+
+                frameGraph.Reset();
+                core::FrameGraph::Handle sceneTarget = frameGraph.Import("SceneColor", sceneBuffer);
+                core::FrameGraph::Handle outputTarget = frameGraph.Import("Output", outputBuffer);
+                frameGraph.AddPass("Scene",
+                    [sceneTarget](core::FrameGraph::Builder& builder)
+                    {
+                        builder.Write(sceneTarget);
+                    },
+                    [&, sceneTarget](const core::FrameGraph::Resources& resources)
+                    {
+                        resources.Get(sceneTarget).BindAndClear(width, height);
+                        scene->Render(camera.GetViewMatrix(), camera.GetProjectionMatrix(static_cast<float>(width), static_cast<float>(height)));
+                    });
+                postProcessing->AddPasses(frameGraph, sceneTarget, outputTarget, width, height);
+                frameGraph.Compile();
+                frameGraph.Execute();
+
+                if (measured >= 0)
+                    glEndQuery(GL_TIME_ELAPSED);
+                glfwSwapBuffers(window);
+
+                if (measured >= 0)
+                {
+                    std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - cpuBegin;
+                    cpuFrameMs.push_back(cpuTime.count());
+                    drawCalls.push_back(static_cast<double>(core::RenderStats::Get().drawCalls));
+                    triangles.push_back(static_cast<double>(core::RenderStats::Get().triangles));
+                }
+            }
+            core::Profiler::EndFrame();
+            glFinish();
+
+            std::vector<double> gpuFrameMs;
+            gpuFrameMs.reserve(options.frames);
+            for (GLuint query : queries)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                gpuFrameMs.push_back(elapsed / 1.0e6);
+            }
+            glDeleteQueries(options.frames, queries.data());
+
+            nlohmann::json report;
+            report["scene"] = options.scene;
+            report["width"] = options.width;
+            report["height"] = options.height;
+            report["warmupFrames"] = options.warmupFrames;
+            report["frames"] = options.frames;
+            report["effects"] = options.effects;
+            report["context"] = options.context;
+            report["legacyShadowFiltering"] = options.legacyShadowFiltering;
+            if (options.customStress)
+            {
+                const core::StressSceneGenerator::Settings& stress = options.stress;
+                report["stress"] = {
+                    { "objects", stress.objectCount },
+                    { "layout", stress.layout == core::StressSceneGenerator::Layout::Grid ? "grid" : "scatter" },
+                    { "hierarchyDepth", stress.hierarchyDepth },
+                    { "fanOut", stress.fanOut },
+                    { "meshDiversity", stress.meshDiversity },
+                    { "materialDiversity", stress.materialDiversity },
+                    { "pointLights", stress.pointLights },
+                    { "spotLights", stress.spotLights },
+                    { "directionalLights", stress.directionalLights },
+                    { "movingFraction", stress.movingFraction },
+                    { "seed", stress.seed }
+                };
+            }
+            report["renderer"] = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+            report["glVersion"] = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+            report["cpuFrameMs"] = Summarize(cpuFrameMs);
+            report["gpuFrameMs"] = Summarize(gpuFrameMs);
+            report["drawCalls"] = Summarize(drawCalls);
+            report["triangles"] = Summarize(triangles);
+
+            std::ofstream file(options.output);
+            if (file)
+            {
+                file << report.dump(2) << '\n';
+                printf("[RUNNER] Wrote %s (CPU p50 %.2f ms, GPU p50 %.2f ms)\n", options.output.c_str(),
+                       report["cpuFrameMs"]["p50"].get<double>(), report["gpuFrameMs"]["p50"].get<double>());
+            }
+            else
+            {
+                printf("[RUNNER] Could not write %s\n", options.output.c_str());
+                exitCode = 1;
+            }
+        }
+    }
+
+    glDeleteBuffers(1, &uboLights);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return exitCode;
+}
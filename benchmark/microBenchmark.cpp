@@ -0,0 +1,262 @@
+#include "microBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+namespace microBenchmark
+{
+    namespace
+    {
+        constexpr std::int64_t MAX_ITERATIONS = 1000000000;
+
+        struct Benchmark
+        {
+            std::string name;
+            BenchmarkFunc func;
+            std::string argName;
+            std::vector<std::int64_t> args;
+        };
+
+        struct Options
+        {
+            std::string filter;
+            double minTime = 0.1;       // Seconds every repetition runs for at least
+            int repetitions = 5;
+            std::string output = "microBenchmarks.json";
+            bool list = false;
+        };
+
+        std::vector<Benchmark>& GetRegistry()
+        {
+            static std::vector<Benchmark> registry;
+            return registry;
+        }
+
+        std::int64_t NowNanoseconds()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        bool ParseOptions(int argc, char** argv, Options& options)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                std::string arg = argv[i];
+                if (arg == "--list")
+                {
+                    options.list = true;
+                    continue;
+                }
+                if (i + 1 >= argc)
+                {
+                    printf("[MICROBENCH] Missing value for %s\n", arg.c_str());
+                    return false;
+                }
+
+                const char* value = argv[++i];
+                if (arg == "--filter") options.filter = value;
+                else if (arg == "--min-time") options.minTime = std::atof(value);
+                else if (arg == "--repetitions") options.repetitions = std::atoi(value);
+                else if (arg == "--output") options.output = value;
+                else
+                {
+                    printf("[MICROBENCH] Unknown option %s\n", arg.c_str());
+                    return false;
+                }
+            }
+
+            if (options.minTime <= 0.0 || options.repetitions <= 0)
+            {
+                printf("[MICROBENCH] --min-time and --repetitions must be positive\n");
+                return false;
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Grows the iteration count until one run takes at least minTime.
+        /// </summary>
+        std::int64_t CalibrateIterations(BenchmarkFunc func, std::int64_t arg, double minTime)
+        {
+            std::int64_t iterations = 1;
+            while (true)
+            {
+                State state(iterations, arg);
+                func(state);
+                double seconds = state.GetRealSeconds();
+                if (seconds >= minTime || iterations >= MAX_ITERATIONS)
+                    return iterations;
+
+                // Predict from runs long enough to be meaningful, otherwise step up by 10x
+                double multiplier = seconds / minTime > 0.1 ? minTime * 1.4 / seconds : 10.0;
+                std::int64_t next = static_cast<std::int64_t>(std::ceil(iterations * multiplier));
+                iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, next));
+            }
+        }
+
+        nlohmann::json MakeRun(const std::string& name, std::int64_t iterations, double realNs, double cpuNs, double itemsPerSecond)
+        {
+            nlohmann::json run;
+            run["name"] = name;
+            run["run_name"] = name;
+            run["threads"] = 1;
+            run["iterations"] = iterations;
+            run["real_time"] = realNs;
+            run["cpu_time"] = cpuNs;
+            run["time_unit"] = "ns";
+            if (itemsPerSecond > 0.0)
+                run["items_per_second"] = itemsPerSecond;
+            return run;
+        }
+
+        double Mean(const std::vector<double>& values)
+        {
+            double sum = 0.0;
+            for (double value : values) sum += value;
+            return sum / values.size();
+        }
+
+        double Median(std::vector<double> values)
+        {
+            std::sort(values.begin(), values.end());
+            std::size_t middle = values.size() / 2;
+            return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) * 0.5;
+        }
+
+        double StandardDeviation(const std::vector<double>& values)
+        {
+            if (values.size() < 2) return 0.0;
+            double mean = Mean(values);
+            double sum = 0.0;
+            for (double value : values) sum += (value - mean) * (value - mean);
+            return std::sqrt(sum / (values.size() - 1));
+        }
+    } // namespace
+
+    void State::StartTimer()
+    {
+        m_cpuStart = std::clock();
+        m_realStart = NowNanoseconds();
+    }
+
+    void State::StopTimer()
+    {
+        std::int64_t realEnd = NowNanoseconds();
+        std::clock_t cpuEnd = std::clock();
+        m_realSeconds = (realEnd - m_realStart) * 1e-9;
+        m_cpuSeconds = static_cast<double>(cpuEnd - m_cpuStart) / CLOCKS_PER_SEC;
+    }
+
+    void UseCharPointer(const volatile char*) {}
+
+    void Register(const std::string& name, BenchmarkFunc func, const std::string& argName, const std::vector<std::int64_t>& args)
+    {
+        GetRegistry().push_back({ name, func, argName, args });
+    }
+
+    int RunMain(int argc, char** argv)
+    {
+        Options options;
+        if (!ParseOptions(argc, argv, options))
+            return 1;
+
+        nlohmann::json runs = nlohmann::json::array();
+        int familyIndex = 0;
+        for (const Benchmark& benchmark : GetRegistry())
+        {
+            // A benchmark without arguments runs once, with 0
+            std::vector<std::int64_t> args = benchmark.args.empty() ? std::vector<std::int64_t>{ 0 } : benchmark.args;
+            int instanceIndex = 0;
+            bool ranAny = false;
+            for (std::int64_t arg : args)
+            {
+                std::string name = benchmark.args.empty() ? benchmark.name : benchmark.name + "/" + benchmark.argName + ":" + std::to_string(arg);
+                if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+                    continue;
+                if (options.list)
+                {
+                    printf("%s\n", name.c_str());
+                    continue;
+                }
+
+                std::int64_t iterations = CalibrateIterations(benchmark.func, arg, options.minTime);
+                std::vector<double> realNs, cpuNs, itemsPerSecond;
+                for (int repetition = 0; repetition < options.repetitions; ++repetition)
+                {
+                    State state(iterations, arg);
+                    benchmark.func(state);
+                    realNs.push_back(state.GetRealSeconds() * 1e9 / iterations);
+                    cpuNs.push_back(state.GetCpuSeconds() * 1e9 / iterations);
+                    itemsPerSecond.push_back(state.GetRealSeconds() > 0.0 ? state.GetItemsPerIteration() * iterations / state.GetRealSeconds() : 0.0);
+
+                    nlohmann::json run = MakeRun(name, iterations, realNs.back(), cpuNs.back(), itemsPerSecond.back());
+                    run["family_index"] = familyIndex;
+                    run["per_family_instance_index"] = instanceIndex;
+                    run["run_type"] = "iteration";
+                    run["repetitions"] = options.repetitions;
+                    run["repetition_index"] = repetition;
+                    runs.push_back(run);
+                }
+
+                auto addAggregate = [&](const char* aggregate, double real, double cpu, double items)
+                {
+                    nlohmann::json run = MakeRun(name, iterations, real, cpu, items);
+                    run["name"] = name + "_" + aggregate;
+                    run["family_index"] = familyIndex;
+                    run["per_family_instance_index"] = instanceIndex;
+                    run["run_type"] = "aggregate";
+                    run["repetitions"] = options.repetitions;
+                    run["aggregate_name"] = aggregate;
+                    run["aggregate_unit"] = "time";
+                    runs.push_back(run);
+                };
+                addAggregate("mean", Mean(realNs), Mean(cpuNs), Mean(itemsPerSecond));
+                addAggregate("median", Median(realNs), Median(cpuNs), Median(itemsPerSecond));
+                addAggregate("stddev", StandardDeviation(realNs), StandardDeviation(cpuNs), 0.0);
+
+                printf("%-56s %14.1f ns %12.1f ns (stddev) %12lld iterations\n", name.c_str(), Median(realNs), StandardDeviation(realNs),
+                       static_cast<long long>(iterations));
+                instanceIndex++;
+                ranAny = true;
+            }
+            if (ranAny)
+                familyIndex++;
+        }
+
+        if (options.list)
+            return 0;
+
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        nlohmann::json report;
+        report["context"] = {
+            { "date", date },
+            { "executable", argc > 0 ? argv[0] : "" },
+            { "num_cpus", std::thread::hardware_concurrency() },
+#ifdef NDEBUG
+            { "library_build_type", "release" },
+#else
+            { "library_build_type", "debug" },
+#endif
+            { "min_time", options.minTime }
+        };
+        report["benchmarks"] = runs;
+
+        std::ofstream file(options.output);
+        if (!file)
+        {
+            printf("[MICROBENCH] Could not write %s\n", options.output.c_str());
+            return 1;
+        }
+        file << report.dump(2) << '\n';
+        printf("[MICROBENCH] Wrote %s\n", options.output.c_str());
+        return 0;
+    }
+} // namespace microBenchmark
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace microBenchmark
+{
+    /// <summary>
+    /// Timing state of one benchmark run. The body times the range-for loop over the state,
+    /// work before the loop is setup and is not measured:
+    /// <code>
+    /// void BM_Example(microBenchmark::State&amp; state)
+    /// {
+    ///     auto data = Setup(state.GetArg());
+    ///     for (auto _ : state)
+    ///         microBenchmark::DoNotOptimize(Work(data));
+    /// }
+    /// </code>
+    /// </summary>
+    class State
+    {
+    public:
+        class Iterator
+        {
+        public:
+            Iterator(State* state, std::int64_t remaining) : m_state(state), m_remaining(remaining) {}
+
+            bool operator!=(const Iterator&)
+            {
+                if (m_remaining != 0) return true;
+                m_state->StopTimer();
+                return false;
+            }
+            void operator++() { --m_remaining; }
+            int operator*() const { return 0; }
+
+        private:
+            State* m_state;
+            std::int64_t m_remaining;
+        };
+
+        State(std::int64_t iterations, std::int64_t arg) : m_iterations(iterations), m_arg(arg) {}
+
+        Iterator begin()
+        {
+            StartTimer();
+            return Iterator(this, m_iterations);
+        }
+        Iterator end() { return Iterator(this, 0); }
+
+        std::int64_t GetArg() const { return m_arg; }
+        std::int64_t GetIterations() const { return m_iterations; }
+
+        /// <summary>
+        /// Items handled per iteration, for benchmarks where one iteration covers many (e.g. a whole tree).
+        /// Reported as items_per_second.
+        /// </summary>
+        void SetItemsPerIteration(std::int64_t items) { m_itemsPerIteration = items; }
+        std::int64_t GetItemsPerIteration() const { return m_itemsPerIteration; }
+
+        double GetRealSeconds() const { return m_realSeconds; }
+        double GetCpuSeconds() const { return m_cpuSeconds; }
+
+    private:
+        void StartTimer();
+        void StopTimer();
+
+        std::int64_t m_iterations;
+        std::int64_t m_arg;
+        std::int64_t m_itemsPerIteration = 0;
+        std::int64_t m_realStart = 0;
+        std::clock_t m_cpuStart = 0;
+        double m_realSeconds = 0.0;
+        double m_cpuSeconds = 0.0;
+    };
+
+    using BenchmarkFunc = void (*)(State&);
+
+    /// <summary>
+    /// Defined in its own translation unit, so the compiler cannot see that the pointer is unused.
+    /// </summary>
+    void UseCharPointer(const volatile char* pointer);
+
+    /// <summary>
+    /// Keeps the compiler from discarding a result the benchmark never reads.
+    /// </summary>
+    template<typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "m"(value) : "memory");
+#else
+        UseCharPointer(&reinterpret_cast<const volatile char&>(value));
+        _ReadWriteBarrier();
+#endif
+    }
+
+    /// <summary>
+    /// Registers a benchmark, run once for every argument. The reported name is
+    /// "name/argName:arg", or just the name when args is empty.
+    /// </summary>
+    void Register(const std::string& name, BenchmarkFunc func, const std::string& argName = {}, const std::vector<std::int64_t>& args = {});
+
+    /// <summary>
+    /// Runs the registered benchmarks and writes the results as JSON.
+    /// <para>
+    /// The JSON follows the layout of Google Benchmark's --benchmark_out, so its tools/compare.py
+    /// diffs two result files. Every benchmark reports each repetition plus mean, median and stddev.
+    /// </para>
+    /// Options: --filter SUBSTRING, --min-time SECONDS, --repetitions N, --output PATH, --list.
+    /// </summary>
+    /// <returns>The process exit code.</returns>
+    int RunMain(int argc, char** argv);
+} // namespace microBenchmark
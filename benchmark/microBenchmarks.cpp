@@ -0,0 +1,295 @@
+// CPU microbenchmarks for engine hot paths. GL calls go to stubs, so only the CPU side is measured
+// and no window or GPU is needed.
+//
+// Usage: MicroBenchmarks [--filter SUBSTRING] [--min-time SECONDS] [--repetitions N] [--output PATH] [--list]
+//
+// The results are written as Google Benchmark style JSON (microBenchmarks.json by default). Compare two
+// commits with Google Benchmark's tools/compare.py benchmarks before.json after.json.
+
+#include "core/material.h"
+#include "core/objectSystems/componentFactory.h"
+#include "core/objectSystems/components/Light.h"
+#include "core/objectSystems/components/Renderer.h"
+#include "core/objectSystems/GameObject.h"
+#include "core/property.h"
+#include "core/scene.h"
+#include "microBenchmark.h"
+#include "stubGl.h"
+#include <cstdio>
+#include <glm/glm.hpp>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace
+{
+    using microBenchmark::DoNotOptimize;
+    using microBenchmark::State;
+
+    std::shared_ptr<core::Scene> CreateScene()
+    {
+        return std::make_shared<core::Scene>("Micro Benchmark");
+    }
+
+    /// <summary>
+    /// Builds a tree of objectCount objects breadth first, four children per parent.
+    /// </summary>
+    std::shared_ptr<core::GameObject> BuildTree(core::Scene& scene, std::int64_t objectCount)
+    {
+        auto root = scene.CreateObject("Root");
+        std::vector<std::shared_ptr<core::GameObject>> level = { root };
+        std::int64_t created = 1;
+        while (created < objectCount)
+        {
+            std::vector<std::shared_ptr<core::GameObject>> nextLevel;
+            for (const auto& parent : level)
+            {
+                for (int child = 0; child < 4 && created < objectCount; ++child, ++created)
+                {
+                    auto object = scene.CreateObject("Node " + std::to_string(created), parent);
+                    object->transform->position = glm::vec3(1.0f, 0.0f, 0.0f);
+                    nextLevel.push_back(object);
+                }
+            }
+            level = std::move(nextLevel);
+        }
+        return root;
+    }
+
+    void BM_CalculateWorldMatrix(State& state)
+    {
+        auto scene = CreateScene();
+        std::shared_ptr<core::GameObject> leaf;
+        for (std::int64_t i = 0; i < state.GetArg(); ++i)
+        {
+            leaf = scene->CreateObject("Node", leaf);
+            leaf->transform->position = glm::vec3(1.0f, 0.0f, 0.0f);
+            leaf->transform->rotation = glm::vec3(0.0f, 10.0f, 0.0f);
+        }
+
+        for (auto _ : state)
+            DoNotOptimize(core::Scene::CalculateWorldMatrix(leaf));
+    }
+
+    void BM_MaterialUse(State& state)
+    {
+        // Every uniform type Use() walks, plus two textures
+        core::Material material(1);
+        for (std::int64_t i = 0; i < state.GetArg(); ++i)
+        {
+            std::string name = "uniform" + std::to_string(i);
+            switch (i % 4)
+            {
+            case 0: material.SetFloat(name, 1.0f); break;
+            case 1: material.SetVec3(name, glm::vec3(1.0f)); break;
+            case 2: material.SetVec4(name, glm::vec4(1.0f)); break;
+            default: material.SetMat4(name, glm::mat4(1.0f)); break;
+            }
+        }
+        material.SetTextureID("albedoMap", 1, 0);
+        material.SetTextureID("aoMap", 2, 1);
+
+        for (auto _ : state)
+            material.Use();
+    }
+
+    void BM_GetComponent(State& state)
+    {
+        // The renderer sits behind the transform and the given number of lights
+        auto scene = CreateScene();
+        auto object = scene->CreateObject("Object");
+        for (std::int64_t i = 0; i < state.GetArg(); ++i)
+            object->AddComponent<core::Light>();
+        object->AddComponent<core::Renderer>();
+
+        for (auto _ : state)
+            DoNotOptimize(object->GetComponent<core::Renderer>());
+    }
+
+    void BM_RegisterUnregisterRenderer(State& state)
+    {
+        auto scene = CreateScene();
+        std::vector<std::shared_ptr<core::Renderer>> renderers;
+        renderers.reserve(state.GetArg());
+        for (std::int64_t i = 0; i < state.GetArg(); ++i)
+        {
+            renderers.push_back(std::make_shared<core::Renderer>());
+            scene->RegisterRenderer(renderers.back());
+        }
+
+        auto renderer = std::make_shared<core::Renderer>();
+        for (auto _ : state)
+        {
+            scene->RegisterRenderer(renderer);
+            scene->UnregisterRenderer(renderer);
+        }
+    }
+
+    std::shared_ptr<core::Scene> CreateRendererScene(std::int64_t objectCount)
+    {
+        // Every fourth object is a light, so the query skips an archetype
+        auto scene = CreateScene();
+        for (std::int64_t i = 0; i < objectCount; ++i)
+        {
+            auto object = scene->CreateObject("Object");
+            if (i % 4 == 0)
+                object->AddComponent<core::Light>();
+            else
+                object->AddComponent<core::Renderer>();
+        }
+        return scene;
+    }
+
+    void BM_QueryTransformRenderer(State& state)
+    {
+        auto scene = CreateRendererScene(state.GetArg());
+        state.SetItemsPerIteration(state.GetArg());
+
+        for (auto _ : state)
+        {
+            float sum = 0.0f;
+            scene->Query<core::Transform, core::Renderer>([&sum](core::GameObject&, core::Transform& transform, core::Renderer&)
+            {
+                sum += transform.position.x;
+            });
+            DoNotOptimize(sum);
+        }
+    }
+
+    void BM_IterateRegisteredRenderers(State& state)
+    {
+        // The same walk through the registered renderer list, for comparison with the query
+        auto scene = CreateRendererScene(state.GetArg());
+        state.SetItemsPerIteration(state.GetArg());
+
+        for (auto _ : state)
+        {
+            float sum = 0.0f;
+            for (const auto& renderer : scene->GetRenderers())
+            {
+                auto object = renderer->GetOwner();
+                sum += object->transform->position.x;
+            }
+            DoNotOptimize(sum);
+        }
+    }
+
+    void BM_Serialize(State& state)
+    {
+        auto scene = CreateScene();
+        auto root = BuildTree(*scene, state.GetArg());
+        state.SetItemsPerIteration(state.GetArg());
+
+        for (auto _ : state)
+        {
+            nlohmann::json out;
+            root->Serialize(out);
+            DoNotOptimize(out);
+        }
+    }
+
+    void BM_Deserialize(State& state)
+    {
+        // Includes freeing the previous tree, which is owned by the scene but not one of its roots
+        auto scene = CreateScene();
+        nlohmann::json in;
+        BuildTree(*scene, state.GetArg())->Serialize(in);
+        state.SetItemsPerIteration(state.GetArg());
+
+        for (auto _ : state)
+        {
+            auto root = core::GameObject::Create({}, scene);
+            root->Deserialize(in);
+            DoNotOptimize(root);
+        }
+    }
+
+    void CreateComponent(State& state, const std::string& typeName)
+    {
+        for (auto _ : state)
+            DoNotOptimize(core::ComponentFactory::Create(typeName));
+    }
+
+    void BM_PropertyAssign(State& state)
+    {
+        core::Property<float> property;
+        bool toggle = false;
+        for (auto _ : state)
+        {
+            toggle = !toggle;
+            property = toggle ? 1.0f : 2.0f;
+        }
+        DoNotOptimize(property);
+    }
+
+    void BM_PropertyAssignUnchanged(State& state)
+    {
+        // The comparison only, the value never changes
+        core::Property<float> property(1.0f);
+        int calls = 0;
+        property.SetOnChange([&calls](float) { ++calls; });
+        for (auto _ : state)
+            property = 1.0f;
+        DoNotOptimize(calls);
+    }
+
+    void BM_PropertyAssignOnChange(State& state)
+    {
+        core::Property<float> property;
+        int calls = 0;
+        property.SetOnChange([&calls](float) { ++calls; });
+        bool toggle = false;
+        for (auto _ : state)
+        {
+            toggle = !toggle;
+            property = toggle ? 1.0f : 2.0f;
+        }
+        DoNotOptimize(calls);
+    }
+
+    void BM_PropertyAssignVec3OnChange(State& state)
+    {
+        core::Property<glm::vec3> property;
+        int calls = 0;
+        property.SetOnChange([&calls](glm::vec3) { ++calls; });
+        bool toggle = false;
+        for (auto _ : state)
+        {
+            toggle = !toggle;
+            property = toggle ? glm::vec3(1.0f) : glm::vec3(2.0f);
+        }
+        DoNotOptimize(calls);
+    }
+
+    void RegisterBenchmarks()
+    {
+        using microBenchmark::Register;
+        Register("Scene::CalculateWorldMatrix", BM_CalculateWorldMatrix, "depth", { 1, 4, 16, 64 });
+        Register("Material::Use", BM_MaterialUse, "uniforms", { 4, 16, 64 });
+        Register("GameObject::GetComponent<Renderer>", BM_GetComponent, "lightsBefore", { 0, 4, 16 });
+        Register("Scene::RegisterUnregisterRenderer", BM_RegisterUnregisterRenderer, "registered", { 100, 10000, 100000 });
+        Register("Scene::Query<Transform,Renderer>", BM_QueryTransformRenderer, "objects", { 1000, 100000 });
+        Register("Scene::GetRenderers/iterate", BM_IterateRegisteredRenderers, "objects", { 1000, 100000 });
+        Register("GameObject::Serialize", BM_Serialize, "objects", { 100, 1000, 10000 });
+        Register("GameObject::Deserialize", BM_Deserialize, "objects", { 100, 1000, 10000 });
+        Register("ComponentFactory::Create/Transform", [](State& state) { CreateComponent(state, "Transform"); });
+        Register("ComponentFactory::Create/Renderer", [](State& state) { CreateComponent(state, "Renderer"); });
+        Register("ComponentFactory::Create/Light", [](State& state) { CreateComponent(state, "Light"); });
+        Register("Property<float>::operator=", BM_PropertyAssign);
+        Register("Property<float>::operator=/unchanged", BM_PropertyAssignUnchanged);
+        Register("Property<float>::operator=/onChange", BM_PropertyAssignOnChange);
+        Register("Property<vec3>::operator=/onChange", BM_PropertyAssignVec3OnChange);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (!microBenchmark::LoadStubGl())
+    {
+        printf("[MICROBENCH] Failed to load the stub GL functions\n");
+        return 1;
+    }
+
+    RegisterBenchmarks();
+    return microBenchmark::RunMain(argc, argv);
+}
@@ -0,0 +1,81 @@
+#include "stubGl.h"
+#include <cstdint>
+#include <cstring>
+#include <glad/glad.h>
+
+static_assert(sizeof(void*) == 8, "The stub GL loader relies on the 64-bit calling conventions");
+
+namespace microBenchmark
+{
+    namespace
+    {
+        GLuint s_nextName = 1;
+
+        std::uintptr_t APIENTRY Noop() { return 0; }
+
+        const GLubyte* APIENTRY GetString(GLenum name)
+        {
+            // glad parses the version to decide which entry points to load
+            const char* value = name == GL_VERSION ? "4.6.0 Stub" : "Stub";
+            return reinterpret_cast<const GLubyte*>(value);
+        }
+
+        const GLubyte* APIENTRY GetStringi(GLenum, GLuint)
+        {
+            return reinterpret_cast<const GLubyte*>("GL_STUB_extension");
+        }
+
+        void APIENTRY GetIntegerv(GLenum pname, GLint* data)
+        {
+            // glad refuses a context without extensions
+            *data = pname == GL_NUM_EXTENSIONS ? 1 : 0;
+        }
+
+        void APIENTRY GetObjectiv(GLuint, GLenum pname, GLint* params)
+        {
+            *params = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS ? GL_TRUE : 0;
+        }
+
+        void APIENTRY GetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+        {
+            if (length) *length = 0;
+            if (infoLog && bufSize > 0) infoLog[0] = '\0';
+        }
+
+        GLuint APIENTRY CreateObject() { return s_nextName++; }
+        GLuint APIENTRY CreateShader(GLenum) { return s_nextName++; }
+
+        void APIENTRY GenNames(GLsizei n, GLuint* names)
+        {
+            for (GLsizei i = 0; i < n; ++i)
+                names[i] = s_nextName++;
+        }
+
+        GLenum APIENTRY CheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+
+        void* LoadProc(const char* name)
+        {
+            if (std::strcmp(name, "glGetString") == 0) return reinterpret_cast<void*>(&GetString);
+            if (std::strcmp(name, "glGetStringi") == 0) return reinterpret_cast<void*>(&GetStringi);
+            if (std::strcmp(name, "glGetIntegerv") == 0) return reinterpret_cast<void*>(&GetIntegerv);
+            if (std::strcmp(name, "glGetShaderiv") == 0 || std::strcmp(name, "glGetProgramiv") == 0)
+                return reinterpret_cast<void*>(&GetObjectiv);
+            if (std::strcmp(name, "glGetShaderInfoLog") == 0 || std::strcmp(name, "glGetProgramInfoLog") == 0)
+                return reinterpret_cast<void*>(&GetInfoLog);
+            if (std::strcmp(name, "glCreateProgram") == 0) return reinterpret_cast<void*>(&CreateObject);
+            if (std::strcmp(name, "glCreateShader") == 0) return reinterpret_cast<void*>(&CreateShader);
+            if (std::strcmp(name, "glCheckFramebufferStatus") == 0) return reinterpret_cast<void*>(&CheckFramebufferStatus);
+
+            // glGenBuffers, glGenTextures, glGenVertexArrays, ... share one signature, glGenerateMipmap does not
+            if (std::strncmp(name, "glGen", 5) == 0 && std::strncmp(name, "glGenerate", 10) != 0)
+                return reinterpret_cast<void*>(&GenNames);
+
+            return reinterpret_cast<void*>(&Noop);
+        }
+    } // namespace
+
+    bool LoadStubGl()
+    {
+        return gladLoadGLLoader(LoadProc) != 0;
+    }
+} // namespace microBenchmark
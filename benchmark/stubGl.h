@@ -0,0 +1,17 @@
+#pragma once
+
+namespace microBenchmark
+{
+    /// <summary>
+    /// Points the glad function pointers at stubs, so engine code that issues GL calls runs without
+    /// a context. Object names count up, compiles and links succeed, framebuffers are complete and
+    /// every other call does nothing and returns 0.
+    /// <para>
+    /// Only meant for CPU benchmarks of the bookkeeping around GL calls. The catch-all stub is called
+    /// through pointers of other signatures, which the 64-bit calling conventions tolerate (the caller
+    /// cleans the stack), 32-bit stdcall does not.
+    /// </para>
+    /// </summary>
+    /// <returns>True if glad accepted the stubs.</returns>
+    bool LoadStubGl();
+} // namespace microBenchmark
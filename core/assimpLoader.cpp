@@ -1,11 +1,13 @@
 #include "assimpLoader.h"
 #include "Rendering/mesh.h"
+#include "profiler.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
 namespace core {
     Model AssimpLoader::loadModel(const std::string& path) {
+        FINALENGINE_PROFILE_ZONE("AssimpLoader::loadModel");
         printf("Attempting to load model: %s\n", path.c_str());
         
         Assimp::Importer import;
@@ -37,6 +37,16 @@ namespace core {
         UpdateCameraVectors();
     }
 
+    void Camera::LookAt(const glm::vec3& target) {
+        glm::vec3 const dir = target - position;
+        if (glm::length(dir) <= 0.0f) return;
+
+        yaw   = glm::degrees(atan2(dir.z, dir.x));
+        pitch = glm::degrees(atan2(dir.y, glm::length(glm::vec2(dir.x, dir.z))));
+        pitch = glm::clamp(pitch, -89.0f, 89.0f);
+        UpdateCameraVectors();
+    }
+
     glm::mat4 Camera::GetViewMatrix() const {
         glm::mat4 const view = glm::lookAt(position, position + forward, up);
         return view;
@@ -105,6 +105,12 @@ namespace core {
         /// <param name="delta">: Rotation delta (degrees per unit before 0.1 scaling). delta.x -> yaw, delta.y -> pitch. </param>
         void PivotRotate(glm::vec2 delta);
 
+        /// <summary>
+        /// Sets yaw and pitch so the camera faces the target, pitch clamped to [-89, 89], then updates the basis.
+        /// </summary>
+        /// <param name="target">: World-space point to look at. </param>
+        void LookAt(const glm::vec3& target);
+
         /// <summary>
         /// Returns glm::lookAt(position, position + forward, up).
         /// </summary>
@@ -0,0 +1,174 @@
+#include "assimpLoader.h"
+#include "defaultScenes.h"
+#include "material.h"
+#include "model.h"
+#include "objectSystems/components/Light.h"
+#include "objectSystems/components/Renderer.h"
+#include "rendering/mesh.h"
+#include "rendering/shader.h"
+#include "rendering/shaderVariants.h"
+#include "rendering/texture.h"
+#include "stressSceneGenerator.h"
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace core
+{
+    void DefaultScenes::Register(SceneManager& sceneManager)
+    {
+        printf("[SCENES] Registering default scenes...\n");
+
+        // Shared by the factories below, alive for as long as the scene manager keeps them
+        auto textureShader = std::make_shared<Shader>("assets/shaders/vertex.vert", "assets/shaders/texture.frag");
+        auto lightBulbShader = std::make_shared<Shader>("assets/shaders/vertex.vert", "assets/shaders/fragmentLightBulb.frag");
+        auto litSurfaceShader = std::make_shared<ShaderVariants>("assets/shaders/vertex.vert", "assets/shaders/litFragment.frag");
+
+        // Register Default Scene 1
+        sceneManager.RegisterScene("Default Scene 1", [=](std::shared_ptr<Scene> scene) {
+            auto rockGO = scene->CreateObject("Rock");
+            Model rockModel = AssimpLoader::loadModel("assets/models/rockModel.fbx");
+            auto rockMaterial = std::make_shared<Material>(litSurfaceShader);
+
+            auto rockRenderer = rockGO->AddComponent<Renderer>();
+            auto rockTexture = std::make_shared<Texture>("assets/textures/rockTexture.jpeg");
+            auto rockAO = std::make_shared<Texture>("assets/textures/rockAO.jpeg");
+            auto rockNormal = std::make_shared<Texture>("assets/textures/rockNormal.jpeg");
+            rockMaterial->SetTexture("albedoMap", rockTexture, 0);
+            rockMaterial->SetTexture("aoMap", rockAO, 1);
+            rockMaterial->SetTexture("normalMap", rockNormal, 2);
+            rockMaterial->EnableKeyword(ShaderKeyword::NormalMap);
+            rockMaterial->EnableKeyword(ShaderKeyword::ShadowReceive);
+            rockRenderer->SetMeshes(rockModel.GetMeshes());
+            rockRenderer->SetMaterial(rockMaterial);
+            rockGO->transform->rotation = glm::vec3(-90, 0, 0);
+            rockGO->transform->scale = glm::vec3(0.3f, 0.3f, 0.3f);
+
+            auto suzanneGO = scene->CreateObject("Suzanne");
+            Model suzanneModel = AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
+            auto suzanneMaterial = std::make_shared<Material>(litSurfaceShader);
+            suzanneMaterial->EnableKeyword(ShaderKeyword::ShadowReceive);
+            auto suzanneRenderer = suzanneGO->AddComponent<Renderer>();
+            suzanneRenderer->SetMeshes(suzanneModel.GetMeshes());
+            suzanneRenderer->SetMaterial(suzanneMaterial);
+
+            auto quadGO = scene->CreateObject("Quad");
+            quadGO->SetParent(suzanneGO);
+            quadGO->transform->position = glm::vec3(0, 0, -2.5f);
+            quadGO->transform->scale = glm::vec3(5, 5, 1);
+            Mesh quadMesh = Mesh::GenerateQuad();
+            auto quadTexture = std::make_shared<Texture>("assets/textures/CMGaTo_crop.png");
+            auto quadMaterial = std::make_shared<Material>(textureShader->ID);
+            quadMaterial->SetTexture("text", quadTexture, 0);
+            auto quadRenderer = quadGO->AddComponent<Renderer>();
+            quadRenderer->SetMesh(quadMesh);
+            quadRenderer->SetMaterial(quadMaterial);
+
+            auto lightGO = scene->CreateObject("Light");
+            Model lightModel = AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
+            auto lightMaterial = std::make_shared<Material>(lightBulbShader->ID);
+            auto lightRenderer = lightGO->AddComponent<Renderer>();
+            lightRenderer->SetMeshes(lightModel.GetMeshes());
+            lightRenderer->SetMaterial(lightMaterial);
+            lightGO->transform->position = glm::vec3(2.0f, 2.0f, 2.0f);
+            lightGO->transform->scale = glm::vec3(.1f, .1f, .1f);
+            auto lightComp = lightGO->AddComponent<Light>();
+            lightComp->color = glm::vec4(1.0f, 0.8f, 0.2f, 1.0f);
+        });
+
+        // Register Default Scene 2
+        sceneManager.RegisterScene("Default Scene 2", [=](std::shared_ptr<Scene> scene) {
+            auto suzanneGO = scene->CreateObject("Suzanne1");
+            Model suzanneModel = AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
+            auto suzanneMaterial = std::make_shared<Material>(litSurfaceShader);
+            suzanneMaterial->EnableKeyword(ShaderKeyword::ShadowReceive);
+            auto suzanneRenderer = suzanneGO->AddComponent<Renderer>();
+            suzanneRenderer->SetMeshes(suzanneModel.GetMeshes());
+            suzanneRenderer->SetMaterial(suzanneMaterial);
+
+            auto suzanneGO2 = scene->CreateObject("Suzanne2");
+            suzanneGO2->transform->position = glm::vec3(3, 0, 0);
+            Model suzanneModel2 = AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
+            auto suzanneMaterial2 = std::make_shared<Material>(litSurfaceShader);
+            suzanneMaterial2->EnableKeyword(ShaderKeyword::ShadowReceive);
+            auto suzanneRenderer2 = suzanneGO2->AddComponent<Renderer>();
+            suzanneRenderer2->SetMeshes(suzanneModel2.GetMeshes());
+            suzanneRenderer2->SetMaterial(suzanneMaterial2);
+
+            auto lightGO = scene->CreateObject("Light");
+            Model lightModel = AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
+            auto lightMaterial = std::make_shared<Material>(lightBulbShader->ID);
+            auto lightRenderer = lightGO->AddComponent<Renderer>();
+            lightRenderer->SetMeshes(lightModel.GetMeshes());
+            lightRenderer->SetMaterial(lightMaterial);
+            lightGO->transform->position = glm::vec3(2.0f, 2.0f, 2.0f);
+            lightGO->transform->scale = glm::vec3(.1f, .1f, .1f);
+            auto lightComp = lightGO->AddComponent<Light>();
+            lightComp->color = glm::vec4(1.0f, 0.8f, 0.2f, 1.0f);
+
+            auto lightGO2 = scene->CreateObject("Light2");
+            Model lightModel2 = AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
+            auto lightMaterial2 = std::make_shared<Material>(lightBulbShader->ID);
+            auto lightRenderer2 = lightGO2->AddComponent<Renderer>();
+            lightRenderer2->SetMeshes(lightModel2.GetMeshes());
+            lightRenderer2->SetMaterial(lightMaterial2);
+            lightGO2->transform->position = glm::vec3(-2.0f, 0, -2.0f);
+            lightGO2->transform->scale = glm::vec3(.1f, .1f, .1f);
+            auto lightComp2 = lightGO2->AddComponent<Light>();
+            lightComp2->color = glm::vec4(0.2f, 0.8f, 1.0f, 1.0f);
+        });
+
+        // Register a clustered lighting stress scene: 1024 small point lights over a field of models
+        sceneManager.RegisterScene("Stress Scene (1024 Lights)", [=](std::shared_ptr<Scene> scene) {
+            auto groundTexture = std::make_shared<Texture>("assets/textures/rockTexture.jpeg");
+            auto groundAO = std::make_shared<Texture>("assets/textures/rockAO.jpeg");
+
+            auto groundGO = scene->CreateObject("Ground");
+            groundGO->transform->rotation = glm::vec3(-90, 0, 0);
+            groundGO->transform->scale = glm::vec3(40, 40, 1);
+            auto groundMaterial = std::make_shared<Material>(litSurfaceShader);
+            groundMaterial->SetTexture("albedoMap", groundTexture, 0);
+            groundMaterial->SetTexture("aoMap", groundAO, 1);
+            auto groundRenderer = groundGO->AddComponent<Renderer>();
+            groundRenderer->SetMesh(Mesh::GenerateQuad());
+            groundRenderer->SetMaterial(groundMaterial);
+
+            Model suzanneModel = AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
+            auto suzanneMaterial = std::make_shared<Material>(litSurfaceShader);
+            suzanneMaterial->SetTexture("albedoMap", groundTexture, 0);
+            suzanneMaterial->SetTexture("aoMap", groundAO, 1);
+            for (int x = 0; x < 8; ++x)
+            {
+                for (int z = 0; z < 8; ++z)
+                {
+                    auto suzanneGO = scene->CreateObject("Suzanne " + std::to_string(x * 8 + z));
+                    suzanneGO->transform->position = glm::vec3(-28.0f + x * 8.0f, 1.0f, -28.0f + z * 8.0f);
+                    auto suzanneRenderer = suzanneGO->AddComponent<Renderer>();
+                    suzanneRenderer->SetMeshes(suzanneModel.GetMeshes());
+                    suzanneRenderer->SetMaterial(suzanneMaterial);
+                }
+            }
+
+            // Fixed seed so every run (and every profile) sees the same light layout
+            std::mt19937 rng(1337);
+            std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+            std::uniform_real_distribution<float> channel(0.2f, 1.0f);
+            for (int x = 0; x < 32; ++x)
+            {
+                for (int z = 0; z < 32; ++z)
+                {
+                    auto lightGO = scene->CreateObject("Point Light " + std::to_string(x * 32 + z));
+                    lightGO->transform->position = glm::vec3(-38.75f + x * 2.5f + jitter(rng), 0.75f, -38.75f + z * 2.5f + jitter(rng));
+                    auto lightComp = lightGO->AddComponent<Light>();
+                    lightComp->color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
+                    lightComp->intensity = 2.0f;
+                    lightComp->range = 3.0f;
+                }
+            }
+        });
+
+        StressSceneGenerator::RegisterPresets(sceneManager);
+
+        printf("[SCENES] Default scenes registered\n");
+    }
+} // namespace core
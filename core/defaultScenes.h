@@ -0,0 +1,20 @@
+#pragma once
+
+#include "sceneManager.h"
+
+namespace core
+{
+    /// <summary>
+    /// Example scenes shared by the editor and the headless runner.
+    /// </summary>
+    class DefaultScenes
+    {
+    public:
+        /// <summary>
+        /// Registers the example scenes with the scene manager.
+        /// The shaders they use are created here and owned by the registered factories.
+        /// </summary>
+        /// <param name="sceneManager">Scene manager to register the scenes with.</param>
+        static void Register(SceneManager& sceneManager);
+    };
+} // namespace core
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace core
+{
+    /// <summary>
+    /// 64-bit FNV-1a helpers used for cache keys and change detection.
+    /// </summary>
+    namespace hash
+    {
+        inline constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+        inline constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+        /// <summary>
+        /// Folds raw bytes into a running hash.
+        /// </summary>
+        inline std::uint64_t HashBytes(std::uint64_t hash, const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= FNV_PRIME;
+            }
+            return hash;
+        }
+
+        /// <summary>
+        /// Folds the object representation of a trivially copyable value into a running hash.
+        /// </summary>
+        template<typename T>
+        std::uint64_t HashValue(std::uint64_t hash, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "HashValue needs a trivially copyable type");
+            return HashBytes(hash, &value, sizeof(T));
+        }
+    } // namespace hash
+} // namespace core
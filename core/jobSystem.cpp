@@ -0,0 +1,128 @@
+#include "jobSystem.h"
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+    namespace
+    {
+        /// <summary>
+        /// Worker threads plus the state of the job currently being executed.
+        /// </summary>
+        struct WorkerPool
+        {
+            std::vector<std::thread> workers;
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::condition_variable done;
+
+            const std::function<void(int, int)>* job = nullptr;
+            int count = 0;
+            int chunkSize = 1;
+            std::atomic<int> next{ 0 };
+            int pendingWorkers = 0;
+            std::uint64_t generation = 0;
+            bool shutdown = false;
+
+            WorkerPool()
+            {
+                unsigned int hardwareThreads = std::thread::hardware_concurrency();
+                int workerCount = hardwareThreads > 1 ? static_cast<int>(hardwareThreads) - 1 : 0;
+                for (int i = 0; i < workerCount; ++i)
+                    workers.emplace_back(&WorkerPool::WorkerLoop, this);
+            }
+
+            ~WorkerPool()
+            {
+                {
+                    std::lock_guard lock(mutex);
+                    shutdown = true;
+                }
+                wake.notify_all();
+                for (auto& worker : workers)
+                    worker.join();
+            }
+
+            void RunChunks()
+            {
+                for (int begin = next.fetch_add(chunkSize); begin < count; begin = next.fetch_add(chunkSize))
+                {
+                    FINALENGINE_PROFILE_ZONE("JobSystem::Chunk");
+                    (*job)(begin, std::min(begin + chunkSize, count));
+                }
+            }
+
+            void WorkerLoop()
+            {
+                FINALENGINE_PROFILE_THREAD("Job Worker");
+                std::uint64_t seenGeneration = 0;
+                while (true)
+                {
+                    {
+                        std::unique_lock lock(mutex);
+                        wake.wait(lock, [&] { return shutdown || generation != seenGeneration; });
+                        if (shutdown) return;
+                        seenGeneration = generation;
+                    }
+
+                    RunChunks();
+
+                    std::lock_guard lock(mutex);
+                    if (--pendingWorkers == 0)
+                        done.notify_one();
+                }
+            }
+        };
+
+        WorkerPool& GetPool()
+        {
+            static WorkerPool pool;
+            return pool;
+        }
+    } // namespace
+
+    void JobSystem::ParallelFor(int count, const std::function<void(int begin, int end)>& job, int minChunkSize)
+    {
+        if (count <= 0) return;
+
+        WorkerPool& pool = GetPool();
+        int threads = static_cast<int>(pool.workers.size()) + 1;
+
+        // Not worth waking the workers for less than two chunks of work
+        if (pool.workers.empty() || count < minChunkSize * 2)
+        {
+            job(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard lock(pool.mutex);
+            pool.job = &job;
+            pool.count = count;
+            // A few chunks per thread so uneven chunks balance out
+            pool.chunkSize = std::max(minChunkSize, count / (threads * 4));
+            pool.next = 0;
+            pool.pendingWorkers = static_cast<int>(pool.workers.size());
+            pool.generation++;
+        }
+        pool.wake.notify_all();
+
+        // The calling thread helps instead of idling
+        pool.RunChunks();
+
+        std::unique_lock lock(pool.mutex);
+        pool.done.wait(lock, [&] { return pool.pendingWorkers == 0; });
+        pool.job = nullptr;
+    }
+
+    int JobSystem::GetWorkerCount()
+    {
+        return static_cast<int>(GetPool().workers.size());
+    }
+} // namespace core
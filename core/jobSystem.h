@@ -0,0 +1,32 @@
+#pragma once
+
+#include <functional>
+
+namespace core
+{
+    /// <summary>
+    /// Minimal fork/join helper backed by a persistent pool of worker threads.
+    /// </summary>
+    /// <remarks>
+    /// The workers are created on first use and live until the program exits.
+    /// ParallelFor() is meant to be called from one thread at a time (the render thread)
+    /// and must not be nested.
+    /// </remarks>
+    class JobSystem
+    {
+    public:
+        /// <summary>
+        /// Splits [0, count) into chunks and runs them on the workers and the calling thread.
+        /// Returns once every chunk has finished.
+        /// </summary>
+        /// <param name="count">Number of items to process.</param>
+        /// <param name="job">Called with half-open [begin, end) ranges. Must be thread-safe.</param>
+        /// <param name="minChunkSize">Smallest range handed to a single call of the job.</param>
+        static void ParallelFor(int count, const std::function<void(int begin, int end)>& job, int minChunkSize = 1);
+
+        /// <summary>
+        /// Gets the number of background worker threads (excluding the calling thread).
+        /// </summary>
+        static int GetWorkerCount();
+    };
+} // namespace core
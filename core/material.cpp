@@ -7,7 +7,8 @@ namespace core
 {
     void Material::Use() const
     {
-        glUseProgram(m_shaderProgram);
+        GLuint program = GetShaderProgram();
+        glUseProgram(program);
 
         // Bind Texture objects
         for (const auto& [name, texData] : m_textures)
@@ -16,7 +17,7 @@ namespace core
             {
                 glActiveTexture(GL_TEXTURE0 + texData.slot);
                 glBindTexture(GL_TEXTURE_2D, texData.texture->getId());
-                GLint location = glGetUniformLocation(m_shaderProgram, name.c_str());
+                GLint location = glGetUniformLocation(program, name.c_str());
                 if (location != -1)
                 {
                     glUniform1i(location, texData.slot);
@@ -31,7 +32,7 @@ namespace core
             {
                 glActiveTexture(GL_TEXTURE0 + texData.slot);
                 glBindTexture(GL_TEXTURE_2D, texData.textureID);
-                GLint location = glGetUniformLocation(m_shaderProgram, name.c_str());
+                GLint location = glGetUniformLocation(program, name.c_str());
                 if (location != -1)
                 {
                     glUniform1i(location, texData.slot);
@@ -42,37 +43,43 @@ namespace core
         // Set uniforms
         for (const auto& [name, value] : m_floats)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniform1f(loc, value);
         }
 
         for (const auto& [name, value] : m_ints)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniform1i(loc, value);
         }
 
         for (const auto& [name, value] : m_bools)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniform1i(loc, value);
         }
 
+        for (const auto& [name, value] : m_vec2s)
+        {
+            GLint loc = glGetUniformLocation(program, name.c_str());
+            if (loc != -1) glUniform2fv(loc, 1, glm::value_ptr(value));
+        }
+
         for (const auto& [name, value] : m_vec3s)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniform3fv(loc, 1, glm::value_ptr(value));
         }
 
         for (const auto& [name, value] : m_vec4s)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniform4fv(loc, 1, glm::value_ptr(value));
         }
 
         for (const auto& [name, value] : m_mat4s)
         {
-            GLint loc = glGetUniformLocation(m_shaderProgram, name.c_str());
+            GLint loc = glGetUniformLocation(program, name.c_str());
             if (loc != -1) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
         }
     }
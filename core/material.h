@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include "Rendering/shaderVariants.h"
 #include "Rendering/texture.h"
 
 namespace core
@@ -13,8 +15,40 @@ namespace core
     public:
         Material() = default;
         explicit Material(GLuint shaderProgram) : m_shaderProgram(shaderProgram) {}
-        void SetShaderProgram(GLuint program) { m_shaderProgram = program; }
-        GLuint GetShaderProgram() const { return m_shaderProgram; }
+
+        /// <summary>
+        /// Creates a material whose program is picked from the given variants based on the
+        /// enabled keywords and the scene's light count.
+        /// <para>
+        /// The albedo tint starts out white. Uniforms are program state shared by every material on
+        /// the program, so each material sets its own tint instead of relying on the shader default.
+        /// </para>
+        /// </summary>
+        /// <param name="variants">The shader variants to select from.</param>
+        explicit Material(std::shared_ptr<ShaderVariants> variants) : m_variants(std::move(variants))
+        {
+            SetVec3("albedoTint", glm::vec3(1.0f));
+        }
+
+        void SetShaderProgram(GLuint program) { m_shaderProgram = program; m_variants.reset(); }
+
+        /// <summary>
+        /// Gets the program Use() binds. For variant materials this is the variant matching
+        /// the current keywords, compiled on first request.
+        /// </summary>
+        GLuint GetShaderProgram() const { return m_variants ? m_variants->Get(m_keywords) : m_shaderProgram; }
+
+        /// <summary>
+        /// Enables a feature keyword. Only affects materials created from ShaderVariants.
+        /// </summary>
+        void EnableKeyword(ShaderKeyword keyword) { m_keywords |= static_cast<std::uint32_t>(keyword); }
+
+        /// <summary>
+        /// Disables a feature keyword. Only affects materials created from ShaderVariants.
+        /// </summary>
+        void DisableKeyword(ShaderKeyword keyword) { m_keywords &= ~static_cast<std::uint32_t>(keyword); }
+
+        bool IsKeywordEnabled(ShaderKeyword keyword) const { return (m_keywords & static_cast<std::uint32_t>(keyword)) != 0; }
 
         /// <summary>
         /// Associates a Texture object with a shader uniform and texture unit.
@@ -73,6 +107,14 @@ namespace core
         /// <param name="value">The boolean value to set</param>
         void SetBool(const std::string& name, bool value) { m_bools[name] = value ? 1 : 0; }
         
+        /// <summary>
+        /// Sets a vec2 uniform value.
+        /// Common uses: texture coordinate scales and offsets, sizes.
+        /// </summary>
+        /// <param name="name">The name of the uniform in the shader</param>
+        /// <param name="value">The vec2 value to set</param>
+        void SetVec2(const std::string& name, const glm::vec2& value) { m_vec2s[name] = value; }
+
         /// <summary>
         /// Sets a vec3 uniform value.
         /// Common uses: colors, positions, directions, normals.
@@ -105,6 +147,8 @@ namespace core
 
     private:
         GLuint m_shaderProgram = 0;
+        std::shared_ptr<ShaderVariants> m_variants;
+        std::uint32_t m_keywords = 0;
         
         struct TextureData
         {
@@ -123,6 +167,7 @@ namespace core
         std::unordered_map<std::string, float> m_floats;
         std::unordered_map<std::string, int> m_ints;
         std::unordered_map<std::string, bool> m_bools;
+        std::unordered_map<std::string, glm::vec2> m_vec2s;
         std::unordered_map<std::string, glm::vec3> m_vec3s;
         std::unordered_map<std::string, glm::vec4> m_vec4s;
         std::unordered_map<std::string, glm::mat4> m_mat4s;
@@ -1,8 +1,10 @@
 #pragma once
 #include "Components/Transform.h"
 #include "Object.h"
+#include "componentStorage.h"
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace core {
@@ -18,17 +20,22 @@ namespace core {
     /// Must keep:
     /// - Parent holds strong refs to children; child holds a weak ref to parent.
     /// - Components are stored as shared_ptr and detached by reference.
+    /// - An object created in a scene is an entity of the scene's ComponentStorage. Every change to
+    ///   m_components goes through SyncStoredComponent so the storage matches GetComponent.
     /// </remarks>
     class GameObject : public Object {
     public:
         std::shared_ptr<core::Transform> transform;
 
         /// <summary>
-        /// Factory Pattern method for creating a new GameObject.
+        /// Factory Pattern method for creating a new GameObject in the given scene.
+        /// Prefer Scene::CreateObject, which also adds the object to the roots or to a parent.
         /// </summary>
-        /// <param name="name"></param>
-        /// <returns></returns>
-        static std::shared_ptr<GameObject> Create(std::string name = {});
+        /// <param name="name">The name of the object.</param>
+        /// <param name="scene">The scene the object belongs to, nullptr for an object outside any scene.</param>
+        static std::shared_ptr<GameObject> Create(std::string name = {}, const std::shared_ptr<Scene>& scene = nullptr);
+
+        ~GameObject() override;
 
         /// <summary>
         /// Set this object's parent (handles both sides of the relation)
@@ -78,6 +85,7 @@ namespace core {
             if (std::find(m_components.begin(), m_components.end(), c) == m_components.end()) {
                 c->OnAttach(std::static_pointer_cast<GameObject>(shared_from_this()));
                 m_components.push_back(c);
+                SyncStoredComponent(*c);
             }
 
             return c;
@@ -102,6 +110,7 @@ namespace core {
 
             component->OnAttach(std::static_pointer_cast<GameObject>(shared_from_this()));
             m_components.push_back(component);
+            SyncStoredComponent(*component);
             return true;
         }
 
@@ -128,6 +137,7 @@ namespace core {
             size_t index = std::clamp(static_cast<size_t>(componentIndex), size_t(0), m_components.size());
 
             m_components.emplace(m_components.begin() + index, component);
+            SyncStoredComponent(*component);
             return true;
         }
 
@@ -163,6 +173,7 @@ namespace core {
                 if (m_components[i] == component) {
                     m_components[i]->OnDetach();
                     m_components.erase(m_components.begin() + i);
+                    SyncStoredComponent(*component);
                     return true;
                 }
             }
@@ -170,13 +181,24 @@ namespace core {
         }
 
         /// <summary>
-        /// 
+        /// Returns the first component of type T, or nullptr.
+        /// <para>
+        /// Final component types are looked up in the scene's ComponentStorage, other types
+        /// (base classes, objects outside a scene) scan the component list.
+        /// </para>
         /// </summary>
         /// <typeparam name="T"></typeparam>
         /// <returns></returns>
         template<typename T>
         std::shared_ptr<T> GetComponent() const
         {
+            if constexpr (std::is_final_v<T>) {
+                if (m_storage) {
+                    Component* c = m_storage->Get<T>(m_entity);
+                    return c ? std::static_pointer_cast<T>(c->shared_from_this()) : nullptr;
+                }
+            }
+
             for (const auto& comp : m_components) {
                 auto casted = std::dynamic_pointer_cast<T>(comp);
                 if (casted) {
@@ -219,11 +241,19 @@ namespace core {
         void SetChildrenEnabledState(bool enabled);
         void OnEnabledChanged(bool newValue) override;
 
+        /// <summary>
+        /// Stores all components with the exact type of the given one in the scene's
+        /// ComponentStorage, in the order of m_components.
+        /// </summary>
+        void SyncStoredComponent(const Component& component);
+
 
         std::weak_ptr<GameObject> m_parent;
         std::vector<std::shared_ptr<GameObject>> m_children;
         std::vector<std::shared_ptr<Component>> m_components;
         std::weak_ptr<Scene> m_scene;
+        std::shared_ptr<ComponentStorage> m_storage;    // Outlives the scene while the object exists
+        ComponentStorage::EntityId m_entity = ComponentStorage::INVALID_ENTITY;
     };
 
 
@@ -0,0 +1,175 @@
+#include "componentStorage.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace core
+{
+    ComponentStorage::ComponentStorage()
+    {
+        // Entities start out in the archetype without components
+        GetArchetype({});
+    }
+
+    ComponentStorage::~ComponentStorage() = default;
+
+    std::uint32_t ComponentStorage::GetTypeId(std::type_index type)
+    {
+        // Scenes can be built on a loading thread, the first use of a type may come from either
+        static std::mutex mutex;
+        static std::unordered_map<std::type_index, std::uint32_t> ids;
+
+        std::lock_guard lock(mutex);
+        auto [it, inserted] = ids.try_emplace(type, static_cast<std::uint32_t>(ids.size()));
+        if (inserted && it->second >= MAX_COMPONENT_TYPES)
+        {
+            printf("[ECS] More than %zu component types, raise ComponentStorage::MAX_COMPONENT_TYPES\n", MAX_COMPONENT_TYPES);
+            std::abort();
+        }
+        return it->second;
+    }
+
+    ComponentStorage::EntityId ComponentStorage::CreateEntity(GameObject* object)
+    {
+        EntityId entity;
+        if (!m_freeEntities.empty())
+        {
+            entity = m_freeEntities.back();
+            m_freeEntities.pop_back();
+        }
+        else
+        {
+            entity = static_cast<EntityId>(m_records.size());
+            m_records.emplace_back();
+        }
+
+        m_records[entity].object = object;
+        Insert(entity, GetArchetype({}));
+        return entity;
+    }
+
+    void ComponentStorage::DestroyEntity(EntityId entity)
+    {
+        if (entity >= m_records.size() || !m_records[entity].archetype) return;
+
+        Remove(entity);
+        m_records[entity] = {};
+        m_freeEntities.push_back(entity);
+    }
+
+    void ComponentStorage::SetComponents(EntityId entity, std::type_index type, const std::vector<Component*>& components)
+    {
+        Record& record = m_records[entity];
+        const std::uint32_t typeId = GetTypeId(type);
+        Archetype& source = *record.archetype;
+        const int first = source.columnOf[typeId];
+        const std::size_t count = components.size();
+
+        // Same number of components, only the pointers change
+        if (static_cast<int>(count) == source.columnCount[typeId])
+        {
+            Chunk& chunk = *source.chunks[record.chunk];
+            for (std::size_t i = 0; i < count; ++i)
+                chunk.columns[first + i][record.row] = components[i];
+            return;
+        }
+
+        // Move the row to the archetype with the new number of columns of this type, copying the others
+        std::vector<std::uint32_t> columnTypes;
+        columnTypes.reserve(source.columnTypes.size() + count);
+        for (std::uint32_t columnType : source.columnTypes)
+            if (columnType != typeId) columnTypes.push_back(columnType);
+        columnTypes.insert(std::upper_bound(columnTypes.begin(), columnTypes.end(), typeId), count, typeId);
+
+        Archetype& destination = GetArchetype(columnTypes);
+        const Chunk& sourceChunk = *source.chunks[record.chunk];
+        std::vector<Component*> row(columnTypes.size(), nullptr);
+        for (std::size_t column = 0; column < columnTypes.size(); ++column)
+        {
+            // The k-th column of a type maps onto the k-th column of that type in the source
+            const std::uint32_t columnType = columnTypes[column];
+            const std::size_t k = column - destination.columnOf[columnType];
+            row[column] = columnType == typeId ? components[k] : sourceChunk.columns[source.columnOf[columnType] + k][record.row];
+        }
+
+        Remove(entity);
+        Insert(entity, destination);
+        Chunk& chunk = *destination.chunks[record.chunk];
+        for (std::size_t column = 0; column < row.size(); ++column)
+            chunk.columns[column][record.row] = row[column];
+    }
+
+    ComponentStorage::Archetype& ComponentStorage::GetArchetype(const std::vector<std::uint32_t>& columnTypes)
+    {
+        auto& archetype = m_archetypeByTypes[columnTypes];
+        if (archetype) return *archetype;
+
+        archetype = std::make_unique<Archetype>();
+        archetype->columnTypes = columnTypes;
+        archetype->columnOf.fill(-1);
+        archetype->columnCount.fill(0);
+        for (std::size_t column = 0; column < columnTypes.size(); ++column)
+        {
+            const std::uint32_t typeId = columnTypes[column];
+            if (archetype->columnCount[typeId]++ == 0)
+                archetype->columnOf[typeId] = static_cast<int>(column);
+            archetype->mask |= std::uint64_t(1) << typeId;
+        }
+        m_archetypes.push_back(archetype.get());
+        return *archetype;
+    }
+
+    void ComponentStorage::Insert(EntityId entity, Archetype& archetype)
+    {
+        if (archetype.chunks.empty() || archetype.chunks.back()->count == CHUNK_ROWS)
+        {
+            auto chunk = std::make_unique<Chunk>();
+            chunk->objects = std::make_unique<GameObject*[]>(CHUNK_ROWS);
+            chunk->entities = std::make_unique<EntityId[]>(CHUNK_ROWS);
+            for (std::size_t i = 0; i < archetype.columnTypes.size(); ++i)
+                chunk->columns.push_back(std::make_unique<Component*[]>(CHUNK_ROWS));
+            archetype.chunks.push_back(std::move(chunk));
+        }
+
+        Chunk& chunk = *archetype.chunks.back();
+        const std::size_t row = chunk.count++;
+        chunk.objects[row] = m_records[entity].object;
+        chunk.entities[row] = entity;
+        for (auto& column : chunk.columns)
+            column[row] = nullptr;
+
+        Record& record = m_records[entity];
+        record.archetype = &archetype;
+        record.chunk = static_cast<std::uint32_t>(archetype.chunks.size() - 1);
+        record.row = static_cast<std::uint32_t>(row);
+        archetype.entityCount++;
+    }
+
+    void ComponentStorage::Remove(EntityId entity)
+    {
+        Record& record = m_records[entity];
+        Archetype& archetype = *record.archetype;
+        Chunk& chunk = *archetype.chunks[record.chunk];
+        Chunk& lastChunk = *archetype.chunks.back();
+        const std::size_t lastRow = lastChunk.count - 1;
+
+        // Keeps every chunk but the last one full
+        const EntityId moved = lastChunk.entities[lastRow];
+        if (moved != entity)
+        {
+            chunk.objects[record.row] = lastChunk.objects[lastRow];
+            chunk.entities[record.row] = moved;
+            for (std::size_t i = 0; i < chunk.columns.size(); ++i)
+                chunk.columns[i][record.row] = lastChunk.columns[i][lastRow];
+            m_records[moved].chunk = record.chunk;
+            m_records[moved].row = record.row;
+        }
+
+        if (--lastChunk.count == 0)
+            archetype.chunks.pop_back();
+        archetype.entityCount--;
+        record.archetype = nullptr;
+    }
+} // namespace core
@@ -0,0 +1,201 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <vector>
+
+namespace core
+{
+    class Component;
+    class GameObject;
+
+    /// <summary>
+    /// Archetype storage of the components of one scene, underneath the GameObject/Component API.
+    /// <para>
+    /// Every GameObject is an entity. Entities with the same components (types and how many of each)
+    /// share an archetype, which stores them in fixed size chunks with one contiguous column per
+    /// component, so a query walks the matching chunks linearly instead of chasing lists.
+    /// </para>
+    /// </summary>
+    /// <remarks>
+    /// Must keep:
+    /// - Components stay owned by their GameObject (shared_ptr, shared_from_this, weak references elsewhere),
+    ///   the columns hold non-owning pointers that GameObject keeps in sync.
+    /// - Every component is stored. The columns of one type are in the order of the GameObject's
+    ///   component list, so the first one is the component GetComponent returns.
+    /// - Components are stored by their exact type; base types are not tracked.
+    /// - Not thread safe. A scene is built on one thread and rendered on one thread at a time.
+    /// </remarks>
+    class ComponentStorage
+    {
+    public:
+        using EntityId = std::uint32_t;
+        static constexpr EntityId INVALID_ENTITY = ~0u;
+        static constexpr std::size_t MAX_COMPONENT_TYPES = 64;  // One bit per type in an archetype mask
+        static constexpr std::size_t CHUNK_ROWS = 512;
+
+        ComponentStorage();
+        ~ComponentStorage();
+
+        ComponentStorage(const ComponentStorage&) = delete;
+        ComponentStorage& operator=(const ComponentStorage&) = delete;
+
+        /// <summary>
+        /// Adds an entity without components for the given GameObject.
+        /// </summary>
+        EntityId CreateEntity(GameObject* object);
+
+        /// <summary>
+        /// Removes an entity and its component pointers. The id is reused.
+        /// </summary>
+        void DestroyEntity(EntityId entity);
+
+        /// <summary>
+        /// Sets the components of a type for an entity, moving the entity to another archetype
+        /// when the number of components of that type changes.
+        /// </summary>
+        /// <param name="entity">The entity to change.</param>
+        /// <param name="type">The exact type of the components.</param>
+        /// <param name="components">All components of that type in order, empty removes the type.</param>
+        void SetComponents(EntityId entity, std::type_index type, const std::vector<Component*>& components);
+
+        /// <summary>
+        /// Gets the first component of exact type T of an entity.
+        /// </summary>
+        /// <returns>The component, or nullptr if the entity has none of that type.</returns>
+        template<typename T>
+        Component* Get(EntityId entity) const
+        {
+            const Record& record = m_records[entity];
+            const int column = record.archetype->columnOf[TypeId<T>()];
+            return column < 0 ? nullptr : record.archetype->chunks[record.chunk]->columns[column][record.row];
+        }
+
+        /// <summary>
+        /// Calls func(GameObject&amp;, Ts&amp;...) for every entity that has all component types Ts,
+        /// walking the chunks of the matching archetypes linearly. An entity with several components
+        /// of a type is visited once for every combination of them.
+        /// Components must not be added or removed from inside func.
+        /// </summary>
+        template<typename... Ts, typename Func>
+        void Query(Func&& func) const
+        {
+            static_assert(sizeof...(Ts) > 0, "Query at least one component type");
+            constexpr std::size_t N = sizeof...(Ts);
+            const std::uint64_t mask = ((std::uint64_t(1) << TypeId<Ts>()) | ... | 0);
+            for (const auto& archetype : m_archetypes)
+            {
+                if ((archetype->mask & mask) != mask) continue;
+
+                const std::array<int, N> first = { archetype->columnOf[TypeId<Ts>()]... };
+                const std::array<int, N> counts = { archetype->columnCount[TypeId<Ts>()]... };
+                for (const auto& chunk : archetype->chunks)
+                {
+                    // Every combination of the columns of each type, a single one unless a type repeats
+                    std::array<int, N> columns = first;
+                    for (;;)
+                    {
+                        QueryChunk<Ts...>(*chunk, columns, func, std::index_sequence_for<Ts...>{});
+
+                        std::size_t i = 0;
+                        for (; i < N; ++i)
+                        {
+                            if (++columns[i] < first[i] + counts[i]) break;
+                            columns[i] = first[i];
+                        }
+                        if (i == N) break;
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Counts the calls Query&lt;Ts...&gt; makes: the entities that have all component types Ts,
+        /// times the combinations of their components.
+        /// </summary>
+        template<typename... Ts>
+        std::size_t Count() const
+        {
+            const std::uint64_t mask = ((std::uint64_t(1) << TypeId<Ts>()) | ... | 0);
+            std::size_t count = 0;
+            for (const auto& archetype : m_archetypes)
+            {
+                if ((archetype->mask & mask) == mask)
+                    count += archetype->entityCount * (std::size_t(1) * ... * archetype->columnCount[TypeId<Ts>()]);
+            }
+            return count;
+        }
+
+        std::size_t GetArchetypeCount() const { return m_archetypes.size(); }
+
+        /// <summary>
+        /// Gets the small id of a component type, assigned on first use and shared by all scenes.
+        /// </summary>
+        template<typename T>
+        static std::uint32_t TypeId()
+        {
+            static const std::uint32_t id = GetTypeId(typeid(T));
+            return id;
+        }
+
+        static std::uint32_t GetTypeId(std::type_index type);
+
+    private:
+        struct Chunk
+        {
+            std::size_t count = 0;
+            std::unique_ptr<GameObject*[]> objects;
+            std::unique_ptr<EntityId[]> entities;
+            std::vector<std::unique_ptr<Component*[]>> columns;     // Parallel to Archetype::columnTypes
+        };
+
+        struct Archetype
+        {
+            std::uint64_t mask = 0;                                 // Bit set for every type with a column
+            std::vector<std::uint32_t> columnTypes;                 // Type id of every column, sorted
+            std::array<int, MAX_COMPONENT_TYPES> columnOf;          // First column of a type id, -1 if absent
+            std::array<int, MAX_COMPONENT_TYPES> columnCount;       // Number of columns of a type id
+            std::vector<std::unique_ptr<Chunk>> chunks;             // All full except the last
+            std::size_t entityCount = 0;
+        };
+
+        struct Record
+        {
+            GameObject* object = nullptr;
+            Archetype* archetype = nullptr;
+            std::uint32_t chunk = 0;
+            std::uint32_t row = 0;
+        };
+
+        template<typename... Ts, typename Func, std::size_t... Is>
+        static void QueryChunk(const Chunk& chunk, const std::array<int, sizeof...(Ts)>& columns, Func& func, std::index_sequence<Is...>)
+        {
+            Component* const* data[] = { chunk.columns[columns[Is]].get()... };
+            for (std::size_t row = 0; row < chunk.count; ++row)
+                func(*chunk.objects[row], static_cast<Ts&>(*data[Is][row])...);
+        }
+
+        /// <summary>
+        /// Gets or creates the archetype with the given sorted column types.
+        /// </summary>
+        Archetype& GetArchetype(const std::vector<std::uint32_t>& columnTypes);
+
+        /// <summary>
+        /// Appends the entity to an archetype, with empty component pointers.
+        /// </summary>
+        void Insert(EntityId entity, Archetype& archetype);
+
+        /// <summary>
+        /// Removes the entity from its archetype, the last entity of the archetype fills the gap.
+        /// </summary>
+        void Remove(EntityId entity);
+
+        std::map<std::vector<std::uint32_t>, std::unique_ptr<Archetype>> m_archetypeByTypes;
+        std::vector<Archetype*> m_archetypes;                       // Creation order, for stable queries
+        std::vector<Record> m_records;
+        std::vector<EntityId> m_freeEntities;
+    };
+} // namespace core
@@ -3,6 +3,7 @@
 #include "../gameObject.h"
 #include "Light.h"
 #include "Renderer.h"
+#include <algorithm>
 #include <imgui.h>
 
 namespace core
@@ -35,6 +36,32 @@ namespace core
 
         ImGui::Spacing();
 
+        ImGui::SliderFloat("Range", &range, 0.1f, 100.0f);
+
+        ImGui::Spacing();
+
+        if (lightType.Get() == LightType::Directional)
+        {
+            ImGui::SliderInt("Shadow Cascades", &shadowCascades, 2, 4);
+            ImGui::Checkbox("Blend Cascades", &blendCascades);
+
+            ImGui::Spacing();
+        }
+
+        if (auto scene = m_scene.lock())
+        {
+            const auto& lights = scene->GetLights();
+            auto it = std::find_if(lights.begin(), lights.end(), [this](const auto& light) { return light.get() == this; });
+            const auto& casterCounts = scene->GetShadowCasterCounts();
+            size_t index = static_cast<size_t>(it - lights.begin());
+            if (index < casterCounts.size() && casterCounts[index] >= 0)
+                ImGui::Text("Shadow Casters: %d", casterCounts[index]);
+            else
+                ImGui::Text("Shadow Casters: no shadow");
+
+            ImGui::Spacing();
+        }
+
         // Left arrow button
         float buttonWidth = ImGui::GetFrameHeight();
         if (ImGui::ArrowButton("##light_type_decrease", ImGuiDir_Left))
@@ -77,6 +104,10 @@ namespace core
             // Cache the renderer component
             m_renderer = go->GetComponent<Renderer>();
 
+            // The light's own visualization would block all of its light
+            if (auto renderer = m_renderer.lock())
+                renderer->castShadows = false;
+
             // Set initial color
             UpdateRendererColor(color.Get());
             UpdateRendererIntensity(intensity.Get());
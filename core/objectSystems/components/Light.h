@@ -2,6 +2,9 @@
 
 #include "../Component.h"
 #include "../../property.h"
+#include <glm/ext/vector_int4.hpp>
+#include <glm/ext/vector_uint4.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <memory>
@@ -68,15 +71,17 @@ namespace core
         return static_cast<int>(type);
     }
 
+    /// <summary>
+    /// Per-frame lighting constants (std140 uniform block "LightBlock", binding 0).
+    /// The lights themselves live in the clustered lighting storage buffers.
+    /// </summary>
     struct LightData
     {
-        glm::vec4 positions[4];     // 64 bytes (use vec4 for vec3 data, std140 pads anyway)
-        glm::vec4 directions[4];    // 64 bytes
-        glm::vec4 colors[4];        // 64 bytes
-        glm::ivec4 lightTypes[4];   // 64 bytes (each int padded to 16 bytes in std140)
-        alignas(16) int numLights;  // 16 bytes
-        int _pad[3];                // padding
-        // Total: 272 bytes
+        glm::mat4 viewMatrix;       // 64 bytes, used to find the depth slice of a fragment
+        glm::uvec4 clusterGrid;     // 16 bytes (xyz = cluster counts, w unused)
+        glm::vec4 clusterParams;    // 16 bytes (xy = tile size in pixels, z = slice scale, w = slice bias)
+        glm::ivec4 lightCounts;     // 16 bytes (x = directional, y = point + spot, zw unused)
+        // Total: 112 bytes
     };
 
     class Scene;
@@ -90,7 +95,7 @@ namespace core
     /// The Light component automatically registers itself with the scene's lighting system
     /// when attached to a GameObject and unregisters when detached.
     /// </remarks>
-    class Light : public Component
+    class Light final : public Component
     {
     public:
         /// <summary>
@@ -155,6 +160,22 @@ namespace core
         /// </summary>
         Property<LightType> lightType{ LightType::Point };
 
+        /// <summary>
+        /// Distance at which point and spot lights fade out completely.
+        /// Lights are only assigned to the clusters within this range.
+        /// </summary>
+        Property<float> range{ 10.0f };
+
+        /// <summary>
+        /// Number of shadow cascades of a directional light (2 to 4).
+        /// </summary>
+        Property<int> shadowCascades{ 4 };
+
+        /// <summary>
+        /// Cross-fades neighbouring shadow cascades of a directional light to hide the seams.
+        /// </summary>
+        Property<bool> blendCascades{ true };
+
         /// <summary>
         /// Gets the current color value of the light.
         /// </summary>
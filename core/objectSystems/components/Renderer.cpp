@@ -26,6 +26,8 @@ namespace core
     {
         ImGui::Text("Meshes: %zu", m_meshes.size());
 		ImGui::Text("Material: %s", m_material ? "Set" : "Not Set");
+        ImGui::Checkbox("Static", &isStatic);
+        ImGui::Checkbox("Cast Shadows", &castShadows);
     }
 
     void Renderer::OnAttach(std::weak_ptr<GameObject> owner)
@@ -1,9 +1,12 @@
 #pragma once
 #include "../../material.h"
+#include "../../property.h"
+#include "../../Rendering/bounds.h"
 #include "../../Rendering/mesh.h"
 #include "../Component.h"
 #include <core/ObjectSystems/gameObject.h>
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,7 +19,7 @@ namespace core
     /// Renderer component that holds meshes and a material for rendering.
     /// Combines mesh data and rendering properties in one component.
     /// </summary>
-    class Renderer : public Component
+    class Renderer final : public Component
     {
     public:
         Renderer() = default;
@@ -43,6 +46,22 @@ namespace core
 
         const std::vector<Mesh>& GetMeshes() const { return m_meshes; }
 
+        /// <summary>
+        /// Object-space bounds enclosing every mesh.
+        /// </summary>
+        Bounds GetLocalBounds() const
+        {
+            Bounds bounds;
+            for (const auto& mesh : m_meshes)
+                bounds.Encapsulate(mesh.GetBounds());
+            return bounds;
+        }
+
+        /// <summary>
+        /// World-space bounds for the given world matrix.
+        /// </summary>
+        Bounds GetWorldBounds(const glm::mat4& worldMatrix) const { return GetLocalBounds().Transformed(worldMatrix); }
+
         // Material management
         void SetMaterial(std::shared_ptr<Material> material) { m_material = material; }
         std::shared_ptr<Material> GetMaterial() const { return m_material; }
@@ -63,6 +82,17 @@ namespace core
         /// </summary>
         void OnDetach() override;
 
+        /// <summary>
+        /// Static renderers are not expected to move. Their shadows are kept in a cached layer
+        /// that is only re-rendered when a static caster or the light changes.
+        /// </summary>
+        Property<bool> isStatic{ false };
+
+        /// <summary>
+        /// Whether this renderer is drawn into the shadow maps of the lights it overlaps.
+        /// </summary>
+        Property<bool> castShadows{ true };
+
     private:
         std::vector<Mesh> m_meshes;
         std::shared_ptr<Material> m_material;
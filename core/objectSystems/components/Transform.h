@@ -6,7 +6,7 @@
 
 namespace core
 {
-    class Transform : public Component
+    class Transform final : public Component
     {
     public:
         std::string GetTypeName() const override { return "Transform"; }
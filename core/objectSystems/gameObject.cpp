@@ -1,18 +1,29 @@
 #include "GameObject.h"
 #include "Component.h"
-#include "editor/editor.h"
 #include "core/scene.h"
 #include "ComponentFactory.h"
+#include <typeinfo>
 
 namespace core {
-    std::shared_ptr<GameObject> GameObject::Create(std::string name)
+    std::shared_ptr<GameObject> GameObject::Create(std::string name, const std::shared_ptr<Scene>& scene)
     {
         auto go = std::shared_ptr<GameObject>(new GameObject(std::move(name)));
-        go->m_scene = editor::Editor::editorCtx.currentScene;
+        go->m_scene = scene;
+        if (scene)
+        {
+            go->m_storage = scene->GetComponentStorage();
+            go->m_entity = go->m_storage->CreateEntity(go.get());
+        }
         go->Init();
         return go;
     }
 
+    GameObject::~GameObject()
+    {
+        if (m_storage)
+            m_storage->DestroyEntity(m_entity);
+    }
+
     void GameObject::SetParent(std::shared_ptr<GameObject> newParent)
     {
         // Always use shared_from_this to get a shared_ptr to self, not shared_ptr<GameObject>(this).
@@ -27,10 +38,10 @@ namespace core {
             auto& sibs = old->m_children;
             sibs.erase(std::remove(sibs.begin(), sibs.end(), self), sibs.end());
         }
-        else
+        else if (auto scene = m_scene.lock())
         {
             // Was a root, remove from scene roots
-            m_scene.lock()->RemoveRootGameObject(self);
+            scene->RemoveRootGameObject(self);
         }
 
         // Set new parent
@@ -40,8 +51,8 @@ namespace core {
         if (newParent) {
             newParent->AddChild(self);
         }
-        else {
-            editor::Editor::editorCtx.currentScene->AddRootGameObject(self);
+        else if (auto scene = m_scene.lock()) {
+            scene->AddRootGameObject(self);
         }
     }
 
@@ -80,6 +91,19 @@ namespace core {
         }
     }
 
+    void GameObject::SyncStoredComponent(const Component& component)
+    {
+        if (!m_storage) return;
+
+        const std::type_info& type = typeid(component);
+        std::vector<Component*> components;
+        for (const auto& comp : m_components) {
+            if (typeid(*comp) == type)
+                components.push_back(comp.get());
+        }
+        m_storage->SetComponents(m_entity, type, components);
+    }
+
     void GameObject::OnEnabledChanged(bool newValue)
     {
         // Call base implementation
@@ -135,6 +159,7 @@ namespace core {
                         comp->Deserialize(compJson);
                         comp->OnAttach(std::static_pointer_cast<GameObject>(shared_from_this()));
                         m_components.push_back(comp);
+                        SyncStoredComponent(*comp);
                     }
                 }
             }
@@ -143,7 +168,7 @@ namespace core {
         // Children (recursive)
         if (in.contains("children") && in["children"].is_array()) {
             for (const auto& childJson : in["children"]) {
-                auto childGO = GameObject::Create();
+                auto childGO = GameObject::Create({}, m_scene.lock());
                 childGO->Deserialize(childJson);
                 childGO->SetParent(std::static_pointer_cast<GameObject>(shared_from_this()));
             }
@@ -0,0 +1,234 @@
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace core
+{
+    namespace
+    {
+        struct Event
+        {
+            const char* name;
+            std::int64_t start;
+            std::int64_t end;
+        };
+
+        /// <summary>
+        /// Events of one thread. Only the owning thread writes events, the count and the generation.
+        /// </summary>
+        struct ThreadBuffer
+        {
+            int id = 0;
+            std::string name;                           // Guarded by the registry mutex
+            std::unique_ptr<Event[]> events;            // Allocated on the first recorded event
+            std::atomic<std::size_t> count{ 0 };
+            std::atomic<std::size_t> dropped{ 0 };
+            std::atomic<std::uint32_t> generation{ 0 }; // Capture the events belong to
+        };
+
+        std::atomic<std::uint32_t> s_generation{ 0 };   // Bumped by every capture start
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers;    // Outlive their threads
+            std::mutex internMutex;
+            std::unordered_set<std::string> names;                  // Node based, the pointers stay valid
+        };
+
+        Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        ThreadBuffer& GetThreadBuffer()
+        {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer)
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard lock(registry.mutex);
+                registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = registry.buffers.back().get();
+                buffer->id = static_cast<int>(registry.buffers.size() - 1);
+                buffer->name = "Thread " + std::to_string(buffer->id);
+            }
+            return *buffer;
+        }
+
+        void WriteEscaped(std::ofstream& file, const char* text)
+        {
+            for (; *text; ++text)
+            {
+                if (*text == '"' || *text == '\\')
+                    file << '\\';
+                file << *text;
+            }
+        }
+    } // namespace
+
+    std::atomic<bool> Profiler::s_capturing{ false };
+    int Profiler::s_requestedFrames = 0;
+    int Profiler::s_remainingFrames = 0;
+    std::int64_t Profiler::s_captureStart = 0;
+    std::string Profiler::s_requestedPath;
+    std::string Profiler::s_lastTracePath;
+
+    std::int64_t Profiler::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char* Profiler::Intern(const std::string& name)
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.internMutex);
+        return registry.names.insert(name).first->c_str();
+    }
+
+    void Profiler::Record(const char* name, std::int64_t start, std::int64_t end)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        if (!buffer.events)
+            buffer.events = std::make_unique<Event[]>(EVENTS_PER_THREAD);
+
+        // First event of a new capture, drop the previous one's
+        const std::uint32_t generation = s_generation.load(std::memory_order_acquire);
+        if (buffer.generation.load(std::memory_order_relaxed) != generation)
+        {
+            buffer.count.store(0, std::memory_order_relaxed);
+            buffer.dropped.store(0, std::memory_order_relaxed);
+            buffer.generation.store(generation, std::memory_order_release);
+        }
+
+        std::size_t index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= EVENTS_PER_THREAD)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[index] = { name, start, end };
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    void Profiler::SetThreadName(const char* name)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard lock(GetRegistry().mutex);
+        buffer.name = name;
+    }
+
+    void Profiler::CaptureFrames(int frameCount, const std::string& path)
+    {
+        if (frameCount <= 0 || s_remainingFrames > 0) return;
+
+        s_requestedFrames = frameCount;
+        s_requestedPath = path;
+    }
+
+    void Profiler::EndFrame()
+    {
+        if (s_remainingFrames > 0)
+        {
+            if (--s_remainingFrames == 0)
+                StopCapture();
+        }
+        else if (s_requestedFrames > 0)
+        {
+            s_remainingFrames = s_requestedFrames;
+            s_requestedFrames = 0;
+            StartCapture();
+        }
+    }
+
+    void Profiler::StartCapture()
+    {
+        // The buffers are cleared by their own threads, which may be recording right now
+        printf("[PROFILER] Capturing %d frames\n", s_remainingFrames);
+        s_captureStart = Now();
+        s_generation.fetch_add(1, std::memory_order_release);
+        s_capturing.store(true, std::memory_order_release);
+    }
+
+    void Profiler::StopCapture()
+    {
+        s_capturing.store(false, std::memory_order_relaxed);
+
+        std::string path = s_requestedPath;
+        if (path.empty())
+        {
+            char timestamp[32];
+            std::time_t now = std::time(nullptr);
+            std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+            path = std::string("cpuTrace_") + timestamp + ".json";
+        }
+
+        if (WriteChromeTrace(path))
+            s_lastTracePath = path;
+    }
+
+    bool Profiler::WriteChromeTrace(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            printf("[PROFILER] Could not write %s\n", path.c_str());
+            return false;
+        }
+
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+
+        std::size_t eventCount = 0;
+        std::size_t droppedCount = 0;
+        bool first = true;
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file.setf(std::ios::fixed);
+        file.precision(3);
+        const std::uint32_t generation = s_generation.load(std::memory_order_relaxed);
+        for (const auto& buffer : registry.buffers)
+        {
+            // Threads that recorded nothing during this capture still hold an older one
+            if (buffer->generation.load(std::memory_order_acquire) != generation) continue;
+
+            std::size_t count = buffer->count.load(std::memory_order_acquire);
+            droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+            if (count == 0) continue;
+
+            if (!first) file << ",\n";
+            first = false;
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+            WriteEscaped(file, buffer->name.c_str());
+            file << "\"}}";
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                // A zone of a long running thread that opened before this capture started
+                const Event& event = buffer->events[i];
+                if (event.start < s_captureStart) continue;
+
+                file << ",\n{\"name\":\"";
+                WriteEscaped(file, event.name);
+                file << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                     << ",\"ts\":" << (event.start - s_captureStart) / 1000.0
+                     << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+                eventCount++;
+            }
+        }
+        file << "\n]}\n";
+
+        printf("[PROFILER] Wrote %zu zones to %s", eventCount, path.c_str());
+        if (droppedCount > 0)
+            printf(" (%zu dropped, buffers full)", droppedCount);
+        printf("\n");
+        return true;
+    }
+} // namespace core
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Zones are compiled in when FINALENGINE_PROFILING is defined (the CMake option of the same name).
+// Without it the macros expand to nothing. With it, a zone outside a capture costs one relaxed load.
+#ifdef FINALENGINE_PROFILING
+#define FINALENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define FINALENGINE_PROFILE_CONCAT(a, b) FINALENGINE_PROFILE_CONCAT_INNER(a, b)
+#define FINALENGINE_PROFILE_ZONE(name) ::core::Profiler::Zone FINALENGINE_PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#define FINALENGINE_PROFILE_FUNCTION() FINALENGINE_PROFILE_ZONE(__FUNCTION__)
+#define FINALENGINE_PROFILE_THREAD(name) ::core::Profiler::SetThreadName(name)
+#else
+#define FINALENGINE_PROFILE_ZONE(name) ((void)0)
+#define FINALENGINE_PROFILE_FUNCTION() ((void)0)
+#define FINALENGINE_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace core
+{
+    /// <summary>
+    /// CPU instrumentation profiler: scoped zones captured over a number of frames and written as
+    /// Chrome trace_event JSON, which chrome://tracing and the Perfetto UI both open.
+    /// <para>
+    /// Every thread records into its own fixed size buffer. The owning thread is the only writer
+    /// and publishes each event with a release store of the count, so recording takes no lock.
+    /// A capture starts and stops in EndFrame(), on the main thread at a frame boundary. Other
+    /// threads (job workers, the scene loader) can be recording at that moment, so the main thread
+    /// never clears a buffer: starting a capture bumps a generation, and each thread empties its own
+    /// buffer when its first event of the new generation arrives. The trace only reads buffers of
+    /// the current generation, up to their published count.
+    /// </para>
+    /// </summary>
+    class Profiler
+    {
+    public:
+        static constexpr std::size_t EVENTS_PER_THREAD = 1 << 16;
+
+        /// <summary>
+        /// Records the time between its construction and destruction while a capture runs.
+        /// The name must outlive the capture, use the std::string overload for built names.
+        /// </summary>
+        class Zone
+        {
+        public:
+            explicit Zone(const char* name) : m_name(name), m_start(IsCapturing() ? Now() : -1) {}
+            explicit Zone(const std::string& name) : m_name(nullptr), m_start(-1)
+            {
+                if (!IsCapturing()) return;
+                m_name = Intern(name);
+                m_start = Now();
+            }
+            ~Zone()
+            {
+                if (m_start >= 0)
+                    Record(m_name, m_start, Now());
+            }
+
+            Zone(const Zone&) = delete;
+            Zone& operator=(const Zone&) = delete;
+
+        private:
+            const char* m_name;
+            std::int64_t m_start;
+        };
+
+        static bool IsCapturing() { return s_capturing.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// Captures the next frames and writes them to a trace file once done.
+        /// The capture begins at the next EndFrame().
+        /// </summary>
+        /// <param name="frameCount">Number of frames to capture.</param>
+        /// <param name="path">Trace file to write, empty for a timestamped cpuTrace_*.json.</param>
+        static void CaptureFrames(int frameCount, const std::string& path = {});
+
+        /// <summary>
+        /// Marks the end of a frame on the main thread, starting or finishing a requested capture.
+        /// </summary>
+        static void EndFrame();
+
+        /// <summary>
+        /// Names the calling thread in the trace.
+        /// </summary>
+        static void SetThreadName(const char* name);
+
+        /// <summary>
+        /// Writes the events of the last capture as Chrome trace_event JSON.
+        /// </summary>
+        /// <returns>True if the file was written.</returns>
+        static bool WriteChromeTrace(const std::string& path);
+
+        /// <summary>
+        /// Gets the frames left in the running capture, 0 when not capturing.
+        /// </summary>
+        static int GetRemainingFrames() { return s_remainingFrames; }
+
+        static const std::string& GetLastTracePath() { return s_lastTracePath; }
+
+    private:
+        static std::int64_t Now();
+        static const char* Intern(const std::string& name);
+        static void Record(const char* name, std::int64_t start, std::int64_t end);
+        static void StartCapture();
+        static void StopCapture();
+
+        static std::atomic<bool> s_capturing;
+        static int s_requestedFrames;
+        static int s_remainingFrames;
+        static std::int64_t s_captureStart;
+        static std::string s_requestedPath;
+        static std::string s_lastTracePath;
+    };
+} // namespace core
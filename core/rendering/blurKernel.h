@@ -0,0 +1,103 @@
+#pragma once
+
+namespace core
+{
+    /// <summary>
+    /// Weights of a one-dimensional Gaussian blur, one side of the symmetric kernel.
+    /// <para>
+    /// Besides the discrete weights (center first), the kernel holds the bilinear merged taps:
+    /// two neighbouring texels i and i + 1 are read with a single filtered fetch placed between
+    /// them at (i * w_i + (i + 1) * w_i+1) / (w_i + w_i+1), weighted by w_i + w_i+1. A radius r
+    /// blur then costs r + 1 fetches per pass (rounded to odd) instead of 2r + 1.
+    /// </para>
+    /// </summary>
+    struct BlurKernel
+    {
+        static constexpr int MAX_RADIUS = 16;
+        static constexpr int MAX_TAPS = MAX_RADIUS + 1;
+
+        int radius = 0;
+        float sigma = 0.0f;
+        float weights[MAX_TAPS] = {};           // Discrete weights, index 0 is the center
+        int mergedCount = 0;                    // Center plus the merged taps on one side
+        float mergedWeights[MAX_TAPS] = {};
+        float mergedOffsets[MAX_TAPS] = {};     // In texels from the center
+
+        /// <summary>
+        /// Gets the texture fetches per pass with the merged taps, both sides and the center.
+        /// </summary>
+        constexpr int GetFetchCount() const { return 2 * mergedCount - 1; }
+    };
+
+    namespace detail
+    {
+        // std::exp is not constexpr yet: halve the argument until the Taylor series converges
+        // quickly, then square the result back up.
+        constexpr double ConstexprExp(double x)
+        {
+            int halvings = 0;
+            while (x < -0.5 || x > 0.5)
+            {
+                x *= 0.5;
+                halvings++;
+            }
+
+            double term = 1.0;
+            double sum = 1.0;
+            for (int n = 1; n < 16; ++n)
+            {
+                term *= x / n;
+                sum += term;
+            }
+
+            while (halvings-- > 0)
+                sum *= sum;
+            return sum;
+        }
+    } // namespace detail
+
+    /// <summary>
+    /// Builds a normalized Gaussian kernel and its bilinear merged taps.
+    /// Usable at compile time and at runtime, when the settings change.
+    /// </summary>
+    /// <param name="radius">Texels on each side of the center, clamped to [0, MAX_RADIUS].</param>
+    /// <param name="sigma">Standard deviation in texels. Zero or less picks radius / 2.</param>
+    constexpr BlurKernel MakeGaussianKernel(int radius, float sigma = 0.0f)
+    {
+        BlurKernel kernel;
+        kernel.radius = radius < 0 ? 0 : (radius > BlurKernel::MAX_RADIUS ? BlurKernel::MAX_RADIUS : radius);
+        kernel.sigma = sigma > 0.0f ? sigma : (kernel.radius > 0 ? kernel.radius * 0.5f : 1.0f);
+
+        double total = 0.0;
+        double weights[BlurKernel::MAX_TAPS] = {};
+        for (int i = 0; i <= kernel.radius; ++i)
+        {
+            weights[i] = detail::ConstexprExp(-(i * i) / (2.0 * kernel.sigma * kernel.sigma));
+            total += i == 0 ? weights[i] : 2.0 * weights[i];
+        }
+        for (int i = 0; i <= kernel.radius; ++i)
+            kernel.weights[i] = static_cast<float>(weights[i] / total);
+
+        // The center keeps its own fetch, the side taps are merged in pairs
+        kernel.mergedWeights[0] = kernel.weights[0];
+        kernel.mergedOffsets[0] = 0.0f;
+        kernel.mergedCount = 1;
+        for (int i = 1; i <= kernel.radius; i += 2)
+        {
+            float first = kernel.weights[i];
+            float second = i + 1 <= kernel.radius ? kernel.weights[i + 1] : 0.0f;
+            float weight = first + second;
+            kernel.mergedWeights[kernel.mergedCount] = weight;
+            kernel.mergedOffsets[kernel.mergedCount] = weight > 0.0f ? (i * first + (i + 1) * second) / weight : static_cast<float>(i);
+            kernel.mergedCount++;
+        }
+
+        return kernel;
+    }
+
+    // A 9 texel wide blur in 5 fetches, the size the old bloom blur used
+    inline constexpr BlurKernel DEFAULT_BLUR_KERNEL = MakeGaussianKernel(4);
+    static_assert(DEFAULT_BLUR_KERNEL.GetFetchCount() == 5, "a radius 4 kernel merges into 5 fetches");
+    static_assert(MakeGaussianKernel(BlurKernel::MAX_RADIUS).GetFetchCount() == BlurKernel::MAX_RADIUS + 1,
+                  "every pair of side taps shares one fetch");
+} // namespace core
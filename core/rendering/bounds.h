@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace core
+{
+    /// <summary>
+    /// Axis-aligned bounding box. A default constructed box is empty (min > max).
+    /// </summary>
+    struct Bounds
+    {
+        glm::vec3 min{ FLT_MAX };
+        glm::vec3 max{ -FLT_MAX };
+
+        bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+        glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+        void Encapsulate(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void Encapsulate(const Bounds& other)
+        {
+            if (!other.IsValid()) return;
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        /// <summary>
+        /// Returns the box enclosing this box after an affine transform (Arvo's method).
+        /// </summary>
+        Bounds Transformed(const glm::mat4& matrix) const
+        {
+            if (!IsValid()) return {};
+
+            glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+            glm::vec3 extents = GetExtents();
+            glm::vec3 worldExtents(0.0f);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                for (int column = 0; column < 3; ++column)
+                    worldExtents[axis] += std::abs(matrix[column][axis]) * extents[column];
+            }
+
+            Bounds result;
+            result.min = center - worldExtents;
+            result.max = center + worldExtents;
+            return result;
+        }
+    };
+} // namespace core
@@ -0,0 +1,320 @@
+#include "../jobSystem.h"
+#include "../objectSystems/components/Light.h"
+#include "clusteredLighting.h"
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLUSTER_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace core
+{
+    // Storage buffer binding points, must match lighting.glsl
+    static constexpr GLuint LIGHT_BUFFER_BINDING = 1;
+    static constexpr GLuint CLUSTER_BUFFER_BINDING = 2;
+    static constexpr GLuint INDEX_BUFFER_BINDING = 3;
+
+    ClusteredLighting::ClusteredLighting()
+    {
+        glGenBuffers(1, &m_lightBuffer);
+        glGenBuffers(1, &m_clusterBuffer);
+        glGenBuffers(1, &m_indexBuffer);
+
+        m_clusters.resize(CLUSTER_COUNT);
+        m_sliceIndices.resize(GRID_Z);
+    }
+
+    ClusteredLighting::~ClusteredLighting()
+    {
+        glDeleteBuffers(1, &m_lightBuffer);
+        glDeleteBuffers(1, &m_clusterBuffer);
+        glDeleteBuffers(1, &m_indexBuffer);
+    }
+
+    void ClusteredLighting::Clear()
+    {
+        m_directionalLights.clear();
+        m_localLights.clear();
+    }
+
+    void ClusteredLighting::AddDirectional(const glm::vec3& direction, const glm::vec4& colorIntensity, const glm::ivec4& shadow)
+    {
+        m_directionalLights.push_back({ glm::vec4(0.0f), glm::vec4(direction, 1.0f), colorIntensity, shadow });
+    }
+
+    void ClusteredLighting::AddLocal(const glm::vec3& position, const glm::vec3& direction, const glm::vec4& colorIntensity, float range, float cosCutoff, const glm::ivec4& shadow)
+    {
+        m_localLights.push_back({ glm::vec4(position, range), glm::vec4(direction, cosCutoff), colorIntensity, shadow });
+    }
+
+    void ClusteredLighting::UpdateClusterBounds(const glm::mat4& projection)
+    {
+        if (projection == m_boundsProjection && !m_clusterBounds.empty())
+            return;
+
+        m_boundsProjection = projection;
+
+        // Recover the clip planes and field of view from the perspective matrix
+        m_near = projection[3][2] / (projection[2][2] - 1.0f);
+        m_far = projection[3][2] / (projection[2][2] + 1.0f);
+        float tanHalfX = 1.0f / projection[0][0];
+        float tanHalfY = 1.0f / projection[1][1];
+
+        m_clusterBounds.resize(CLUSTER_COUNT);
+        for (int z = 0; z < GRID_Z; ++z)
+        {
+            // Exponential slices keep clusters roughly cubical along the view direction
+            float sliceNear = m_near * std::pow(m_far / m_near, static_cast<float>(z) / GRID_Z);
+            float sliceFar = m_near * std::pow(m_far / m_near, static_cast<float>(z + 1) / GRID_Z);
+
+            for (int y = 0; y < GRID_Y; ++y)
+            {
+                float ndcY0 = -1.0f + 2.0f * y / GRID_Y;
+                float ndcY1 = -1.0f + 2.0f * (y + 1) / GRID_Y;
+
+                for (int x = 0; x < GRID_X; ++x)
+                {
+                    float ndcX0 = -1.0f + 2.0f * x / GRID_X;
+                    float ndcX1 = -1.0f + 2.0f * (x + 1) / GRID_X;
+
+                    glm::vec3 minBounds(FLT_MAX), maxBounds(-FLT_MAX);
+                    for (float depth : { sliceNear, sliceFar })
+                    {
+                        for (float ndcX : { ndcX0, ndcX1 })
+                        {
+                            for (float ndcY : { ndcY0, ndcY1 })
+                            {
+                                glm::vec3 corner(ndcX * tanHalfX * depth, ndcY * tanHalfY * depth, -depth);
+                                minBounds = glm::min(minBounds, corner);
+                                maxBounds = glm::max(maxBounds, corner);
+                            }
+                        }
+                    }
+
+                    ClusterBounds& bounds = m_clusterBounds[x + GRID_X * (y + GRID_Y * z)];
+                    bounds.min = minBounds;
+                    bounds.max = maxBounds;
+                    bounds.center = (minBounds + maxBounds) * 0.5f;
+                    bounds.radius = glm::length(maxBounds - bounds.center);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Cone versus sphere test for spot lights (Bart Wronski, "Cull that cone").
+    /// </summary>
+    static bool ConeIntersectsSphere(const glm::vec3& apex, const glm::vec3& direction, float range, float cosAngle,
+                                     const glm::vec3& center, float radius)
+    {
+        float sinAngle = std::sqrt(std::max(0.0f, 1.0f - cosAngle * cosAngle));
+        glm::vec3 toCenter = center - apex;
+        float lengthSq = glm::dot(toCenter, toCenter);
+        float alongAxis = glm::dot(toCenter, direction);
+        float distanceToCone = cosAngle * std::sqrt(std::max(0.0f, lengthSq - alongAxis * alongAxis)) - alongAxis * sinAngle;
+
+        bool angleCull = distanceToCone > radius;
+        bool frontCull = alongAxis > radius + range;
+        bool backCull = alongAxis < -radius;
+        return !(angleCull || frontCull || backCull);
+    }
+
+    void ClusteredLighting::AssignSlice(int slice, std::vector<std::uint32_t>& indices)
+    {
+        indices.clear();
+
+        // Depth-cull the lights against the whole slice first, the per-cluster tests then
+        // only see the few lights that overlap this slice.
+        const ClusterBounds& first = m_clusterBounds[GRID_X * GRID_Y * slice];
+        float sliceMinZ = first.min.z;
+        float sliceMaxZ = first.max.z;
+
+        thread_local std::vector<std::uint32_t> candidates;
+        thread_local std::vector<float> cx, cy, cz, cr;
+        candidates.clear();
+        cx.clear(); cy.clear(); cz.clear(); cr.clear();
+
+        for (std::uint32_t i = 0; i < m_lightX.size(); ++i)
+        {
+            if (m_lightZ[i] - m_lightRadius[i] > sliceMaxZ || m_lightZ[i] + m_lightRadius[i] < sliceMinZ)
+                continue;
+            candidates.push_back(i);
+            cx.push_back(m_lightX[i]);
+            cy.push_back(m_lightY[i]);
+            cz.push_back(m_lightZ[i]);
+            cr.push_back(m_lightRadius[i] * m_lightRadius[i]);
+        }
+
+        // Pad to a multiple of 4 with spheres that can never intersect
+        while (cx.size() % 4 != 0)
+        {
+            cx.push_back(0.0f); cy.push_back(0.0f); cz.push_back(FLT_MAX); cr.push_back(-1.0f);
+        }
+
+        std::uint32_t directionalCount = static_cast<std::uint32_t>(m_directionalLights.size());
+        for (int tile = 0; tile < GRID_X * GRID_Y; ++tile)
+        {
+            int clusterIndex = tile + GRID_X * GRID_Y * slice;
+            const ClusterBounds& bounds = m_clusterBounds[clusterIndex];
+            std::uint32_t offset = static_cast<std::uint32_t>(indices.size());
+
+            for (size_t base = 0; base < cx.size(); base += 4)
+            {
+                // Sphere versus AABB: squared distance from the sphere center to the box
+                int mask = 0;
+#ifdef CLUSTER_USE_SSE
+                const __m128 zero = _mm_setzero_ps();
+                __m128 x = _mm_loadu_ps(&cx[base]);
+                __m128 y = _mm_loadu_ps(&cy[base]);
+                __m128 z = _mm_loadu_ps(&cz[base]);
+                __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.x), x), _mm_sub_ps(x, _mm_set1_ps(bounds.max.x))), zero);
+                __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.y), y), _mm_sub_ps(y, _mm_set1_ps(bounds.max.y))), zero);
+                __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.z), z), _mm_sub_ps(z, _mm_set1_ps(bounds.max.z))), zero);
+                __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                mask = _mm_movemask_ps(_mm_cmple_ps(distanceSq, _mm_loadu_ps(&cr[base])));
+#else
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    size_t i = base + lane;
+                    float dx = std::max({ bounds.min.x - cx[i], cx[i] - bounds.max.x, 0.0f });
+                    float dy = std::max({ bounds.min.y - cy[i], cy[i] - bounds.max.y, 0.0f });
+                    float dz = std::max({ bounds.min.z - cz[i], cz[i] - bounds.max.z, 0.0f });
+                    if (dx * dx + dy * dy + dz * dz <= cr[i])
+                        mask |= 1 << lane;
+                }
+#endif
+                while (mask != 0)
+                {
+                    int lane = 0;
+                    while (!(mask & (1 << lane))) ++lane;
+                    mask &= ~(1 << lane);
+
+                    std::uint32_t light = candidates[base + lane];
+                    const GpuLight& gpuLight = m_localLights[light];
+
+                    // Spot lights additionally have to pass the cone test
+                    float cosCutoff = gpuLight.directionCutoff.w;
+                    if (cosCutoff > -1.0f &&
+                        !ConeIntersectsSphere(glm::vec3(m_lightX[light], m_lightY[light], m_lightZ[light]), m_lightViewDirection[light],
+                                              gpuLight.positionRange.w, cosCutoff, bounds.center, bounds.radius))
+                        continue;
+
+                    indices.push_back(directionalCount + light);
+                }
+            }
+
+            m_clusters[clusterIndex] = glm::uvec2(offset, static_cast<std::uint32_t>(indices.size()) - offset);
+        }
+    }
+
+    void ClusteredLighting::Build(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight, LightData& lightData)
+    {
+        // Directional lights first, the cluster indices already account for them
+        m_pendingLights.clear();
+        m_pendingLights.insert(m_pendingLights.end(), m_directionalLights.begin(), m_directionalLights.end());
+        m_pendingLights.insert(m_pendingLights.end(), m_localLights.begin(), m_localLights.end());
+
+        bool lightsChanged = !m_hasBuilt || m_pendingLights != m_gpuLights;
+        bool cameraChanged = !m_hasBuilt || view != m_builtView || projection != m_builtProjection ||
+                             m_builtViewport != glm::ivec2(viewportWidth, viewportHeight);
+
+        if (lightsChanged)
+        {
+            m_gpuLights.swap(m_pendingLights);
+            Upload(m_lightBuffer, m_gpuLights.data(), m_gpuLights.size() * sizeof(GpuLight), m_lightCapacity);
+        }
+
+        m_lastBuildSkipped = !lightsChanged && !cameraChanged;
+        if (!m_lastBuildSkipped)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            UpdateClusterBounds(projection);
+
+            // Transform the local lights to view space once
+            size_t localCount = m_localLights.size();
+            m_lightX.resize(localCount);
+            m_lightY.resize(localCount);
+            m_lightZ.resize(localCount);
+            m_lightRadius.resize(localCount);
+            m_lightViewDirection.resize(localCount);
+            for (size_t i = 0; i < localCount; ++i)
+            {
+                const GpuLight& light = m_localLights[i];
+                glm::vec3 viewPosition = glm::vec3(view * glm::vec4(glm::vec3(light.positionRange), 1.0f));
+                m_lightX[i] = viewPosition.x;
+                m_lightY[i] = viewPosition.y;
+                m_lightZ[i] = viewPosition.z;
+                m_lightRadius[i] = light.positionRange.w;
+                m_lightViewDirection[i] = glm::normalize(glm::vec3(view * glm::vec4(glm::vec3(light.directionCutoff), 0.0f)));
+            }
+
+            // Slices are independent, so each one is a job for the worker threads
+            JobSystem::ParallelFor(GRID_Z, [this](int begin, int end) {
+                for (int slice = begin; slice < end; ++slice)
+                    AssignSlice(slice, m_sliceIndices[slice]);
+            });
+
+            // Concatenate the slice lists and turn slice-relative offsets into global ones
+            m_indices.clear();
+            for (int slice = 0; slice < GRID_Z; ++slice)
+            {
+                std::uint32_t base = static_cast<std::uint32_t>(m_indices.size());
+                for (int tile = 0; tile < GRID_X * GRID_Y; ++tile)
+                    m_clusters[tile + GRID_X * GRID_Y * slice].x += base;
+                m_indices.insert(m_indices.end(), m_sliceIndices[slice].begin(), m_sliceIndices[slice].end());
+            }
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            m_lastBuildMs = elapsed.count();
+
+            Upload(m_clusterBuffer, m_clusters.data(), m_clusters.size() * sizeof(glm::uvec2), m_clusterCapacity);
+            Upload(m_indexBuffer, m_indices.data(), m_indices.size() * sizeof(std::uint32_t), m_indexCapacity);
+
+            m_builtView = view;
+            m_builtProjection = projection;
+            m_builtViewport = glm::ivec2(viewportWidth, viewportHeight);
+            m_hasBuilt = true;
+        }
+        else
+        {
+            m_lastBuildMs = 0.0;
+        }
+
+        float logRatio = std::log(m_far / m_near);
+        lightData.viewMatrix = view;
+        lightData.clusterGrid = glm::uvec4(GRID_X, GRID_Y, GRID_Z, 0);
+        lightData.clusterParams = glm::vec4(
+            static_cast<float>(viewportWidth) / GRID_X,
+            static_cast<float>(viewportHeight) / GRID_Y,
+            GRID_Z / logRatio,
+            -GRID_Z * std::log(m_near) / logRatio);
+        lightData.lightCounts.x = static_cast<int>(m_directionalLights.size());
+        lightData.lightCounts.y = static_cast<int>(m_localLights.size());
+    }
+
+    void ClusteredLighting::Bind() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BUFFER_BINDING, m_lightBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BUFFER_BINDING, m_clusterBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_BUFFER_BINDING, m_indexBuffer);
+    }
+
+    void ClusteredLighting::Upload(GLuint buffer, const void* data, size_t size, size_t& capacity)
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+        if (size > capacity || capacity == 0)
+        {
+            // Grow geometrically; never allocate an empty store so the binding stays valid
+            capacity = std::max<size_t>({ size, capacity * 2, 256 });
+            glBufferData(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (size > 0)
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+} // namespace core
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace core
+{
+    struct LightData;
+
+    /// <summary>
+    /// Clustered forward lighting.
+    /// <para>
+    /// The view frustum is split into a 3D grid of clusters (screen tiles times exponential
+    /// depth slices). Every frame each point/spot light is tested against the cluster bounds
+    /// on the worker threads, producing a compact light index list per cluster, so a fragment
+    /// only evaluates the lights that can actually reach it. Directional lights affect every
+    /// fragment and are stored at the start of the light buffer without being clustered.
+    /// </para>
+    /// </summary>
+    /// <remarks>
+    /// GPU bindings (std430 shader storage buffers, see lighting.glsl):
+    /// - 1: LightBuffer, every light as four vec4s
+    /// - 2: ClusterBuffer, uvec2 (offset, count) per cluster
+    /// - 3: ClusterIndexBuffer, light indices referenced by the clusters
+    /// </remarks>
+    class ClusteredLighting
+    {
+    public:
+        static constexpr int GRID_X = 16;
+        static constexpr int GRID_Y = 9;
+        static constexpr int GRID_Z = 24;
+        static constexpr int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+        /// <summary>
+        /// Light layout in the LightBuffer SSBO.
+        /// </summary>
+        struct GpuLight
+        {
+            glm::vec4 positionRange;    // xyz = world position, w = range (0 for directional lights)
+            glm::vec4 directionCutoff;  // xyz = world direction, w = cosine of the spot cutoff (-2 for point lights)
+            glm::vec4 color;            // rgb = color, w = intensity
+            glm::ivec4 shadow;          // x = first ShadowBuffer index or shadow cube (-1 without a shadow), y = cascade count, z = 1 to blend cascades, w = 1 for a shadow cube
+
+            bool operator==(const GpuLight&) const = default;
+        };
+
+        ClusteredLighting();
+        ~ClusteredLighting();
+
+        ClusteredLighting(const ClusteredLighting&) = delete;
+        ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+        /// <summary>
+        /// Removes all lights added for the previous frame.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Adds a directional light. Directional lights are not clustered.
+        /// </summary>
+        void AddDirectional(const glm::vec3& direction, const glm::vec4& colorIntensity, const glm::ivec4& shadow = glm::ivec4(-1, 0, 0, 0));
+
+        /// <summary>
+        /// Adds a point or spot light.
+        /// </summary>
+        /// <param name="position">World position.</param>
+        /// <param name="direction">World direction (only used by spot lights).</param>
+        /// <param name="colorIntensity">rgb = color, w = intensity.</param>
+        /// <param name="range">Distance at which the light no longer contributes.</param>
+        /// <param name="cosCutoff">Cosine of the spot half angle, or -2 for point lights.</param>
+        /// <param name="shadow">Shadow atlas tile or shadow cube of the light, see GpuLight::shadow.</param>
+        void AddLocal(const glm::vec3& position, const glm::vec3& direction, const glm::vec4& colorIntensity, float range, float cosCutoff,
+                      const glm::ivec4& shadow = glm::ivec4(-1, 0, 0, 0));
+
+        /// <summary>
+        /// Assigns the local lights to clusters, uploads the buffers and fills the
+        /// per-frame cluster constants in the light UBO data.
+        /// <para>
+        /// The light buffer is only uploaded when a light changed, and the cluster assignment is
+        /// skipped entirely while the lights, camera and viewport stay the same as last frame.
+        /// </para>
+        /// </summary>
+        /// <param name="view">Camera view matrix.</param>
+        /// <param name="projection">Camera perspective projection matrix.</param>
+        /// <param name="viewportWidth">Width of the render target in pixels.</param>
+        /// <param name="viewportHeight">Height of the render target in pixels.</param>
+        /// <param name="lightData">Receives the view matrix, grid and light counts.</param>
+        void Build(const glm::mat4& view, const glm::mat4& projection, int viewportWidth, int viewportHeight, LightData& lightData);
+
+        /// <summary>
+        /// Binds the three storage buffers to their binding points.
+        /// </summary>
+        void Bind() const;
+
+        int GetDirectionalCount() const { return static_cast<int>(m_directionalLights.size()); }
+        int GetLocalCount() const { return static_cast<int>(m_localLights.size()); }
+
+        /// <summary>
+        /// Gets the number of light indices written by the last Build() (sum over all clusters).
+        /// </summary>
+        size_t GetIndexCount() const { return m_indices.size(); }
+
+        /// <summary>
+        /// Gets the CPU time in milliseconds the last Build() spent assigning lights to clusters.
+        /// </summary>
+        double GetLastBuildMs() const { return m_lastBuildMs; }
+
+        /// <summary>
+        /// Whether the last Build() reused the previous cluster assignment.
+        /// </summary>
+        bool WasLastBuildSkipped() const { return m_lastBuildSkipped; }
+
+    private:
+        /// <summary>
+        /// View-space bounds of one cluster.
+        /// </summary>
+        struct ClusterBounds
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+            glm::vec3 center;       // Bounding sphere, used by the spot light cone test
+            float radius;
+        };
+
+        void UpdateClusterBounds(const glm::mat4& projection);
+        void AssignSlice(int slice, std::vector<std::uint32_t>& indices);
+        static void Upload(GLuint buffer, const void* data, size_t size, size_t& capacity);
+
+        std::vector<GpuLight> m_directionalLights;
+        std::vector<GpuLight> m_localLights;
+
+        // View-space light spheres in structure-of-arrays form for the SIMD tests
+        std::vector<float> m_lightX, m_lightY, m_lightZ, m_lightRadius;
+        std::vector<glm::vec3> m_lightViewDirection;
+
+        std::vector<ClusterBounds> m_clusterBounds;
+        glm::mat4 m_boundsProjection{ 0.0f };
+        float m_near = 0.1f;
+        float m_far = 100.0f;
+
+        std::vector<std::vector<std::uint32_t>> m_sliceIndices;
+        std::vector<glm::uvec2> m_clusters;
+        std::vector<std::uint32_t> m_indices;
+        std::vector<GpuLight> m_gpuLights;         // Contents of the light buffer
+        std::vector<GpuLight> m_pendingLights;     // This frame's lights, compared against m_gpuLights
+
+        // Inputs of the last assignment, to detect when it can be reused
+        glm::mat4 m_builtView{ 0.0f };
+        glm::mat4 m_builtProjection{ 0.0f };
+        glm::ivec2 m_builtViewport{ 0 };
+        bool m_hasBuilt = false;
+        bool m_lastBuildSkipped = false;
+
+        GLuint m_lightBuffer = 0;
+        GLuint m_clusterBuffer = 0;
+        GLuint m_indexBuffer = 0;
+        size_t m_lightCapacity = 0;
+        size_t m_clusterCapacity = 0;
+        size_t m_indexCapacity = 0;
+
+        double m_lastBuildMs = 0.0;
+    };
+} // namespace core
@@ -0,0 +1,105 @@
+#include "cubeShadowArray.h"
+#include "shadowAtlas.h"
+#include <cstdio>
+
+namespace core
+{
+    static constexpr int CUBE_FACES = 6;
+
+    CubeShadowArray::CubeShadowArray(int size) : m_size(size)
+    {
+        m_depthTexture = CreateDepthTexture(m_size);
+        m_framebuffer = CreateLayeredFramebuffer(m_depthTexture);
+        m_staticDepthTexture = CreateDepthTexture(m_size);
+        m_staticFramebuffer = CreateLayeredFramebuffer(m_staticDepthTexture);
+
+        glGenFramebuffers(1, &m_clearFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_clearFramebuffer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    CubeShadowArray::~CubeShadowArray()
+    {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteFramebuffers(1, &m_staticFramebuffer);
+        glDeleteFramebuffers(1, &m_clearFramebuffer);
+        glDeleteTextures(1, &m_depthTexture);
+        glDeleteTextures(1, &m_staticDepthTexture);
+    }
+
+    GLuint CubeShadowArray::CreateDepthTexture(int size)
+    {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, texture);
+        // Float depth keeps the linear distance written by the fragment shader exact
+        glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32F, size, size, MAX_CUBES * CUBE_FACES, 0,
+                     GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        ShadowAtlas::SetComparison(GL_TEXTURE_CUBE_MAP_ARRAY, texture, true);
+        return texture;
+    }
+
+    void CubeShadowArray::SetComparisonSampling(bool enabled)
+    {
+        ShadowAtlas::SetComparison(GL_TEXTURE_CUBE_MAP_ARRAY, m_depthTexture, enabled);
+    }
+
+    GLuint CubeShadowArray::CreateLayeredFramebuffer(GLuint depthTexture)
+    {
+        GLuint framebuffer = 0;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        // Attaching the whole array makes the framebuffer layered, gl_Layer picks the face
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            printf("[ERROR] Cube shadow framebuffer not complete! Status: 0x%x\n", status);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return framebuffer;
+    }
+
+    void CubeShadowArray::BeginStaticPass(unsigned cubeMask)
+    {
+        // Clearing the layered framebuffer would clear every cube, only clear the faces of the dirty ones
+        glBindFramebuffer(GL_FRAMEBUFFER, m_clearFramebuffer);
+        glViewport(0, 0, m_size, m_size);
+        for (int cube = 0; cube < MAX_CUBES; ++cube)
+        {
+            if ((cubeMask & (1u << cube)) == 0) continue;
+
+            for (int face = 0; face < CUBE_FACES; ++face)
+            {
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_staticDepthTexture, 0, cube * CUBE_FACES + face);
+                glClear(GL_DEPTH_BUFFER_BIT);
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_staticFramebuffer);
+    }
+
+    void CubeShadowArray::BeginPass(unsigned cubeMask)
+    {
+        for (int cube = 0; cube < MAX_CUBES; ++cube)
+        {
+            if ((cubeMask & (1u << cube)) == 0) continue;
+
+            glCopyImageSubData(m_staticDepthTexture, GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, cube * CUBE_FACES,
+                               m_depthTexture, GL_TEXTURE_CUBE_MAP_ARRAY, 0, 0, 0, cube * CUBE_FACES,
+                               m_size, m_size, CUBE_FACES);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(0, 0, m_size, m_size);
+    }
+} // namespace core
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace core
+{
+    /// <summary>
+    /// A cube map array holding the omnidirectional shadow maps of point lights, one cube per light.
+    /// <para>
+    /// Every cube stores the distance to the light divided by its range, so the shader only needs
+    /// the light position and range to look it up. The whole array is attached as a layered
+    /// framebuffer: a geometry shader routes each primitive to the faces (gl_Layer) it can land
+    /// on, so all six faces of every dirty cube are rendered in a single pass.
+    /// </para>
+    /// <para>
+    /// A second array holds the static caster layer, like the static shadow atlas, see Scene.
+    /// </para>
+    /// </summary>
+    class CubeShadowArray
+    {
+    public:
+        static constexpr int CUBE_SIZE = 512;
+        static constexpr int MAX_CUBES = 8;
+
+        explicit CubeShadowArray(int size = CUBE_SIZE);
+        ~CubeShadowArray();
+
+        CubeShadowArray(const CubeShadowArray&) = delete;
+        CubeShadowArray& operator=(const CubeShadowArray&) = delete;
+
+        /// <summary>
+        /// Clears the static layer of the cubes in the mask and binds the static array for rendering.
+        /// </summary>
+        /// <param name="cubeMask">Bit i set for cube i.</param>
+        void BeginStaticPass(unsigned cubeMask);
+
+        /// <summary>
+        /// Copies the static layer of the cubes in the mask into the final array, then binds the
+        /// final array for rendering the dynamic casters on top.
+        /// </summary>
+        /// <param name="cubeMask">Bit i set for cube i.</param>
+        void BeginPass(unsigned cubeMask);
+
+        /// <summary>
+        /// Switches between hardware depth comparison (samplerCubeArrayShadow, the default)
+        /// and raw depth reads for the legacy PCF path (samplerCubeArray).
+        /// </summary>
+        void SetComparisonSampling(bool enabled);
+
+        GLuint GetTexture() const { return m_depthTexture; }
+        int GetSize() const { return m_size; }
+
+    private:
+        static GLuint CreateDepthTexture(int size);
+        static GLuint CreateLayeredFramebuffer(GLuint depthTexture);
+
+        int m_size;
+
+        GLuint m_depthTexture = 0;
+        GLuint m_framebuffer = 0;
+        GLuint m_staticDepthTexture = 0;
+        GLuint m_staticFramebuffer = 0;
+        GLuint m_clearFramebuffer = 0;  // Single layer attachments, clears one face at a time
+    };
+} // namespace core
@@ -0,0 +1,108 @@
+#include "dynamicResolution.h"
+#include "postProcessing/postProcessingEffectBase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace core
+{
+    DynamicResolution::DynamicResolution()
+    {
+        glGenQueries(QUERY_LATENCY, m_queries);
+        m_upscaleShader = std::make_unique<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/upscale.frag");
+    }
+
+    DynamicResolution::~DynamicResolution()
+    {
+        glDeleteQueries(QUERY_LATENCY, m_queries);
+    }
+
+    void DynamicResolution::BeginFrame()
+    {
+        // Skip timing this frame if the query of this slot was never read back
+        int slot = m_frameIndex % QUERY_LATENCY;
+        m_timing = !m_queryPending[slot];
+        if (m_timing)
+            glBeginQuery(GL_TIME_ELAPSED, m_queries[slot]);
+    }
+
+    void DynamicResolution::EndFrame()
+    {
+        if (m_timing)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            m_queryPending[m_frameIndex % QUERY_LATENCY] = true;
+            m_timing = false;
+        }
+        m_frameIndex++;
+
+        // The slot used next was issued QUERY_LATENCY frames ago, it is usually done by now
+        int oldest = m_frameIndex % QUERY_LATENCY;
+        if (!m_queryPending[oldest])
+            return;
+
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_queries[oldest], GL_QUERY_RESULT, &elapsed);
+        m_queryPending[oldest] = false;
+        Update(static_cast<float>(elapsed / 1.0e6));
+    }
+
+    void DynamicResolution::Update(const float gpuFrameTimeMs)
+    {
+        m_gpuFrameTimeMs = gpuFrameTimeMs;
+
+        if (!m_settings.enabled)
+        {
+            m_scale = m_settings.maxScale;
+        }
+        else if (gpuFrameTimeMs > 0.0f)
+        {
+            float ratio = gpuFrameTimeMs / m_settings.targetFrameTimeMs;
+            if (std::abs(ratio - 1.0f) > m_settings.deadBand)
+            {
+                // The frame cost follows the pixel count, the area goes with the square of the scale
+                float idealScale = m_scale * std::sqrt(1.0f / ratio);
+                m_scale += (idealScale - m_scale) * m_settings.damping;
+            }
+        }
+        m_scale = std::clamp(m_scale, m_settings.minScale, std::max(m_settings.minScale, m_settings.maxScale));
+
+        m_scaleHistory[m_historyOffset] = GetScale();
+        m_frameTimeHistory[m_historyOffset] = gpuFrameTimeMs;
+        m_historyOffset = (m_historyOffset + 1) % HISTORY_SIZE;
+    }
+
+    int DynamicResolution::GetScaledSize(const int size) const
+    {
+        return std::max(1, static_cast<int>(std::lround(size * GetScale())));
+    }
+
+    void DynamicResolution::AddUpscalePass(FrameGraph& graph, FrameGraph::Handle source, FrameGraph::Handle output, const int width, const int height)
+    {
+        graph.AddPass("Upscale",
+            [source, output](FrameGraph::Builder& builder)
+            {
+                builder.Read(source);
+                builder.Write(output);
+            },
+            [this, source, output, width, height](const FrameGraph::Resources& resources)
+            {
+                const FrameBuffer& sourceFBO = resources.Get(source);
+                resources.Get(output).Bind();
+                glViewport(0, 0, width, height);
+
+                m_upscaleShader->use();
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, sourceFBO.GetColorAttachment());
+                m_upscaleShader->setInt("sourceTexture", 0);
+                m_upscaleShader->setVec2("sourceUVScale", sourceFBO.GetUVScaleX(), sourceFBO.GetUVScaleY());
+                m_upscaleShader->setFloat("sharpness", m_settings.sharpness);
+
+                postProcessing::PostProcessingEffectBase::RenderQuad(width, height);
+            });
+    }
+} // namespace core
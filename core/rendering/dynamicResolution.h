@@ -0,0 +1,110 @@
+#pragma once
+
+#include "frameBuffer.h"
+#include "frameGraph.h"
+#include "shader.h"
+#include <array>
+#include <glad/glad.h>
+#include <memory>
+
+namespace core
+{
+    /// <summary>
+    /// Scales the resolution the scene and post-processing render at to hold a GPU frame time target.
+    /// <para>
+    /// The GPU time of every frame is measured with a ring of GL_TIME_ELAPSED queries, read back
+    /// QUERY_LATENCY frames later so the CPU never waits on the GPU. The render scale follows the
+    /// target with damping: the cost of a frame grows with its pixel count, so the scale that would
+    /// hit the target is the current one times sqrt(target / measured), and only a fraction of the
+    /// step is taken per frame. Inside a small dead band around the target the scale holds still.
+    /// </para>
+    /// <para>
+    /// The scaled frame is rendered into the bottom-left corner of the bucketed framebuffers, so
+    /// changing the scale rarely reallocates anything. AddUpscalePass() stretches it back to the
+    /// viewport with a sharpening filter.
+    /// </para>
+    /// </summary>
+    class DynamicResolution
+    {
+    public:
+        static constexpr int QUERY_LATENCY = 4;     // Frames between issuing a query and reading it back
+        static constexpr int HISTORY_SIZE = 240;
+
+        struct Settings
+        {
+            bool enabled = false;
+            float targetFrameTimeMs = 16.6f;
+            float minScale = 0.5f;
+            float maxScale = 1.0f;
+            float damping = 0.1f;       // Fraction of the step towards the ideal scale taken per frame
+            float deadBand = 0.05f;     // Relative distance to the target that leaves the scale alone
+            float sharpness = 0.5f;     // Strength of the sharpening while upscaling
+        };
+
+        DynamicResolution();
+        ~DynamicResolution();
+
+        DynamicResolution(const DynamicResolution&) = delete;
+        DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+        /// <summary>
+        /// Starts timing the GPU work of a frame.
+        /// </summary>
+        void BeginFrame();
+
+        /// <summary>
+        /// Stops timing the frame, then reads back the oldest finished query and updates the scale.
+        /// </summary>
+        void EndFrame();
+
+        /// <summary>
+        /// Moves the scale towards the target for a measured GPU frame time. Called by EndFrame().
+        /// </summary>
+        void Update(float gpuFrameTimeMs);
+
+        /// <summary>
+        /// Gets the size to render at for a viewport size, at least one pixel.
+        /// </summary>
+        int GetScaledSize(int size) const;
+
+        /// <summary>
+        /// Adds a pass upscaling the used part of the source into the output, with sharpening.
+        /// </summary>
+        void AddUpscalePass(FrameGraph& graph, FrameGraph::Handle source, FrameGraph::Handle output, int width, int height);
+
+        Settings& GetSettings() { return m_settings; }
+
+        /// <summary>
+        /// Gets the current render scale, 1 when disabled.
+        /// </summary>
+        float GetScale() const { return m_settings.enabled ? m_scale : 1.0f; }
+
+        /// <summary>
+        /// Gets the last GPU frame time read back, in milliseconds.
+        /// </summary>
+        float GetGpuFrameTime() const { return m_gpuFrameTimeMs; }
+
+        /// <summary>
+        /// Ring buffers of the recent scales and GPU frame times, oldest at GetHistoryOffset().
+        /// </summary>
+        const std::array<float, HISTORY_SIZE>& GetScaleHistory() const { return m_scaleHistory; }
+        const std::array<float, HISTORY_SIZE>& GetFrameTimeHistory() const { return m_frameTimeHistory; }
+        int GetHistoryOffset() const { return m_historyOffset; }
+
+    private:
+        Settings m_settings;
+        float m_scale = 1.0f;
+        float m_gpuFrameTimeMs = 0.0f;
+
+        GLuint m_queries[QUERY_LATENCY] = {};
+        bool m_queryPending[QUERY_LATENCY] = {};
+        int m_frameIndex = 0;
+        bool m_timing = false;
+
+        std::array<float, HISTORY_SIZE> m_scaleHistory = {};
+        std::array<float, HISTORY_SIZE> m_frameTimeHistory = {};
+        int m_historyOffset = 0;
+
+        std::unique_ptr<Shader> m_upscaleShader;
+    };
+} // namespace core
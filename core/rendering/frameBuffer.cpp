@@ -9,7 +9,7 @@ namespace core
     FrameBuffer::FrameBuffer(const std::string& name, const FrameBufferSpecifications& specs)
         : m_specs(specs), m_name(name)
     {
-        Create(m_specs.width, m_specs.height);
+        Create(RoundUpToBucket(m_specs.width), RoundUpToBucket(m_specs.height));
     }
 
     FrameBuffer::~FrameBuffer() { Destroy(); m_specs.width = m_specs.height = 0; }
@@ -20,12 +20,30 @@ namespace core
         if ((width <= 0 || height <= 0) || (m_specs.width == width && m_specs.height == height))
             return;
 
-        printf("[FRAMEBUFFER] Resizing %-20s to w: %4i, h: %4i.\n", m_name.c_str(), width, height);
-
         m_specs.width = width;
         m_specs.height = height;
+
+        if (FitsAllocation(width, height))
+            return;
+
+        unsigned int allocatedWidth = RoundUpToBucket(width);
+        unsigned int allocatedHeight = RoundUpToBucket(height);
+
+        printf("[FRAMEBUFFER] Reallocating %-20s to w: %4u, h: %4u (using w: %4i, h: %4i).\n",
+               m_name.c_str(), allocatedWidth, allocatedHeight, width, height);
+
         Destroy();
-        Create(width, height);
+        Create(allocatedWidth, allocatedHeight);
+    }
+
+    bool FrameBuffer::FitsAllocation(unsigned int width, unsigned int height) const
+    {
+        // Keep the allocation while the new size fits and does not waste more than half of it
+        unsigned int allocatedWidth = RoundUpToBucket(width);
+        unsigned int allocatedHeight = RoundUpToBucket(height);
+        bool fits = allocatedWidth <= m_allocatedWidth && allocatedHeight <= m_allocatedHeight;
+        bool wasteful = 2 * allocatedWidth * allocatedHeight < m_allocatedWidth * m_allocatedHeight;
+        return m_isValid && fits && !wasteful;
     }
 
     void FrameBuffer::Create(const int w, const int h)
@@ -49,6 +67,8 @@ namespace core
         }
         
         glBindFramebuffer(GL_FRAMEBUFFER, m_fboID);
+        m_allocatedWidth = w;
+        m_allocatedHeight = h;
 
         // Using a depth texture instead of a render because a texture allows sampling in shaders (which we will be doing a few times).
         switch (m_specs.attachmentType)
@@ -106,6 +126,7 @@ namespace core
             glDeleteFramebuffers(1, &m_fboID);
             m_fboID = 0;
         }
+        m_allocatedWidth = m_allocatedHeight = 0;
         m_isValid = false;
     }
 
@@ -179,6 +200,8 @@ namespace core
         , m_colorTextures(std::move(other.m_colorTextures))
         , m_depthTexture(other.m_depthTexture)
         , m_depthRenderbuffer(other.m_depthRenderbuffer)
+        , m_allocatedWidth(other.m_allocatedWidth)
+        , m_allocatedHeight(other.m_allocatedHeight)
         , m_isValid(other.m_isValid)
     {
         // Reset the moved-from object
@@ -201,6 +224,8 @@ namespace core
             m_colorTextures = std::move(other.m_colorTextures);
             m_depthTexture = other.m_depthTexture;
             m_depthRenderbuffer = other.m_depthRenderbuffer;
+            m_allocatedWidth = other.m_allocatedWidth;
+            m_allocatedHeight = other.m_allocatedHeight;
             m_isValid = other.m_isValid;
 
             // Reset the moved-from object
@@ -35,10 +35,22 @@ namespace core
     /// Manages an OpenGL framebuffer object (FBO) with configurable attachments.
     /// Provides functionality for off-screen rendering by creating render targets
     /// with color, depth, and stencil attachments according to the specifications.
+    /// <para>
+    /// The attachments are allocated rounded up to SIZE_BUCKET pixels. The specifications hold the
+    /// size in use, which is rendered into the bottom-left sub-rectangle, so resizing within the
+    /// allocation does not touch GL memory. Sample with GetUVScale() or gl_FragCoord accordingly.
+    /// </para>
     /// </summary>
     class FrameBuffer
     {
     public:
+        static constexpr unsigned int SIZE_BUCKET = 64;
+
+        /// <summary>
+        /// Rounds a size up to the allocation bucket.
+        /// </summary>
+        static unsigned int RoundUpToBucket(unsigned int size) { return (size + SIZE_BUCKET - 1) / SIZE_BUCKET * SIZE_BUCKET; }
+
         /// <summary>
         /// Constructs a framebuffer with the specified configuration.
         /// Creates the FBO and all required attachments based on the specifications.
@@ -127,8 +139,9 @@ namespace core
 #define CLEAR_BOUND(width, height) core::FrameBuffer::ClearBound(width, height, __FILE__, __LINE__)
 
         /// <summary>
-        /// Resizes the framebuffer and recreates all attachments with the new dimensions.
-        /// This will invalidate existing texture attachments and create new ones.
+        /// Resizes the framebuffer. The attachments are only recreated when the new size does not fit
+        /// the allocation, or when it drops below half of the allocated area. Recreating invalidates
+        /// the existing texture attachments.
         /// </summary>
         /// <param name="width">The new width of the framebuffer in pixels.</param>
         /// <param name="height">The new height of the framebuffer in pixels.</param>
@@ -187,6 +200,28 @@ namespace core
         /// <returns>The height in pixels.</returns>
         unsigned int GetHeight() const { return m_specs.height; }
 
+        /// <summary>
+        /// Gets the width the attachments were allocated with, at least GetWidth().
+        /// </summary>
+        unsigned int GetAllocatedWidth() const { return m_allocatedWidth; }
+
+        /// <summary>
+        /// Gets the height the attachments were allocated with, at least GetHeight().
+        /// </summary>
+        unsigned int GetAllocatedHeight() const { return m_allocatedHeight; }
+
+        /// <summary>
+        /// Checks if Resize() to the given size would keep the current allocation: the size fits
+        /// and uses at least half of it.
+        /// </summary>
+        bool FitsAllocation(unsigned int width, unsigned int height) const;
+
+        /// <summary>
+        /// Gets the texture coordinate of the top-right corner of the used sub-rectangle.
+        /// </summary>
+        float GetUVScaleX() const { return m_allocatedWidth ? static_cast<float>(m_specs.width) / m_allocatedWidth : 1.0f; }
+        float GetUVScaleY() const { return m_allocatedHeight ? static_cast<float>(m_specs.height) / m_allocatedHeight : 1.0f; }
+
         std::string GetName() const { return m_name; }
 
         /// <summary>
@@ -253,6 +288,8 @@ namespace core
         std::vector<GLuint> m_colorTextures;        // OpenGL texture ID for color attachment
         GLuint m_depthTexture = 0;                  // OpenGL texture ID for depth attachment (if used)
         GLuint m_depthRenderbuffer = 0;             // OpenGL renderbuffer ID for depth attachment (if used)
+        unsigned int m_allocatedWidth = 0;          // Size of the attachments, rounded up to SIZE_BUCKET
+        unsigned int m_allocatedHeight = 0;
         bool m_isValid = false;                     // Indicates whether the framebuffer is complete and valid
     };
 } // namespace core
\ No newline at end of file
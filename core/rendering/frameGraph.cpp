@@ -0,0 +1,260 @@
+#include "frameGraph.h"
+#include "gpuProfiler.h"
+#include "../profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <utility>
+
+namespace core
+{
+    static bool SameLayout(const FrameBufferSpecifications& a, const FrameBufferSpecifications& b)
+    {
+        return a.attachmentType == b.attachmentType && a.numColorAttachments == b.numColorAttachments;
+    }
+
+    static bool SameSpecs(const FrameBufferSpecifications& a, const FrameBufferSpecifications& b)
+    {
+        return SameLayout(a, b) && a.width == b.width && a.height == b.height;
+    }
+
+    FrameGraph::Handle FrameGraph::Builder::Read(Handle target)
+    {
+        m_graph.m_passes[m_passIndex].reads.push_back(target);
+        return target;
+    }
+
+    FrameGraph::Handle FrameGraph::Builder::Write(Handle target)
+    {
+        m_graph.m_passes[m_passIndex].writes.push_back(target);
+        return target;
+    }
+
+    void FrameGraph::Builder::SetSideEffect()
+    {
+        m_graph.m_passes[m_passIndex].sideEffect = true;
+    }
+
+    FrameBuffer& FrameGraph::Resources::Get(Handle target) const
+    {
+        const Resource& resource = m_graph.m_resources[target];
+        return resource.imported ? *resource.imported : *m_graph.m_physical[resource.physical];
+    }
+
+    void FrameGraph::Reset()
+    {
+        m_resources.clear();
+        m_passes.clear();
+        m_compiled = false;
+    }
+
+    FrameGraph::Handle FrameGraph::Import(const std::string& name, FrameBuffer& frameBuffer)
+    {
+        Resource resource;
+        resource.name = name;
+        resource.specs = frameBuffer.GetSpecifications();
+        resource.imported = &frameBuffer;
+        m_resources.push_back(resource);
+        return static_cast<Handle>(m_resources.size() - 1);
+    }
+
+    FrameGraph::Handle FrameGraph::CreateTarget(const std::string& name, const FrameBufferSpecifications& specs)
+    {
+        Resource resource;
+        resource.name = name;
+        resource.specs = specs;
+        m_resources.push_back(resource);
+        return static_cast<Handle>(m_resources.size() - 1);
+    }
+
+    void FrameGraph::AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute)
+    {
+        Pass pass;
+        pass.name = name;
+        pass.execute = std::move(execute);
+        m_passes.push_back(std::move(pass));
+
+        Builder builder(*this, static_cast<int>(m_passes.size() - 1));
+        setup(builder);
+    }
+
+    FrameBuffer* FrameGraph::GetImported(Handle target) const
+    {
+        return target >= 0 && target < static_cast<Handle>(m_resources.size()) ? m_resources[target].imported : nullptr;
+    }
+
+    std::size_t FrameGraph::EstimateBytes(const FrameBufferSpecifications& specs)
+    {
+        std::size_t pixels = static_cast<std::size_t>(specs.width) * specs.height;
+        std::size_t colorBytes = 8 * std::max(specs.numColorAttachments, 1u);    // RGBA16F per attachment
+        std::size_t depthBytes = 4;                                                 // 24 bit depth (+ 8 bit stencil)
+        switch (specs.attachmentType)
+        {
+        case AttachmentType::COLOR_ONLY:            return pixels * colorBytes;
+        case AttachmentType::COLOR_DEPTH:
+        case AttachmentType::COLOR_DEPTH_STENCIL:   return pixels * (colorBytes + depthBytes);
+        case AttachmentType::DEPTH_STENCIL:         return pixels * depthBytes;
+        }
+        return 0;
+    }
+
+    std::vector<FrameBufferSpecifications> FrameGraph::AssignSlots(bool alias, std::vector<int>& slotOfResource) const
+    {
+        // Transients in the order they come alive
+        std::vector<int> order;
+        for (int i = 0; i < static_cast<int>(m_resources.size()); ++i)
+        {
+            if (!m_resources[i].imported && m_resources[i].firstPass >= 0)
+                order.push_back(i);
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [this](int a, int b) { return m_resources[a].firstPass < m_resources[b].firstPass; });
+
+        // Greedy interval assignment: reuse the first slot with the same specification that is free again
+        std::vector<FrameBufferSpecifications> slots;
+        std::vector<int> slotLastPass;
+        slotOfResource.assign(m_resources.size(), -1);
+        for (int index : order)
+        {
+            const Resource& resource = m_resources[index];
+            int slot = -1;
+            if (alias)
+            {
+                for (int s = 0; s < static_cast<int>(slots.size()); ++s)
+                {
+                    if (slotLastPass[s] < resource.firstPass && SameSpecs(slots[s], resource.specs))
+                    {
+                        slot = s;
+                        break;
+                    }
+                }
+            }
+
+            if (slot < 0)
+            {
+                slot = static_cast<int>(slots.size());
+                slots.push_back(resource.specs);
+                slotLastPass.push_back(-1);
+            }
+
+            slotLastPass[slot] = resource.lastPass;
+            slotOfResource[index] = slot;
+        }
+        return slots;
+    }
+
+    void FrameGraph::Compile()
+    {
+        FINALENGINE_PROFILE_ZONE("FrameGraph::Compile");
+        // Count the readers of every target and the outputs of every pass
+        std::vector<int> passRefs(m_passes.size(), 0);
+        for (auto& resource : m_resources)
+            resource.readerCount = 0;
+        for (size_t p = 0; p < m_passes.size(); ++p)
+        {
+            m_passes[p].culled = false;
+            passRefs[p] = static_cast<int>(m_passes[p].writes.size());
+            for (Handle read : m_passes[p].reads)
+                m_resources[read].readerCount++;
+        }
+
+        // Cull backwards from the transients nobody reads, imported targets count as read by the outside
+        std::vector<Handle> unread;
+        for (int i = 0; i < static_cast<int>(m_resources.size()); ++i)
+        {
+            if (!m_resources[i].imported && m_resources[i].readerCount == 0)
+                unread.push_back(i);
+        }
+
+        while (!unread.empty())
+        {
+            Handle target = unread.back();
+            unread.pop_back();
+
+            for (size_t p = 0; p < m_passes.size(); ++p)
+            {
+                Pass& pass = m_passes[p];
+                if (pass.culled || std::find(pass.writes.begin(), pass.writes.end(), target) == pass.writes.end())
+                    continue;
+
+                if (--passRefs[p] > 0 || pass.sideEffect)
+                    continue;
+
+                pass.culled = true;
+                for (Handle read : pass.reads)
+                {
+                    Resource& resource = m_resources[read];
+                    if (--resource.readerCount == 0 && !resource.imported)
+                        unread.push_back(read);
+                }
+            }
+        }
+
+        // Lifetimes over the surviving passes
+        m_stats = {};
+        for (auto& resource : m_resources)
+            resource.firstPass = resource.lastPass = -1;
+        for (int p = 0; p < static_cast<int>(m_passes.size()); ++p)
+        {
+            const Pass& pass = m_passes[p];
+            if (pass.culled)
+            {
+                m_stats.culledPassCount++;
+                continue;
+            }
+
+            m_stats.passCount++;
+            auto touch = [p, this](Handle target) {
+                Resource& resource = m_resources[target];
+                if (resource.firstPass < 0) resource.firstPass = p;
+                resource.lastPass = p;
+            };
+            std::for_each(pass.reads.begin(), pass.reads.end(), touch);
+            std::for_each(pass.writes.begin(), pass.writes.end(), touch);
+        }
+
+        // Plan both ways for the stats, allocate the active one
+        std::vector<int> aliasedSlots;
+        std::vector<int> unaliasedSlots;
+        auto aliasedSpecs = AssignSlots(true, aliasedSlots);
+        auto unaliasedSpecs = AssignSlots(false, unaliasedSlots);
+        for (const auto& specs : aliasedSpecs)
+            m_stats.aliasedBytes += EstimateBytes(specs);
+        for (const auto& specs : unaliasedSpecs)
+            m_stats.unaliasedBytes += EstimateBytes(specs);
+        m_stats.transientCount = static_cast<int>(unaliasedSpecs.size());
+
+        const auto& slotSpecs = m_aliasing ? aliasedSpecs : unaliasedSpecs;
+        const auto& slotOfResource = m_aliasing ? aliasedSlots : unaliasedSlots;
+        m_stats.physicalCount = static_cast<int>(slotSpecs.size());
+
+        m_physical.resize(slotSpecs.size());
+        for (size_t slot = 0; slot < slotSpecs.size(); ++slot)
+            m_physical[slot] = &m_pool.Acquire(slotSpecs[slot]);
+
+        for (size_t i = 0; i < m_resources.size(); ++i)
+            m_resources[i].physical = slotOfResource[i];
+
+        m_compiled = true;
+    }
+
+    void FrameGraph::Execute()
+    {
+        FINALENGINE_PROFILE_ZONE("FrameGraph::Execute");
+        if (!m_compiled)
+            Compile();
+
+        Resources resources(*this);
+        for (const Pass& pass : m_passes)
+        {
+            if (pass.culled) continue;
+
+            FINALENGINE_PROFILE_ZONE(pass.name);
+            GpuProfiler::Scope profileScope(pass.name);
+            pass.execute(resources);
+        }
+
+        m_physical.clear();
+        m_pool.EndFrame();
+    }
+} // namespace core
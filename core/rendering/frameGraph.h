@@ -0,0 +1,165 @@
+#pragma once
+
+#include "frameBuffer.h"
+#include "renderTargetPool.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// Orders the render passes of a frame by the render targets they read and write.
+    /// <para>
+    /// The graph is rebuilt every frame: Reset(), Import() the framebuffers owned elsewhere
+    /// (scene buffer, viewport), AddPass() every pass, then Compile() and Execute(). Passes run
+    /// in the order they were added. Compiling culls the passes whose outputs are never read,
+    /// unless they write an imported target or are marked as having a side effect.
+    /// </para>
+    /// <para>
+    /// Targets created by passes are transient: they only live from their first to their last
+    /// use. With aliasing enabled, transients with the same specification whose lifetimes do not
+    /// overlap share one physical framebuffer. Physical framebuffers are borrowed from a
+    /// RenderTargetPool for the frame and returned at the end of Execute().
+    /// </para>
+    /// </summary>
+    class FrameGraph
+    {
+    public:
+        using Handle = int;
+        static constexpr Handle INVALID_HANDLE = -1;
+
+        /// <summary>
+        /// Declares what a pass reads and writes, handed to the setup function of AddPass().
+        /// </summary>
+        class Builder
+        {
+        public:
+            Handle Read(Handle target);
+            Handle Write(Handle target);
+
+            /// <summary>
+            /// Keeps the pass even if nothing reads its outputs.
+            /// </summary>
+            void SetSideEffect();
+
+        private:
+            friend class FrameGraph;
+            Builder(FrameGraph& graph, int passIndex) : m_graph(graph), m_passIndex(passIndex) {}
+
+            FrameGraph& m_graph;
+            int m_passIndex;
+        };
+
+        /// <summary>
+        /// Resolves target handles to framebuffers while a pass executes.
+        /// </summary>
+        class Resources
+        {
+        public:
+            FrameBuffer& Get(Handle target) const;
+
+        private:
+            friend class FrameGraph;
+            explicit Resources(const FrameGraph& graph) : m_graph(graph) {}
+
+            const FrameGraph& m_graph;
+        };
+
+        using SetupFunction = std::function<void(Builder&)>;
+        using ExecuteFunction = std::function<void(const Resources&)>;
+
+        /// <summary>
+        /// Numbers of the last compiled frame.
+        /// </summary>
+        struct Stats
+        {
+            int passCount = 0;
+            int culledPassCount = 0;
+            int transientCount = 0;
+            int physicalCount = 0;              // Framebuffers backing the transients this frame
+            std::size_t unaliasedBytes = 0;     // Transient memory if every transient had its own framebuffer
+            std::size_t aliasedBytes = 0;       // Transient memory with aliasing
+        };
+
+        /// <summary>
+        /// Starts building a new frame.
+        /// </summary>
+        void Reset();
+
+        /// <summary>
+        /// Makes a framebuffer owned elsewhere usable by passes. Writing it keeps a pass alive.
+        /// </summary>
+        Handle Import(const std::string& name, FrameBuffer& frameBuffer);
+
+        /// <summary>
+        /// Declares a new transient target. It only gets memory if a surviving pass uses it.
+        /// </summary>
+        Handle CreateTarget(const std::string& name, const FrameBufferSpecifications& specs);
+
+        void AddPass(const std::string& name, const SetupFunction& setup, ExecuteFunction execute);
+
+        /// <summary>
+        /// Culls unused passes, computes the lifetimes of the transients and assigns them to
+        /// physical framebuffers acquired from the pool.
+        /// </summary>
+        void Compile();
+
+        /// <summary>
+        /// Runs the passes that survived Compile() in order, then returns the physical framebuffers to the pool.
+        /// </summary>
+        void Execute();
+
+        /// <summary>
+        /// Gets an imported framebuffer, usable while building the graph. Returns nullptr for transients.
+        /// </summary>
+        FrameBuffer* GetImported(Handle target) const;
+
+        void SetAliasing(bool enabled) { m_aliasing = enabled; }
+        bool GetAliasing() const { return m_aliasing; }
+
+        const Stats& GetStats() const { return m_stats; }
+        const RenderTargetPool& GetPool() const { return m_pool; }
+
+        /// <summary>
+        /// Approximate GPU memory of a framebuffer with the given specification.
+        /// </summary>
+        static std::size_t EstimateBytes(const FrameBufferSpecifications& specs);
+
+    private:
+        struct Resource
+        {
+            std::string name;
+            FrameBufferSpecifications specs;
+            FrameBuffer* imported = nullptr;
+            int physical = -1;
+            int firstPass = -1;     // First and last surviving pass using the target
+            int lastPass = -1;
+            int readerCount = 0;    // Surviving passes reading the target, used for culling
+        };
+
+        struct Pass
+        {
+            std::string name;
+            ExecuteFunction execute;
+            std::vector<Handle> reads;
+            std::vector<Handle> writes;
+            bool sideEffect = false;
+            bool culled = false;
+        };
+
+        /// <summary>
+        /// Assigns every used transient to a physical slot, returns the specification of each slot.
+        /// </summary>
+        std::vector<FrameBufferSpecifications> AssignSlots(bool alias, std::vector<int>& slotOfResource) const;
+
+        std::vector<Resource> m_resources;
+        std::vector<Pass> m_passes;
+        RenderTargetPool m_pool;
+        std::vector<FrameBuffer*> m_physical;  // Borrowed from m_pool until the end of Execute()
+        bool m_aliasing = true;
+        bool m_compiled = false;
+        Stats m_stats;
+    };
+} // namespace core
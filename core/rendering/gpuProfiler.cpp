@@ -0,0 +1,206 @@
+#include "gpuProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace core
+{
+    bool GpuProfiler::s_enabled = true;
+    bool GpuProfiler::s_inFrame = false;
+    int GpuProfiler::s_frameIndex = 0;
+    int GpuProfiler::s_droppedFrames = 0;
+    std::array<GpuProfiler::FrameSlot, GpuProfiler::FRAME_LATENCY> GpuProfiler::s_slots;
+    std::vector<int> GpuProfiler::s_openMarkers;
+    std::vector<GpuProfiler::PassStats> GpuProfiler::s_passes;
+    std::unordered_map<std::string, int> GpuProfiler::s_passIndices;
+
+    float GpuProfiler::PassStats::GetLast() const
+    {
+        return sampleCount > 0 ? samples[(nextSample + HISTORY_SIZE - 1) % HISTORY_SIZE] : 0.0f;
+    }
+
+    float GpuProfiler::PassStats::GetAverage() const
+    {
+        if (sampleCount == 0) return 0.0f;
+
+        float total = 0.0f;
+        for (int i = 0; i < sampleCount; ++i)
+            total += samples[i];
+        return total / sampleCount;
+    }
+
+    float GpuProfiler::PassStats::GetMax() const
+    {
+        return sampleCount > 0 ? *std::max_element(samples.begin(), samples.begin() + sampleCount) : 0.0f;
+    }
+
+    float GpuProfiler::PassStats::GetPercentile(float percentile) const
+    {
+        if (sampleCount == 0) return 0.0f;
+
+        std::array<float, HISTORY_SIZE> sorted = samples;
+        int rank = std::clamp(static_cast<int>(percentile / 100.0f * (sampleCount - 1) + 0.5f), 0, sampleCount - 1);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + sampleCount);
+        return sorted[rank];
+    }
+
+    void GpuProfiler::BeginFrame()
+    {
+        FrameSlot& slot = s_slots[s_frameIndex % FRAME_LATENCY];
+        if (slot.pending)
+            Collect(slot);
+
+        slot.markers.clear();
+        slot.usedQueries = 0;
+        slot.pending = false;
+        s_openMarkers.clear();
+        s_inFrame = s_enabled;
+    }
+
+    void GpuProfiler::EndFrame()
+    {
+        while (!s_openMarkers.empty())
+            End();
+
+        FrameSlot& slot = s_slots[s_frameIndex % FRAME_LATENCY];
+        slot.pending = s_inFrame && !slot.markers.empty();
+        s_inFrame = false;
+        s_frameIndex++;
+    }
+
+    void GpuProfiler::Begin(const std::string& name)
+    {
+        if (!s_inFrame) return;
+
+        FrameSlot& slot = s_slots[s_frameIndex % FRAME_LATENCY];
+        Marker marker;
+        marker.pass = GetOrAddPass(name, static_cast<int>(s_openMarkers.size()));
+        marker.beginQuery = IssueTimestamp(slot);
+        s_openMarkers.push_back(static_cast<int>(slot.markers.size()));
+        slot.markers.push_back(marker);
+    }
+
+    void GpuProfiler::End()
+    {
+        if (!s_inFrame || s_openMarkers.empty()) return;
+
+        FrameSlot& slot = s_slots[s_frameIndex % FRAME_LATENCY];
+        slot.markers[s_openMarkers.back()].endQuery = IssueTimestamp(slot);
+        s_openMarkers.pop_back();
+    }
+
+    int GpuProfiler::GetOrAddPass(const std::string& name, int depth)
+    {
+        auto it = s_passIndices.find(name);
+        if (it != s_passIndices.end())
+            return it->second;
+
+        PassStats pass;
+        pass.name = name;
+        pass.depth = depth;
+        s_passes.push_back(pass);
+        int index = static_cast<int>(s_passes.size() - 1);
+        s_passIndices.emplace(name, index);
+        return index;
+    }
+
+    int GpuProfiler::IssueTimestamp(FrameSlot& slot)
+    {
+        if (slot.usedQueries == static_cast<int>(slot.queries.size()))
+        {
+            GLuint query = 0;
+            glGenQueries(1, &query);
+            slot.queries.push_back(query);
+        }
+
+        int index = slot.usedQueries++;
+        glQueryCounter(slot.queries[index], GL_TIMESTAMP);
+        return index;
+    }
+
+    void GpuProfiler::Collect(FrameSlot& slot)
+    {
+        // Timestamps complete in order, once the last one is available all of them are
+        GLint available = 0;
+        glGetQueryObjectiv(slot.queries[slot.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            s_droppedFrames++;
+            return;
+        }
+
+        std::vector<float> frameTotals(s_passes.size(), -1.0f);
+        for (const Marker& marker : slot.markers)
+        {
+            if (marker.endQuery < 0 || marker.pass >= static_cast<int>(frameTotals.size())) continue;
+
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(slot.queries[marker.beginQuery], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(slot.queries[marker.endQuery], GL_QUERY_RESULT, &end);
+
+            float& total = frameTotals[marker.pass];
+            total = std::max(total, 0.0f) + static_cast<float>((end - begin) / 1.0e6);
+        }
+
+        for (size_t i = 0; i < frameTotals.size(); ++i)
+        {
+            if (frameTotals[i] < 0.0f) continue;
+
+            PassStats& pass = s_passes[i];
+            pass.samples[pass.nextSample] = frameTotals[i];
+            pass.nextSample = (pass.nextSample + 1) % HISTORY_SIZE;
+            pass.sampleCount = std::min(pass.sampleCount + 1, HISTORY_SIZE);
+        }
+    }
+
+    void GpuProfiler::Reset()
+    {
+        // Markers still in flight point at the old passes, drop them and stop recording this frame
+        for (FrameSlot& slot : s_slots)
+        {
+            slot.markers.clear();
+            slot.pending = false;
+        }
+        s_openMarkers.clear();
+        s_inFrame = false;
+
+        s_passes.clear();
+        s_passIndices.clear();
+        s_droppedFrames = 0;
+    }
+
+    bool GpuProfiler::ExportCsv(const std::string& path)
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            printf("[PROFILER] Could not write %s\n", path.c_str());
+            return false;
+        }
+
+        file << "pass,depth,samples,last_ms,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+        for (const PassStats& pass : s_passes)
+        {
+            file << '"' << pass.name << "\"," << pass.depth << ',' << pass.sampleCount << ','
+                 << pass.GetLast() << ',' << pass.GetAverage() << ','
+                 << pass.GetPercentile(50.0f) << ',' << pass.GetPercentile(95.0f) << ',' << pass.GetPercentile(99.0f) << ','
+                 << pass.GetMax() << '\n';
+        }
+
+        printf("[PROFILER] Wrote %zu passes to %s\n", s_passes.size(), path.c_str());
+        return true;
+    }
+
+    void GpuProfiler::Shutdown()
+    {
+        for (FrameSlot& slot : s_slots)
+        {
+            if (!slot.queries.empty())
+                glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+            slot = FrameSlot();
+        }
+        s_openMarkers.clear();
+        s_inFrame = false;
+    }
+} // namespace core
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <glad/glad.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// Measures the GPU time of named passes with timestamp queries.
+    /// <para>
+    /// Every Begin()/End() pair records a glQueryCounter(GL_TIMESTAMP) on each side, so scopes nest
+    /// freely and do not collide with the GL_TIME_ELAPSED query of DynamicResolution. The queries of
+    /// a frame go into one of FRAME_LATENCY slots and are read back when the slot comes around again.
+    /// If the GPU has not finished by then the frame is dropped instead of waiting, so the CPU never
+    /// stalls on a result.
+    /// </para>
+    /// <para>
+    /// Each pass keeps its last HISTORY_SIZE frames, summed when a name is used several times in one
+    /// frame, for the rolling average and percentiles.
+    /// </para>
+    /// </summary>
+    class GpuProfiler
+    {
+    public:
+        static constexpr int FRAME_LATENCY = 4;
+        static constexpr int HISTORY_SIZE = 240;
+
+        /// <summary>
+        /// Rolling statistics of one named pass.
+        /// </summary>
+        struct PassStats
+        {
+            std::string name;
+            int depth = 0;                          // Nesting level the pass was first seen at
+            std::array<float, HISTORY_SIZE> samples = {};
+            int sampleCount = 0;
+            int nextSample = 0;
+
+            float GetLast() const;
+            float GetAverage() const;
+            float GetMax() const;
+
+            /// <summary>
+            /// Gets a percentile of the recorded samples.
+            /// </summary>
+            /// <param name="percentile">Between 0 and 100.</param>
+            float GetPercentile(float percentile) const;
+        };
+
+        /// <summary>
+        /// Times the GPU work issued while the scope is alive.
+        /// </summary>
+        class Scope
+        {
+        public:
+            explicit Scope(const std::string& name) { Begin(name); }
+            ~Scope() { End(); }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+        };
+
+        static void SetEnabled(bool enabled) { s_enabled = enabled; }
+        static bool IsEnabled() { return s_enabled; }
+
+        /// <summary>
+        /// Starts recording a frame, reading back the frame that used the same slot FRAME_LATENCY frames ago.
+        /// </summary>
+        static void BeginFrame();
+
+        /// <summary>
+        /// Stops recording the frame, closing any scope left open.
+        /// </summary>
+        static void EndFrame();
+
+        static void Begin(const std::string& name);
+        static void End();
+
+        /// <summary>
+        /// Gets every pass seen so far, in the order they first appeared.
+        /// </summary>
+        static const std::vector<PassStats>& GetPasses() { return s_passes; }
+
+        /// <summary>
+        /// Gets the number of frames whose results were not ready in time and were skipped.
+        /// </summary>
+        static int GetDroppedFrames() { return s_droppedFrames; }
+
+        /// <summary>
+        /// Forgets every pass and its history.
+        /// </summary>
+        static void Reset();
+
+        /// <summary>
+        /// Writes the statistics of every pass to a CSV file, one row per pass.
+        /// </summary>
+        /// <returns>True if the file was written.</returns>
+        static bool ExportCsv(const std::string& path);
+
+        /// <summary>
+        /// Deletes the query objects, call while the context still exists.
+        /// </summary>
+        static void Shutdown();
+
+    private:
+        struct Marker
+        {
+            int pass = 0;
+            int beginQuery = 0;     // Indices into the queries of the slot
+            int endQuery = -1;
+        };
+
+        struct FrameSlot
+        {
+            std::vector<GLuint> queries;
+            std::vector<Marker> markers;
+            int usedQueries = 0;
+            bool pending = false;
+        };
+
+        static int GetOrAddPass(const std::string& name, int depth);
+        static int IssueTimestamp(FrameSlot& slot);
+        static void Collect(FrameSlot& slot);
+
+        static bool s_enabled;
+        static bool s_inFrame;
+        static int s_frameIndex;
+        static int s_droppedFrames;
+        static std::array<FrameSlot, FRAME_LATENCY> s_slots;
+        static std::vector<int> s_openMarkers;
+        static std::vector<PassStats> s_passes;
+        static std::unordered_map<std::string, int> s_passIndices;
+    };
+} // namespace core
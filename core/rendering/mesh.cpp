@@ -1,21 +1,32 @@
 #include "mesh.h"
+#include "renderStats.h"
 
 namespace core {
-    Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices) : vertices(vertices), indices(indices) {
-        SetupBuffers();
+    Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices)
+        : vertices(std::make_shared<const std::vector<Vertex>>(std::move(vertices))),
+          indices(std::make_shared<const std::vector<GLuint>>(std::move(indices))),
+          buffers(std::make_shared<Buffers>()) {
+        for (const auto& vertex : *this->vertices)
+            bounds.Encapsulate(vertex.position);
     }
 
-    void Mesh::SetupBuffers() {
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-        glBindVertexArray(VAO);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizei>(sizeof(Vertex) * vertices.size()), &vertices[0],
+    const Mesh::Buffers& Mesh::GetBuffers() const {
+        if (buffers->VAO == 0)
+            SetupBuffers();
+        return *buffers;
+    }
+
+    void Mesh::SetupBuffers() const {
+        glGenVertexArrays(1, &buffers->VAO);
+        glGenBuffers(1, &buffers->VBO);
+        glGenBuffers(1, &buffers->EBO);
+        glBindVertexArray(buffers->VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers->VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizei>(sizeof(Vertex) * vertices->size()), vertices->data(),
                      GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizei>(sizeof(unsigned int) * indices.size()),
-                     &indices[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizei>(sizeof(unsigned int) * indices->size()),
+                     indices->data(), GL_STATIC_DRAW);
         
         // Position
         glEnableVertexAttribArray(0);
@@ -82,8 +93,54 @@ namespace core {
         return Mesh(vertexVector, indices);
     }
 
+    Mesh Mesh::GenerateCube(const glm::vec3& halfExtents) {
+        const glm::vec3 normals[] = {
+                glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+                glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+                glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+        };
+        const glm::vec3 tangents[] = {
+                glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f),
+                glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+                glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f)
+        };
+        const glm::vec2 uvs[] = { glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1), glm::vec2(0, 1) };
+
+        std::vector<Vertex> vertexVector;
+        std::vector<GLuint> indices;
+        vertexVector.reserve(24);
+        indices.reserve(36);
+        for (int face = 0; face < 6; ++face) {
+            // bitangent = normal x tangent, so the corners below wind counter-clockwise seen from outside
+            const glm::vec3 normal = normals[face];
+            const glm::vec3 tangent = tangents[face];
+            const glm::vec3 bitangent = glm::cross(normal, tangent);
+            const glm::vec3 corners[] = {
+                    normal - tangent - bitangent, normal + tangent - bitangent,
+                    normal + tangent + bitangent, normal - tangent + bitangent
+            };
+
+            const GLuint first = static_cast<GLuint>(vertexVector.size());
+            for (int i = 0; i < 4; ++i) {
+                vertexVector.emplace_back(corners[i] * halfExtents, normal, uvs[i], tangent, bitangent);
+            }
+            for (GLuint index : {0u, 1u, 2u, 0u, 2u, 3u}) {
+                indices.push_back(first + index);
+            }
+        }
+
+        return Mesh(vertexVector, indices);
+    }
+
     void Mesh::Render(GLenum drawMode) const {
-        glBindVertexArray(VAO);
-        glDrawElements(drawMode, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindVertexArray(GetBuffers().VAO);
+        glDrawElements(drawMode, static_cast<GLsizei>(indices->size()), GL_UNSIGNED_INT, 0);
+        RenderStats::RecordDraw(drawMode, static_cast<GLsizei>(indices->size()));
+    }
+
+    void Mesh::RenderInstanced(GLenum drawMode, int instanceCount) const {
+        glBindVertexArray(GetBuffers().VAO);
+        glDrawElementsInstanced(drawMode, static_cast<GLsizei>(indices->size()), GL_UNSIGNED_INT, 0, instanceCount);
+        RenderStats::RecordDraw(drawMode, static_cast<GLsizei>(indices->size()), instanceCount);
     }
 }
\ No newline at end of file
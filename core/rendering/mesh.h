@@ -1,22 +1,56 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <glad/glad.h>
+#include <glm/vec3.hpp>
+#include "bounds.h"
 #include "vertex.h"
 
 namespace core {
     class Mesh {
     private:
-        std::vector<Vertex> vertices;
-        std::vector<GLuint> indices;
-        GLuint VAO;
-        GLuint VBO;
-        GLuint EBO;
+        // Shared, so copies of a mesh (one per Renderer using it) do not duplicate the vertex data
+        std::shared_ptr<const std::vector<Vertex>> vertices;
+        std::shared_ptr<const std::vector<GLuint>> indices;
+
+        // Created on the first draw, so meshes can be built on a thread without a GL context.
+        // Shared like the vertex data, all copies of a mesh draw from the same buffers.
+        struct Buffers {
+            GLuint VAO = 0;
+            GLuint VBO = 0;
+            GLuint EBO = 0;
+        };
+        std::shared_ptr<Buffers> buffers;
+        Bounds bounds;
     public:
         Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices);
         void Render(GLenum drawMode) const;
+
+        /// <summary>
+        /// Draws the mesh instanceCount times in a single call, gl_InstanceID tells the copies apart.
+        /// </summary>
+        void RenderInstanced(GLenum drawMode, int instanceCount) const;
+
+        /// <summary>
+        /// Object-space bounds of the vertices.
+        /// </summary>
+        const Bounds& GetBounds() const { return bounds; }
+
+        /// <summary>
+        /// The vertex array object, identifies the GPU geometry of this mesh.
+        /// Uploads the mesh if it was not drawn yet, call it on the render thread.
+        /// </summary>
+        GLuint GetVertexArray() const { return GetBuffers().VAO; }
         static Mesh GenerateQuad();
+
+        /// <summary>
+        /// Generates a box centered on the origin with outward facing normals.
+        /// </summary>
+        /// <param name="halfExtents">Half the size of the box along each axis.</param>
+        static Mesh GenerateCube(const glm::vec3& halfExtents = glm::vec3(1.0f));
     private:
-        void SetupBuffers();
+        const Buffers& GetBuffers() const;
+        void SetupBuffers() const;
     };
 }
\ No newline at end of file
@@ -2,10 +2,10 @@
 #include "../../frameBuffer.h"
 #include "../../shader.h"
 #include "bloomEffect.h"
-#include "../../../scene.h"
-#include "../../../../editor/Editor.h"
+#include <algorithm>
 #include <glad/glad.h>
 #include <imgui.h>
+#include <string>
 
 
 namespace core
@@ -15,104 +15,219 @@ namespace core
         BloomEffect::BloomEffect(std::weak_ptr<PostProcessingManager> manager)
             : PostProcessingEffectBase("BloomEffect", nullptr, manager, true)
         {
-            m_blurShader = std::make_shared<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/bloomBlur.frag");
+            m_downsampleShader = std::make_shared<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/bloomDownsample.frag");
+            m_upsampleShader = std::make_shared<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/bloomUpsample.frag");
             m_compositeShader = std::make_shared<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/composite.frag");
-            m_blurMaterial = std::make_shared<Material>(m_blurShader->ID);
+            m_downsampleMaterial = std::make_shared<Material>(m_downsampleShader->ID);
+            m_upsampleMaterial = std::make_shared<Material>(m_upsampleShader->ID);
             m_compositeMaterial = std::make_shared<Material>(m_compositeShader->ID);
+            m_blur = std::make_unique<SeparableBlur>();
+        }
+
+        int BloomEffect::GetPassCount() const
+        {
+            // Prefilter, horizontal and vertical blur per iteration, composite
+            if (m_blurMode == BloomBlurMode::SeparableGaussian)
+                return 1 + 2 * m_blurSettings.iterations + 1;
 
-            tempFBO_1 = FrameBuffer("postProcessFBO_1", FrameBufferSpecifications{ 100, 100, AttachmentType::COLOR_ONLY });
-            tempFBO_2 = FrameBuffer("postProcessFBO_2", FrameBufferSpecifications{ 100, 100, AttachmentType::COLOR_ONLY });
+            // Prefilter and downsamples, upsamples, composite
+            return m_mipCount + (m_mipCount - 1) + 1;
+        }
 
-            m_bloomThreshold.SetOnChange([this](float newThreshold)
+        int BloomEffect::GetMipCount(int width, int height) const
+        {
+            int mipCount = 1;
+            while (mipCount < m_mipCount && (width >> (mipCount + 1)) >= 2 && (height >> (mipCount + 1)) >= 2)
+                mipCount++;
+            return mipCount;
+        }
+
+        void BloomEffect::AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height)
+        {
+            float intensity = m_intensity;
+            FrameGraph::Handle bloom = AddBloomPasses(graph, input, width, height, intensity);
+
+            graph.AddPass("BloomComposite",
+                [input, bloom, output](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    builder.Read(bloom);
+                    builder.Write(output);
+                },
+                [this, input, bloom, output, width, height, intensity](const FrameGraph::Resources& resources)
                 {
-                    if (auto currentScene = editor::Editor::editorCtx.currentScene)
-                        currentScene->SetBloomThreshold(newThreshold);
+                    Composite(resources.Get(input), resources.Get(bloom), resources.Get(output), width, height, intensity);
                 });
         }
 
-        int BloomEffect::GetPassCount() const
+        bool BloomEffect::AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage)
         {
-            return m_blurAmount * 2;
+            float intensity = m_intensity;
+            FrameGraph::Handle bloom = AddBloomPasses(graph, sceneTarget, width, height, intensity);
+
+            stage.function = "BloomCompositeStage";
+            stage.reads.push_back(bloom);
+            stage.setUniforms = [this, bloom, intensity](Material& material, const FrameGraph::Resources& resources, int& textureUnit)
+                {
+                    SetCompositeUniforms(material, resources.Get(bloom), intensity, textureUnit++);
+                };
+            return true;
         }
 
-        void BloomEffect::Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height)
+        FrameGraph::Handle BloomEffect::AddBloomPasses(FrameGraph& graph, FrameGraph::Handle input, const int width, const int height, float& intensity)
         {
-            std::shared_ptr<core::Material> material;
+            intensity = m_intensity;
+            if (m_blurMode == BloomBlurMode::SeparableGaussian)
+                return AddSeparableGaussianPasses(graph, input, width, height);
 
-            GLuint thresholdTexture = inputFBO.GetColorAttachment(1);
-            
-            tempFBO_1.Resize(width, height);
-            tempFBO_2.Resize(width, height);
+            std::vector<FrameGraph::Handle> mipTargets;
+            for (int mip = 0; mip < GetMipCount(width, height); mip++)
+            {
+                FrameBufferSpecifications mipSpecs{
+                    std::max(1u, static_cast<unsigned>(width) >> (mip + 1)),
+                    std::max(1u, static_cast<unsigned>(height) >> (mip + 1)),
+                    AttachmentType::COLOR_ONLY
+                };
+                mipTargets.push_back(graph.CreateTarget("BloomMip_" + std::to_string(mip), mipSpecs));
+            }
+
+            graph.AddPass(GetName(),
+                [input, mipTargets](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    for (FrameGraph::Handle mipTarget : mipTargets)
+                        builder.Write(mipTarget);
+                },
+                [this, input, mipTargets](const FrameGraph::Resources& resources)
+                {
+                    m_mipBuffers.clear();
+                    for (FrameGraph::Handle mipTarget : mipTargets)
+                        m_mipBuffers.push_back(&resources.Get(mipTarget));
+                    BuildMipChain(resources.Get(input));
+                });
+
+            // The half resolution mip ends up holding the sum of every level, the composite averages it
+            if (m_debugMode != BloomDebugMode::ThresholdOnly)
+                intensity /= static_cast<float>(mipTargets.size());
+            return mipTargets[0];
+        }
+
+        FrameGraph::Handle BloomEffect::AddSeparableGaussianPasses(FrameGraph& graph, FrameGraph::Handle input, const int width, const int height)
+        {
+            FrameBufferSpecifications prefilterSpecs{
+                std::max(1u, static_cast<unsigned>(width) / 2),
+                std::max(1u, static_cast<unsigned>(height) / 2),
+                AttachmentType::COLOR_ONLY
+            };
+            FrameGraph::Handle prefiltered = graph.CreateTarget("BloomPrefilter", prefilterSpecs);
+
+            graph.AddPass("BloomPrefilter",
+                [input, prefiltered](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    builder.Write(prefiltered);
+                },
+                [this, input, prefiltered](const FrameGraph::Resources& resources)
+                {
+                    Prefilter(resources.Get(input), resources.Get(prefiltered));
+                });
 
             if (m_debugMode == BloomDebugMode::ThresholdOnly)
-            {
-                // Blit the second color attachment (bright pixels) directly to output
-                outputFBO.BindDraw();
-                inputFBO.BindRead();
+                return prefiltered;
+            return m_blur->AddPass(graph, "BloomBlur", prefiltered, prefilterSpecs.width, prefilterSpecs.height, m_blurSettings);
+        }
 
-                glReadBuffer(GL_COLOR_ATTACHMENT1);
-                glDrawBuffer(GL_COLOR_ATTACHMENT0);
+        void BloomEffect::Prefilter(const FrameBuffer& scene, FrameBuffer& target)
+        {
+            target.Bind();
+            glViewport(0, 0, target.GetWidth(), target.GetHeight());
 
-                glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
-                
-                glReadBuffer(GL_COLOR_ATTACHMENT0);
-                return;
-            }
+            m_downsampleMaterial->SetTextureID("sourceTexture", scene.GetColorAttachment(), 0);
+            m_downsampleMaterial->SetVec2("sourceUVScale", glm::vec2(scene.GetUVScaleX(), scene.GetUVScaleY()));
+            m_downsampleMaterial->SetBool("prefilter", true);
+            m_downsampleMaterial->SetFloat("threshold", m_bloomThreshold);
+            m_downsampleMaterial->SetFloat("knee", m_bloomThreshold * m_softKnee);
+            m_downsampleMaterial->Use();
 
-            FrameBuffer* targetFBO = nullptr;
-            FrameBuffer* sourceFBO = nullptr;
-            FrameBuffer* lastFBO = nullptr;
+            RenderQuad(target.GetWidth(), target.GetHeight());
+        }
 
-            tempFBO_1.BindAndClear(width, height);
-            tempFBO_2.BindAndClear(width, height);
-            tempFBO_2.Unbind();
+        void BloomEffect::Composite(const FrameBuffer& scene, const FrameBuffer& bloom, FrameBuffer& outputFBO, const int width, const int height, const float intensity)
+        {
+            outputFBO.Bind();
+            glViewport(0, 0, width, height);
 
-            for (int passIndex = 0; passIndex < GetPassCount(); passIndex++)
-            {
-                // Set the target and source FBO, as well as determining if doing a horizontal pass.
-                bool horizontal = passIndex % 2 == 0;
-                targetFBO = horizontal ? &tempFBO_1 : &tempFBO_2;
-                sourceFBO = (targetFBO == &tempFBO_1) ? &tempFBO_2 : &tempFBO_1;
-
-                bool returnAfter = m_debugMode == BloomDebugMode::BlurOnly && passIndex + 1 == GetPassCount();
-
-                if (returnAfter)
-                    outputFBO.BindAndClear(width, height);
-                else 
-                    targetFBO->BindAndClear(width, height);
-
-                // Set Material
-                material = m_blurMaterial;
-                material->SetBool("horizontal", horizontal);
-                material->SetFloat("intensity", m_intensity);
-
-                // First pass uses the threshold texture from MRT, subsequent passes use temp buffers
-                if (passIndex == 0)
-                    material->SetTextureID("inputTexture", thresholdTexture, 0);
-                else
-                    material->SetTextureID("inputTexture", sourceFBO->GetColorAttachment(), 0);
+            m_compositeMaterial->SetTextureID("sceneTexture", scene.GetColorAttachment(), 0);
+            SetCompositeUniforms(*m_compositeMaterial, bloom, intensity, 1);
+            m_compositeMaterial->Use();
 
-                material->Use();
+            RenderQuad(width, height);
+        }
 
+        void BloomEffect::SetCompositeUniforms(Material& material, const FrameBuffer& bloom, const float intensity, const int bloomUnit) const
+        {
+            material.SetTextureID("bloomTexture", bloom.GetColorAttachment(), bloomUnit);
+            material.SetVec2("bloomUVScale", glm::vec2(bloom.GetUVScaleX(), bloom.GetUVScaleY()));
+            material.SetFloat("bloomIntensity", intensity);
+            material.SetBool("bloomOnly", m_debugMode != BloomDebugMode::None);
+        }
 
-                RenderQuad(width, height);
+        void BloomEffect::Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height)
+        {
+            if (m_mipBuffers.empty())
+                return;
+
+            // The half resolution mip holds the sum of every level, average it over the scene
+            int accumulatedMips = BuildMipChain(inputFBO);
+            Composite(inputFBO, *m_mipBuffers[0], outputFBO, width, height, m_intensity / accumulatedMips);
+        }
+
+        int BloomEffect::BuildMipChain(const FrameBuffer& scene)
+        {
+            // Prefilter into the half resolution mip, then downsample down the chain
+            Prefilter(scene, *m_mipBuffers[0]);
+            for (size_t mip = 1; mip < m_mipBuffers.size(); mip++)
+            {
+                FrameBuffer& source = *m_mipBuffers[mip - 1];
+                FrameBuffer& target = *m_mipBuffers[mip];
+                target.Bind();
+                glViewport(0, 0, target.GetWidth(), target.GetHeight());
 
-                if (returnAfter)
-                    return;
+                m_downsampleMaterial->SetTextureID("sourceTexture", source.GetColorAttachment(), 0);
+                m_downsampleMaterial->SetVec2("sourceUVScale", glm::vec2(source.GetUVScaleX(), source.GetUVScaleY()));
+                m_downsampleMaterial->SetBool("prefilter", false);
+                m_downsampleMaterial->Use();
 
-                lastFBO = targetFBO;
+                RenderQuad(target.GetWidth(), target.GetHeight());
             }
 
-            outputFBO.BindAndClear(width, height);
+            // Tent upsample every mip and add it onto the next larger one
+            int accumulatedMips = 1;
+            if (m_debugMode != BloomDebugMode::ThresholdOnly)
+            {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_ONE, GL_ONE);
 
-            material = m_compositeMaterial;
-            material->SetTextureID("sceneTexture", inputFBO.GetColorAttachment(), 0);
-            material->SetTextureID("bloomTexture", lastFBO->GetColorAttachment(), 1);
-            material->Use();
+                for (size_t mip = m_mipBuffers.size() - 1; mip > 0; mip--)
+                {
+                    FrameBuffer& mipSource = *m_mipBuffers[mip];
+                    FrameBuffer& target = *m_mipBuffers[mip - 1];
+                    target.Bind();
+                    glViewport(0, 0, target.GetWidth(), target.GetHeight());
 
-            CLEAR_BOUND(width, height);
-            RenderQuad(width, height);
+                    m_upsampleMaterial->SetTextureID("sourceTexture", mipSource.GetColorAttachment(), 0);
+                    m_upsampleMaterial->SetVec2("sourceUVScale", glm::vec2(mipSource.GetUVScaleX(), mipSource.GetUVScaleY()));
+                    m_upsampleMaterial->SetFloat("filterRadius", m_filterRadius);
+                    m_upsampleMaterial->Use();
+
+                    RenderQuad(target.GetWidth(), target.GetHeight());
+                }
+
+                glDisable(GL_BLEND);
+                accumulatedMips = static_cast<int>(m_mipBuffers.size());
+            }
+
+            return accumulatedMips;
         }
 
         void BloomEffect::DrawGui()
@@ -137,7 +252,7 @@ namespace core
 
                     if (m_debugMode == BloomDebugMode::ThresholdOnly)
                     {
-                        ImGui::TextWrapped("Showing only pixels above threshold (bright pass)");
+                        ImGui::TextWrapped("Showing only pixels above threshold (prefiltered half resolution mip)");
                     }
                     else if (m_debugMode == BloomDebugMode::BlurOnly)
                     {
@@ -154,16 +269,71 @@ namespace core
                     ImGui::SetTooltip("Pixels brighter than this value will bloom");
                 }
 
+                ImGui::SliderFloat("Soft Knee", &m_softKnee, 0.0f, 1.0f, "%.2f");
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("Fraction of the threshold over which pixels fade into the bloom");
+                }
+
                 ImGui::SliderFloat("Intensity", &m_intensity, 0.0f, 5.0f, "%.2f");
                 if (ImGui::IsItemHovered())
                 {
                     ImGui::SetTooltip("Multiplier for the bloom effect strength");
                 }
 
-                ImGui::SliderInt("Blur Passes", &m_blurAmount, 1, 10);
-                if (ImGui::IsItemHovered())
+                const char* blurModes[] = { "Mip Chain", "Separable Gaussian" };
+                int currentBlurMode = static_cast<int>(m_blurMode);
+                if (ImGui::Combo("Blur", &currentBlurMode, blurModes, IM_ARRAYSIZE(blurModes)))
+                {
+                    m_blurMode = static_cast<BloomBlurMode>(currentBlurMode);
+                }
+
+                if (m_blurMode == BloomBlurMode::MipChain)
                 {
-                    ImGui::SetTooltip("More passes = smoother blur but slower");
+                    ImGui::SliderInt("Mip Levels", &m_mipCount, 1, MAX_MIPS);
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("More levels = wider bloom, each level is a quarter of the previous one");
+                    }
+
+                    ImGui::SliderFloat("Filter Radius", &m_filterRadius, 0.5f, 3.0f, "%.2f");
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("Radius of the upsample tent filter, in texels");
+                    }
+                }
+                else
+                {
+                    ImGui::SliderInt("Radius", &m_blurSettings.radius, 1, BlurKernel::MAX_RADIUS);
+                    ImGui::SliderFloat("Sigma", &m_blurSettings.sigma, 0.0f, 8.0f, "%.2f");
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("Standard deviation in texels, 0 = radius / 2");
+                    }
+
+                    ImGui::SliderFloat("Resolution Scale", &m_blurSettings.resolutionScale, 0.25f, 1.0f, "%.2f");
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("Size of the blurred target relative to the half resolution prefilter");
+                    }
+
+                    ImGui::SliderInt("Iterations", &m_blurSettings.iterations, 1, 4);
+
+                    bool compute = m_blurSettings.path == SeparableBlur::Path::Compute;
+                    if (ImGui::Checkbox("Compute Shader", &compute))
+                    {
+                        m_blurSettings.path = compute ? SeparableBlur::Path::Compute : SeparableBlur::Path::Fragment;
+                    }
+                    if (compute && !m_blur->HasComputePath())
+                    {
+                        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Compute program failed, using fragment passes");
+                    }
+
+                    const BlurKernel& kernel = m_blur->GetKernel();
+                    if (compute)
+                        ImGui::Text("Taps per pass: %d, read from shared memory", 2 * kernel.radius + 1);
+                    else
+                        ImGui::Text("Fetches per pass: %d (%d unmerged)", kernel.GetFetchCount(), 2 * kernel.radius + 1);
                 }
 
                 // Info display
@@ -171,11 +341,11 @@ namespace core
                 ImGui::Text("Total Passes: %d", GetPassCount());
                 if (m_debugMode == BloomDebugMode::ThresholdOnly)
                 {
-                    ImGui::Text("(Show the BrightPixels texture directly to screen)");
+                    ImGui::Text("(Show the thresholded half resolution mip directly to screen)");
                 }
                 else if (m_debugMode == BloomDebugMode::BlurOnly)
                 {
-                    ImGui::Text("(Dont Composite with the final scene. Shows only the blurring of the BrightPixels)");
+                    ImGui::Text("(Dont Composite with the final scene. Shows only the upsampled mip chain)");
                 }
 
                 ImGui::Unindent();
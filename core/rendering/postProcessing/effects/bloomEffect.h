@@ -1,8 +1,10 @@
 #pragma once
 
 #include "../../../property.h"
+#include "../../separableBlur.h"
 #include "../postProcessingEffectBase.h"
 #include <memory>
+#include <vector>
 
 namespace core
 {
@@ -17,35 +19,99 @@ namespace core
         enum class BloomDebugMode
         {
             None,           // Normal bloom rendering
-            ThresholdOnly,  // Show only the bright pass (threshold) result
+            ThresholdOnly,  // Show only the prefiltered (thresholded) half resolution mip
             BlurOnly        // Show only the blur result without combining
         };
 
+        enum class BloomBlurMode
+        {
+            MipChain,           // Progressive downsamples and tent upsamples
+            SeparableGaussian   // Gaussian blur of the prefiltered mip through SeparableBlur
+        };
+
+        /// <summary>
+        /// Mip chain bloom. A prefilter applies the brightness threshold while downsampling the scene
+        /// to half resolution, 13-tap downsamples build the rest of the chain, and 3x3 tent upsamples
+        /// add every mip onto the next larger one. The top mip is composited over the scene.
+        /// The separable Gaussian mode replaces the mip chain with a SeparableBlur of the prefiltered mip.
+        /// </summary>
         class BloomEffect : public PostProcessingEffectBase
         {
         public:
+            static constexpr int MAX_MIPS = 8;
+
             BloomEffect(std::weak_ptr<PostProcessingManager> manager);
 
             int GetPassCount() const override;
             void Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height) override;
+
+            /// <summary>
+            /// Adds the bloom pass with its mip chain as transients of the frame graph.
+            /// </summary>
+            void AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height) override;
+
+            /// <summary>
+            /// Adds the bloom passes and runs the composite as the BloomCompositeStage of a fused pass.
+            /// </summary>
+            bool AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage) override;
             void DrawGui() override;
 
         private:
-            std::shared_ptr<Material> m_blurMaterial;
-            std::shared_ptr<Material> m_brightPassMaterial;
+            /// <summary>
+            /// Gets the number of mips used at the given size, at most m_mipCount and stopping before a mip gets smaller than 2 pixels.
+            /// </summary>
+            int GetMipCount(int width, int height) const;
+
+            /// <summary>
+            /// Adds every bloom pass except the composite.
+            /// </summary>
+            /// <param name="intensity">Receives the composite intensity, averaged over the accumulated mips.</param>
+            /// <returns>The target holding the bloom to composite over the scene.</returns>
+            FrameGraph::Handle AddBloomPasses(FrameGraph& graph, FrameGraph::Handle input, int width, int height, float& intensity);
+
+            /// <summary>
+            /// Prefilters the scene into m_mipBuffers and blurs it down and back up the chain.
+            /// </summary>
+            /// <returns>The number of mips summed into the half resolution mip.</returns>
+            int BuildMipChain(const FrameBuffer& scene);
+
+            /// <summary>
+            /// Sets the bloom texture and composite parameters, shared by the composite shader and the fused pass.
+            /// </summary>
+            void SetCompositeUniforms(Material& material, const FrameBuffer& bloom, float intensity, int bloomUnit) const;
+
+            /// <summary>
+            /// Applies the threshold while downsampling the scene into the half resolution target.
+            /// </summary>
+            void Prefilter(const FrameBuffer& scene, FrameBuffer& target);
+
+            /// <summary>
+            /// Adds the bloom over the scene into the output, or only the bloom in the debug modes.
+            /// </summary>
+            void Composite(const FrameBuffer& scene, const FrameBuffer& bloom, FrameBuffer& outputFBO, int width, int height, float intensity);
+
+            FrameGraph::Handle AddSeparableGaussianPasses(FrameGraph& graph, FrameGraph::Handle input, int width, int height);
+
+            std::shared_ptr<Material> m_downsampleMaterial;
+            std::shared_ptr<Material> m_upsampleMaterial;
             std::shared_ptr<Material> m_compositeMaterial;
-            std::shared_ptr<Shader> m_brightPassShader;
-            std::shared_ptr<Shader> m_blurShader;
+            std::shared_ptr<Shader> m_downsampleShader;
+            std::shared_ptr<Shader> m_upsampleShader;
             std::shared_ptr<Shader> m_compositeShader;
 
-            
-            int m_blurAmount = 5;
-            Property<float> m_bloomThreshold = 0.2f;
+            int m_mipCount = 6;
+            float m_bloomThreshold = 1.0f;
+            float m_softKnee = 0.5f;        // Fraction of the threshold over which the bloom fades in
+            float m_filterRadius = 1.0f;    // Upsample tent radius in texels
             float m_intensity = 1.0f;
             BloomDebugMode m_debugMode = BloomDebugMode::None;
+            BloomBlurMode m_blurMode = BloomBlurMode::MipChain;
+
+            std::unique_ptr<SeparableBlur> m_blur;
+            SeparableBlur::Settings m_blurSettings{ 8, 0.0f, 0.5f, 2, SeparableBlur::Path::Fragment };
 
-            FrameBuffer tempFBO_1;
-            FrameBuffer tempFBO_2;
+            // Mip chain, half resolution first, resolved from the frame graph before Apply()
+            std::vector<FrameBuffer*> m_mipBuffers;
         };
     } // namespace postProcessing
 } // namespace core
\ No newline at end of file
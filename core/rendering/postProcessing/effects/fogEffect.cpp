@@ -30,18 +30,8 @@ namespace core
                     // Set color texture from previous effect
                     m_material->SetTextureID("inputTexture", inputFBO.GetColorAttachment(), 0);
                     
-                    // Set depth texture from original scene
-                    m_material->SetTextureID("depthTexture", depthTexture, 1);
-                    
-                    // Set fog parameters
-                    m_material->SetVec3("fogColor", m_fogColor.Get());
-                    m_material->SetFloat("fogDensity", m_fogDensity.Get());
-                    m_material->SetFloat("fogStart", m_fogStart.Get());
-                    m_material->SetFloat("fogEnd", m_fogEnd.Get());
-                    m_material->SetInt("fogMode", static_cast<int>(m_fogMode.Get()));
-                    m_material->SetInt("debugMode", static_cast<int>(m_debugMode.Get()));
-                    m_material->SetFloat("nearPlane", m_nearPlane);
-                    m_material->SetFloat("farPlane", m_farPlane);
+                    // Depth texture from original scene and the fog parameters
+                    SetUniforms(*m_material, depthTexture, 1);
                     
                     m_material->Use();
                     RenderQuad(width, height);
@@ -49,6 +39,49 @@ namespace core
             }
         }
         
+        void FogEffect::AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height)
+        {
+            auto manager = m_manager.lock();
+            FrameGraph::Handle sceneTarget = manager ? manager->GetSceneTarget() : FrameGraph::INVALID_HANDLE;
+
+            graph.AddPass(GetName(),
+                [input, output, sceneTarget](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    if (sceneTarget != FrameGraph::INVALID_HANDLE && sceneTarget != input)
+                        builder.Read(sceneTarget);
+                    builder.Write(output);
+                },
+                [this, input, output, width, height](const FrameGraph::Resources& resources)
+                {
+                    Apply(resources.Get(input), resources.Get(output), width, height);
+                });
+        }
+
+        bool FogEffect::AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage)
+        {
+            stage.function = "FogStage";
+            stage.reads.push_back(sceneTarget);
+            stage.setUniforms = [this, sceneTarget](Material& material, const FrameGraph::Resources& resources, int& textureUnit)
+                {
+                    SetUniforms(material, resources.Get(sceneTarget).GetDepthAttachment(), textureUnit++);
+                };
+            return true;
+        }
+
+        void FogEffect::SetUniforms(Material& material, GLuint depthTexture, int depthUnit) const
+        {
+            material.SetTextureID("depthTexture", depthTexture, depthUnit);
+            material.SetVec3("fogColor", m_fogColor.Get());
+            material.SetFloat("fogDensity", m_fogDensity.Get());
+            material.SetFloat("fogStart", m_fogStart.Get());
+            material.SetFloat("fogEnd", m_fogEnd.Get());
+            material.SetInt("fogMode", static_cast<int>(m_fogMode.Get()));
+            material.SetInt("fogDebugMode", static_cast<int>(m_debugMode.Get()));
+            material.SetFloat("fogNearPlane", m_nearPlane);
+            material.SetFloat("fogFarPlane", m_farPlane);
+        }
+
         void FogEffect::DrawGui()
         {
             ImGui::PushID(this);
@@ -60,6 +60,16 @@ namespace core
             /// <param name="height">Viewport height in pixels.</param>
             void Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height) override;
 
+            /// <summary>
+            /// Adds the fog pass, which also reads the scene target for its depth.
+            /// </summary>
+            void AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height) override;
+
+            /// <summary>
+            /// Runs the fog as the FogStage of a fused pass, reading the depth of the scene target.
+            /// </summary>
+            bool AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage) override;
+
             /// <summary>
             /// Renders the ImGui interface for adjusting fog parameters.
             /// Provides controls for fog color, density, range, mode selection, and debug visualization.
@@ -67,6 +77,11 @@ namespace core
             void DrawGui() override;
 
         private:
+            /// <summary>
+            /// Sets the depth texture and the fog parameters, shared by the fog shader and the fused pass.
+            /// </summary>
+            void SetUniforms(Material& material, GLuint depthTexture, int depthUnit) const;
+
             /// <summary>RGB color of the fog. Default is light blue-grey (0.5, 0.6, 0.7).</summary>
             Property<glm::vec3> m_fogColor = glm::vec3(0.5f, 0.6f, 0.7f);
             
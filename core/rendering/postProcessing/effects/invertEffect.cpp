@@ -20,6 +20,13 @@ namespace core
             PostProcessingEffectBase::Apply(inputFBO, outputFBO, width, height);
         }
 
+        bool InvertEffect::AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage)
+        {
+            stage.function = "InvertStage";
+            stage.setUniforms = [](Material&, const FrameGraph::Resources&, int&) {};
+            return true;
+        }
+
         void InvertEffect::DrawGui()
         {
             ImGui::Text("Inverts the colors of the input texture.");
@@ -33,6 +33,11 @@ namespace core
             /// <param name="width">The width of the viewport in pixels.</param>
             /// <param name="height">The height of the viewport in pixels.</param>
             void Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height) override;
+
+            /// <summary>
+            /// Runs the inversion as the InvertStage of a fused pass, it has no uniforms.
+            /// </summary>
+            bool AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage) override;
             
             /// <summary>
             /// Renders the ImGui interface for this effect, allowing runtime configuration and toggling.
@@ -1,5 +1,6 @@
 #include "../../material.h"
 #include "../frameBuffer.h"
+#include "../renderStats.h"
 #include "postProcessingEffectBase.h"
 #include "postProcessingManager.h"
 
@@ -41,6 +42,20 @@ namespace core
             }
         }
 
+        void PostProcessingEffectBase::AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height)
+        {
+            graph.AddPass(m_name,
+                [input, output](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    builder.Write(output);
+                },
+                [this, input, output, width, height](const FrameGraph::Resources& resources)
+                {
+                    Apply(resources.Get(input), resources.Get(output), width, height);
+                });
+        }
+
         static GLuint quadVAO = 0;
         static GLuint quadVBO = 0;
 
@@ -70,6 +85,7 @@ namespace core
 
             glBindVertexArray(quadVAO);
             glDrawArrays(GL_TRIANGLES, 0, 6);
+            RenderStats::RecordDraw(GL_TRIANGLES, 6);
             glBindVertexArray(0);
         }
     } // namespace postProcessing
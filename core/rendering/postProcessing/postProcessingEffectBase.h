@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../../property.h"
+#include "../frameGraph.h"
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace core
 {
@@ -14,6 +17,17 @@ namespace core
     {
         class PostProcessingManager;
 
+        /// <summary>
+        /// The per-pixel part of an effect, run as one stage of a fused pass.
+        /// The function is declared by a stage file included in postProcessing/fused.frag.
+        /// </summary>
+        struct FusedStage
+        {
+            std::string function;                   // GLSL "vec4 function(vec4 color, vec2 screenUV)"
+            std::vector<FrameGraph::Handle> reads;  // Targets sampled besides the chain input
+            std::function<void(Material& material, const FrameGraph::Resources& resources, int& textureUnit)> setUniforms;
+        };
+
         /// <summary>
         /// Base class for all post-processing effects in the rendering pipeline.
         /// Provides common functionality for managing materials, enable states, and applying effects.
@@ -46,6 +60,32 @@ namespace core
             /// <param name="height">The height of the rendering viewport in pixels.</param>
             virtual void Apply(FrameBuffer& inputFBO, FrameBuffer& outputFBO, const int width, const int height);
 
+            /// <summary>
+            /// Adds the passes of this effect to the frame graph. The default adds a single pass reading
+            /// the input, writing the output and calling Apply(). Override this when the effect needs
+            /// intermediate targets or reads other targets than its input.
+            /// </summary>
+            /// <param name="graph">The frame graph being built for this frame.</param>
+            /// <param name="input">The target to read, the scene or the previous effect's output.</param>
+            /// <param name="output">The target to write.</param>
+            /// <param name="width">The width of the rendering viewport in pixels.</param>
+            /// <param name="height">The height of the rendering viewport in pixels.</param>
+            virtual void AddPasses(FrameGraph& graph, FrameGraph::Handle input, FrameGraph::Handle output, const int width, const int height);
+
+            /// <summary>
+            /// Describes the effect as a stage of a fused pass, which the manager runs instead of AddPasses()
+            /// for runs of per-pixel effects. Effects that need their neighbourhood return false, the default.
+            /// Passes producing the textures the stage samples (the bloom mip chain) are added here, they may
+            /// only read the scene target.
+            /// </summary>
+            /// <param name="graph">The frame graph being built for this frame.</param>
+            /// <param name="sceneTarget">The imported target containing the scene render, color and depth.</param>
+            /// <param name="width">The width of the rendering viewport in pixels.</param>
+            /// <param name="height">The height of the rendering viewport in pixels.</param>
+            /// <param name="stage">Receives the stage function, the extra targets it reads and its uniform setter.</param>
+            /// <returns>True if the effect can run fused.</returns>
+            virtual bool AddFusedStage(FrameGraph& graph, FrameGraph::Handle sceneTarget, const int width, const int height, FusedStage& stage) { return false; }
+
             /// <summary>
             /// Draws the GUI elements for this post-processing effect.
             /// Override this method in derived classes to provide custom ImGui controls for effect parameters.
@@ -70,8 +110,12 @@ namespace core
             bool RequiresSceneRender() const { return m_requireSceneRender; }
 #pragma endregion GetterMethods
 
+            /// <summary>
+            /// Draws the full screen quad used by every post-processing pass.
+            /// </summary>
+            static void RenderQuad(const unsigned int width, const unsigned int height);
+
         protected:
-            void RenderQuad(const unsigned int width, const unsigned int height);
 
             /// <summary>
             /// The shader used by the material.
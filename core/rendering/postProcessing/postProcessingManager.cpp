@@ -1,6 +1,9 @@
 #pragma warning(disable: 5246) // Suppress transitive include warning
 
+#include "../../material.h"
+#include "../../profiler.h"
 #include "../frameBuffer.h"
+#include "../shader.h"
 #include "effects/postProcessingEffects.h"
 #include "postProcessingEffectBase.h"
 #include "postProcessingManager.h"
@@ -14,78 +17,145 @@ namespace core
     {
         PostProcessingManager::PostProcessingManager()
         {
-            tempFBO_1 = FrameBuffer("postProcessFBO_1", FrameBufferSpecifications{ 100, 100, AttachmentType::COLOR_ONLY});
-            tempFBO_2 = FrameBuffer("postProcessFBO_2", FrameBufferSpecifications{ 100, 100, AttachmentType::COLOR_ONLY });
         }
 
-        void PostProcessingManager::ProcessStack(FrameBuffer& inputBuffer, FrameBuffer& outputBuffer, const unsigned int width, const unsigned int height)
+        void PostProcessingManager::AddPasses(FrameGraph& graph, FrameGraph::Handle sceneTarget, FrameGraph::Handle outputTarget, const unsigned int width, const unsigned int height)
         {
-            m_sceneInputBuffer = &inputBuffer;
-            tempFBO_1.Resize(width, height);
-            tempFBO_2.Resize(width, height);
-
-            FrameBuffer* currentInput = &inputBuffer;
-            FrameBuffer* currentOutput = &tempFBO_1;
-
-            //printf("[POSTPROCESSMANAGER] Skipped %zu/%zu effects.\n", m_effects.size() - m_enabledEffects.size(), m_effects.size());
+            FINALENGINE_PROFILE_ZONE("PostProcessingManager::AddPasses");
+            m_sceneInputBuffer = graph.GetImported(sceneTarget);
+            m_sceneTarget = sceneTarget;
+            m_fusedPassesSaved = 0;
 
             if (m_enabledEffects.empty()) // If all effects were skipped, copy input to output directly using blit
             {
-                inputBuffer.BindRead();
-                outputBuffer.BindDraw();
-
-                glReadBuffer(GL_COLOR_ATTACHMENT0);  
-                glDrawBuffer(GL_COLOR_ATTACHMENT0);  
-
-                glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                graph.AddPass("PostProcessCopy",
+                    [sceneTarget, outputTarget](FrameGraph::Builder& builder)
+                    {
+                        builder.Read(sceneTarget);
+                        builder.Write(outputTarget);
+                    },
+                    [sceneTarget, outputTarget, width, height](const FrameGraph::Resources& resources)
+                    {
+                        resources.Get(sceneTarget).BindRead();
+                        resources.Get(outputTarget).BindDraw();
+
+                        glReadBuffer(GL_COLOR_ATTACHMENT0);
+                        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+
+                        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    });
                 return;
             }
 
-            // Store the last processed output (for chaining effects)
-            FrameBuffer* lastProcessedOutput = nullptr;
+            // The last processed output, for chaining effects
+            FrameGraph::Handle lastProcessedOutput = FrameGraph::INVALID_HANDLE;
 
-            for (size_t i = 0; i < m_enabledEffects.size(); i++)
+            size_t i = 0;
+            while (i < m_enabledEffects.size())
             {
                 auto& effect = m_enabledEffects[i];
-                bool isLastEffect = (i == m_enabledEffects.size() - 1);
-                
-                if (isLastEffect)
-                    currentOutput = &outputBuffer;
-
-                // Determine which input to use
-                FrameBuffer* effectInput;
-                if (effect->RequiresSceneRender()) 
-                    effectInput = m_sceneInputBuffer; // This effect needs the original scene input
+
+                // Effects needing the original scene input restart the chain. The graph culls
+                // whatever earlier effect output ends up unread because of that.
+                FrameGraph::Handle effectInput = effect->RequiresSceneRender() || lastProcessedOutput == FrameGraph::INVALID_HANDLE
+                    ? sceneTarget
+                    : lastProcessedOutput;
+
+                // Collect the run of per-pixel effects starting here. An effect restarting the chain
+                // starts a run of its own, since its input is the scene and not the running color.
+                std::vector<FusedStage> stages;
+                size_t runEnd = i;
+                while (m_fusion && runEnd < m_enabledEffects.size() && (runEnd == i || !m_enabledEffects[runEnd]->RequiresSceneRender()))
+                {
+                    FusedStage stage;
+                    if (!m_enabledEffects[runEnd]->AddFusedStage(graph, sceneTarget, width, height, stage))
+                        break;
+                    stages.push_back(std::move(stage));
+                    runEnd++;
+                }
+
+                size_t next = stages.empty() ? i + 1 : runEnd;
+                bool isLastEffect = (next == m_enabledEffects.size());
+
+                FrameGraph::Handle effectOutput = isLastEffect
+                    ? outputTarget
+                    : graph.CreateTarget(effect->GetName() + "Output", FrameBufferSpecifications{ width, height, AttachmentType::COLOR_ONLY });
+
+                if (stages.empty())
+                {
+                    effect->AddPasses(graph, effectInput, effectOutput, width, height);
+                }
                 else
-                    // This effect chains from the previous effect
-                    // If this is the first effect, or the previous effect used scene input, use scene input
-                    effectInput = (i == 0 || lastProcessedOutput == nullptr) ? m_sceneInputBuffer : lastProcessedOutput;
-
-                /*printf("[POSTPROCESS MANAGER] Applying effect: %s (Passes: %d)\n== Parameters ==\nInput FBO name: %s\nOutput FBO name: %s\nWidth: %d\nHeight: %d\nRequires Scene Render: %s\n", 
-                       effect->GetName().c_str(), 
-                       effect->GetPassCount(),
-                       effectInput->GetName().c_str(),
-                       currentOutput->GetName().c_str(),
-                       width,
-                       height,
-                       effect->RequiresSceneRender() ? "true" : "false"
-                );*/
-
-                effect->Apply(*effectInput, *currentOutput, width, height);
-                
-                // Update the last processed output for the next effect to potentially use
-                lastProcessedOutput = currentOutput;
-                
-                // For next iteration: if current output is tempFBO, switch to inputBuffer for next output
-                // Otherwise keep ping-ponging
-                if (!isLastEffect)
                 {
-                    currentInput = currentOutput;
-                    currentOutput = (currentOutput == &tempFBO_1) ? &tempFBO_2 : &tempFBO_1;
+                    AddFusedPass(graph, stages, effectInput, effectOutput, width, height);
+                    m_fusedPassesSaved += static_cast<int>(stages.size()) - 1;
                 }
+
+                lastProcessedOutput = effectOutput;
+                i = next;
             }
-            printf("[POSTPROCESS MANAGER] Finished processing effects.\n\n");
+        }
+
+        PostProcessingManager::FusedProgram& PostProcessingManager::GetFusedProgram(const std::vector<FusedStage>& stages)
+        {
+            std::string signature;
+            for (const auto& stage : stages)
+                signature += stage.function + ";";
+
+            auto it = m_fusedPrograms.find(signature);
+            if (it != m_fusedPrograms.end())
+                return it->second;
+
+            // fused.frag includes every stage file, the define picks and orders the calls
+            std::string calls;
+            for (const auto& stage : stages)
+                calls += "color = " + stage.function + "(color, screenUV); ";
+
+            printf("[POSTPROCESSING] Compiling fused pass: %s\n", signature.c_str());
+            FusedProgram program;
+            program.shader = std::make_shared<Shader>("assets/shaders/postProcessing/postProcess.vert", "assets/shaders/postProcessing/fused.frag",
+                                                      ShaderPreprocessor::Defines{ { "FUSED_STAGES", calls } });
+            program.material = std::make_shared<Material>(program.shader->ID);
+            return m_fusedPrograms.emplace(signature, std::move(program)).first->second;
+        }
+
+        void PostProcessingManager::AddFusedPass(FrameGraph& graph, const std::vector<FusedStage>& stages, FrameGraph::Handle input, FrameGraph::Handle output, const unsigned int width, const unsigned int height)
+        {
+            std::string passName = "Fused";
+            for (const auto& stage : stages)
+                passName += "_" + stage.function;
+
+            std::shared_ptr<Material> material = GetFusedProgram(stages).material;
+
+            graph.AddPass(passName,
+                [&stages, input, output](FrameGraph::Builder& builder)
+                {
+                    builder.Read(input);
+                    for (const auto& stage : stages)
+                    {
+                        for (FrameGraph::Handle read : stage.reads)
+                        {
+                            if (read != input)
+                                builder.Read(read);
+                        }
+                    }
+                    builder.Write(output);
+                },
+                [stages, material, input, output, width, height](const FrameGraph::Resources& resources)
+                {
+                    FrameBuffer& outputFBO = resources.Get(output);
+                    outputFBO.Bind();
+                    glViewport(0, 0, width, height);
+
+                    material->SetTextureID("inputTexture", resources.Get(input).GetColorAttachment(), 0);
+                    int textureUnit = 1;
+                    for (const auto& stage : stages)
+                        stage.setUniforms(*material, resources, textureUnit);
+                    material->Use();
+
+                    PostProcessingEffectBase::RenderQuad(width, height);
+                });
         }
 
         bool PostProcessingManager::AddEffect(const std::shared_ptr<PostProcessingEffectBase> effect)
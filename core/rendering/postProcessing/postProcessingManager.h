@@ -1,14 +1,21 @@
 #pragma once
 #include "../frameBuffer.h"
+#include "../frameGraph.h"
 #include <glad/glad.h>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace core
 {
+    class Material;
+    class Shader;
+
     namespace postProcessing
     {
         class PostProcessingEffectBase;
+        struct FusedStage;
 
         /// <summary>
         /// Manages the post-processing effect stack for rendering.
@@ -29,13 +36,16 @@ namespace core
             ~PostProcessingManager() = default;
 
             /// <summary>
-            /// Processes the entire effect stack, applying all enabled effects sequentially.
+            /// Adds the enabled effects to the frame graph, chained from the scene target to the output target.
+            /// Every effect except the last writes a transient target, which the graph can alias.
+            /// With fusion enabled, every run of consecutive per-pixel effects becomes a single pass.
             /// </summary>
-            /// <param name="inputBuffer">The source framebuffer containing the initial render output.</param>
-            /// <param name="outputBuffer">The destination framebuffer where the final processed output is written.</param>
+            /// <param name="graph">The frame graph being built for this frame.</param>
+            /// <param name="sceneTarget">The imported target containing the scene render, color and depth.</param>
+            /// <param name="outputTarget">The imported target where the final processed output is written.</param>
             /// <param name="width">The width of the framebuffers in pixels.</param>
             /// <param name="height">The height of the framebuffers in pixels.</param>
-            void ProcessStack(FrameBuffer& inputBuffer, core::FrameBuffer& outputBuffer, const unsigned int width, const unsigned int height);
+            void AddPasses(FrameGraph& graph, FrameGraph::Handle sceneTarget, FrameGraph::Handle outputTarget, const unsigned int width, const unsigned int height);
 
             /// <summary>
             /// Adds a new post-processing effect to the manager.
@@ -77,7 +87,47 @@ namespace core
             {
                 return m_sceneInputBuffer ? m_sceneInputBuffer->GetDepthAttachment() : 0;
             }
+
+            /// <summary>
+            /// Gets the frame graph handle of the scene render, so effects reading its depth can declare it.
+            /// </summary>
+            FrameGraph::Handle GetSceneTarget() const { return m_sceneTarget; }
+
+            /// <summary>
+            /// Enables fusing runs of per-pixel effects into one generated pass. On by default.
+            /// </summary>
+            void SetFusion(bool enabled) { m_fusion = enabled; }
+            bool GetFusion() const { return m_fusion; }
+
+            /// <summary>
+            /// Gets the number of fused programs compiled so far, one per distinct effect chain.
+            /// </summary>
+            size_t GetFusedProgramCount() const { return m_fusedPrograms.size(); }
+
+            /// <summary>
+            /// Gets the number of full screen effect passes fusion saved in the last frame.
+            /// </summary>
+            int GetFusedPassesSaved() const { return m_fusedPassesSaved; }
         private:
+            /// <summary>
+            /// A fused.frag program generated for one chain of stages.
+            /// </summary>
+            struct FusedProgram
+            {
+                std::shared_ptr<Shader> shader;
+                std::shared_ptr<Material> material;
+            };
+
+            /// <summary>
+            /// Gets the program running the stages in order, compiling it the first time the chain is seen.
+            /// </summary>
+            FusedProgram& GetFusedProgram(const std::vector<FusedStage>& stages);
+
+            /// <summary>
+            /// Adds a single pass running every stage on the input, in order.
+            /// </summary>
+            void AddFusedPass(FrameGraph& graph, const std::vector<FusedStage>& stages, FrameGraph::Handle input, FrameGraph::Handle output, const unsigned int width, const unsigned int height);
+
             /// <summary>
             /// Sorts the enabled effects list based on their execution priority.
             /// Ensures effects are applied in the correct order during processing.
@@ -85,15 +135,15 @@ namespace core
             void SortEnabledEffects();
 
             FrameBuffer* m_sceneInputBuffer = nullptr;
+            FrameGraph::Handle m_sceneTarget = FrameGraph::INVALID_HANDLE;
+
+            bool m_fusion = true;
+            int m_fusedPassesSaved = 0;
 
             /// <summary>
-            /// Temporary framebuffer used for ping-pong rendering between effects.
-            /// </summary>
-            core::FrameBuffer tempFBO_1;
-            /// <summary>
-            /// Temporary framebuffer used for ping-pong rendering between effects.
+            /// Fused programs keyed by their chain signature, the stage functions in order.
             /// </summary>
-            core::FrameBuffer tempFBO_2;
+            std::unordered_map<std::string, FusedProgram> m_fusedPrograms;
 
             /// <summary>
             /// Complete list of all registered post-processing effects.
@@ -0,0 +1,26 @@
+#include "renderStats.h"
+
+namespace core
+{
+    RenderStats::Counters RenderStats::s_counters;
+
+    void RenderStats::RecordDraw(const GLenum drawMode, const GLsizei vertexCount, const GLsizei instanceCount)
+    {
+        std::uint64_t triangles = 0;
+        switch (drawMode)
+        {
+        case GL_TRIANGLES:
+            triangles = vertexCount / 3;
+            break;
+        case GL_TRIANGLE_STRIP:
+        case GL_TRIANGLE_FAN:
+            triangles = vertexCount > 2 ? vertexCount - 2 : 0;
+            break;
+        default:
+            break;
+        }
+
+        s_counters.drawCalls++;
+        s_counters.triangles += triangles * instanceCount;
+    }
+} // namespace core
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+
+namespace core
+{
+    /// <summary>
+    /// Counts the draw calls and triangles submitted by the engine.
+    /// The counters keep growing until Reset(), so callers decide what span they measure.
+    /// </summary>
+    class RenderStats
+    {
+    public:
+        struct Counters
+        {
+            std::uint64_t drawCalls = 0;
+            std::uint64_t triangles = 0;
+        };
+
+        /// <summary>
+        /// Records one draw call.
+        /// </summary>
+        /// <param name="drawMode">Primitive type of the draw.</param>
+        /// <param name="vertexCount">Vertices (or indices) drawn per instance.</param>
+        /// <param name="instanceCount">Number of instances drawn.</param>
+        static void RecordDraw(GLenum drawMode, GLsizei vertexCount, GLsizei instanceCount = 1);
+
+        static const Counters& Get() { return s_counters; }
+        static void Reset() { s_counters = Counters(); }
+
+    private:
+        static Counters s_counters;
+    };
+} // namespace core
@@ -0,0 +1,64 @@
+#include "renderTargetPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace core
+{
+    std::uint64_t RenderTargetPool::MakeKey(const FrameBufferSpecifications& specs)
+    {
+        std::uint64_t key = static_cast<std::uint64_t>(specs.attachmentType);
+        key |= static_cast<std::uint64_t>(specs.numColorAttachments & 0xFF) << 8;
+        return key;
+    }
+
+    FrameBuffer& RenderTargetPool::Acquire(const FrameBufferSpecifications& specs)
+    {
+        const std::uint64_t key = MakeKey(specs);
+
+        // The smallest free allocation that holds the request, so large targets stay free for large requests
+        Entry* best = nullptr;
+        for (Entry& entry : m_entries)
+        {
+            if (entry.inUse || entry.key != key || !entry.target->FitsAllocation(specs.width, specs.height))
+                continue;
+
+            const FrameBuffer& target = *entry.target;
+            if (!best || target.GetAllocatedWidth() * target.GetAllocatedHeight() <
+                         best->target->GetAllocatedWidth() * best->target->GetAllocatedHeight())
+                best = &entry;
+        }
+
+        if (best)
+        {
+            best->inUse = true;
+            best->lastUsedFrame = m_frame;
+            best->target->Resize(specs.width, specs.height);
+            return *best->target;
+        }
+
+        Entry entry;
+        entry.target = std::make_unique<FrameBuffer>("pooledTarget_" + std::to_string(m_allocationCount++), specs);
+        entry.key = key;
+        entry.lastUsedFrame = m_frame;
+        entry.inUse = true;
+        m_entries.push_back(std::move(entry));
+        return *m_entries.back().target;
+    }
+
+    void RenderTargetPool::EndFrame()
+    {
+        for (Entry& entry : m_entries)
+            entry.inUse = false;
+
+        const size_t before = m_entries.size();
+        m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [this](const Entry& entry) {
+                            return m_frame - entry.lastUsedFrame > static_cast<std::uint64_t>(m_idleFrames);
+                        }), m_entries.end());
+
+        if (m_entries.size() != before)
+            printf("[RENDERTARGETPOOL] Freed %zu idle targets, %zu left.\n", before - m_entries.size(), m_entries.size());
+
+        m_frame++;
+    }
+} // namespace core
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "frameBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// Recycles framebuffers between frames, keyed by attachment layout.
+    /// <para>
+    /// Acquire() hands out the smallest free target with the requested layout whose allocation
+    /// holds the request (FrameBuffer::FitsAllocation), resized to the exact request without
+    /// touching GL memory. A changing render scale thus renders into the oversized targets it
+    /// already has; only a request that no free target fits allocates. Targets nobody acquired
+    /// for IdleFrames frames are freed in EndFrame(), so the sizes passed while dragging a window
+    /// do not pile up.
+    /// </para>
+    /// </summary>
+    class RenderTargetPool
+    {
+    public:
+        static constexpr int DEFAULT_IDLE_FRAMES = 120;
+
+        explicit RenderTargetPool(int idleFrames = DEFAULT_IDLE_FRAMES) : m_idleFrames(idleFrames) {}
+
+        RenderTargetPool(const RenderTargetPool&) = delete;
+        RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+        /// <summary>
+        /// Borrows a target for the rest of the frame.
+        /// </summary>
+        /// <param name="specs">Attachment layout and the size that will be rendered.</param>
+        FrameBuffer& Acquire(const FrameBufferSpecifications& specs);
+
+        /// <summary>
+        /// Returns every borrowed target to the pool and frees the ones idle for too long.
+        /// </summary>
+        void EndFrame();
+
+        size_t GetTargetCount() const { return m_entries.size(); }
+
+        /// <summary>
+        /// Gets the number of framebuffers created since the pool was made.
+        /// </summary>
+        size_t GetAllocationCount() const { return m_allocationCount; }
+
+    private:
+        struct Entry
+        {
+            std::unique_ptr<FrameBuffer> target;
+            std::uint64_t key = 0;
+            std::uint64_t lastUsedFrame = 0;
+            bool inUse = false;
+        };
+
+        static std::uint64_t MakeKey(const FrameBufferSpecifications& specs);
+
+        std::vector<Entry> m_entries;
+        std::uint64_t m_frame = 0;
+        size_t m_allocationCount = 0;
+        int m_idleFrames;
+    };
+} // namespace core
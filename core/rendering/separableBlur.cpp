@@ -0,0 +1,180 @@
+#include "renderStats.h"
+#include "separableBlur.h"
+#include "shaderPreprocessor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace core
+{
+    static GLuint CreateComputeProgram(const std::string& path, const ShaderPreprocessor::Defines& defines)
+    {
+        ShaderPreprocessor preprocessor;
+        ShaderSource source;
+        if (!preprocessor.Process(path, defines, source))
+        {
+            printf("[BLUR] Could not read compute shader %s\n", path.c_str());
+            return 0;
+        }
+
+        const char* code = source.code.c_str();
+        GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &code, nullptr);
+        glCompileShader(shader);
+
+        GLint success = GL_FALSE;
+        GLchar infoLog[1024];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shader, 1024, nullptr, infoLog);
+            printf("[BLUR] Compute shader compilation failed:\n%s\n", ShaderPreprocessor::MapErrorLog(infoLog, source).c_str());
+            glDeleteShader(shader);
+            return 0;
+        }
+
+        GLuint program = glCreateProgram();
+        glAttachShader(program, shader);
+        glLinkProgram(program);
+        glDeleteShader(shader);
+
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetProgramInfoLog(program, 1024, nullptr, infoLog);
+            printf("[BLUR] Compute program linking failed:\n%s\n", infoLog);
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    SeparableBlur::SeparableBlur()
+    {
+        const ShaderPreprocessor::Defines defines = {
+            { "MAX_RADIUS", std::to_string(BlurKernel::MAX_RADIUS) },
+            { "GROUP_SIZE", std::to_string(COMPUTE_GROUP_SIZE) }
+        };
+        m_fragmentShader = std::make_unique<Shader>("assets/shaders/blur/separableBlur.vert", "assets/shaders/blur/separableBlur.frag", defines);
+        m_computeProgram = CreateComputeProgram("assets/shaders/blur/separableBlur.comp", defines);
+        glGenVertexArrays(1, &m_emptyVAO);
+    }
+
+    SeparableBlur::~SeparableBlur()
+    {
+        if (m_computeProgram)
+            glDeleteProgram(m_computeProgram);
+        glDeleteVertexArrays(1, &m_emptyVAO);
+    }
+
+    FrameBufferSpecifications SeparableBlur::GetTargetSpecs(unsigned int width, unsigned int height, const Settings& settings)
+    {
+        float scale = std::clamp(settings.resolutionScale, 0.05f, 1.0f);
+        return FrameBufferSpecifications{
+            std::max(1u, static_cast<unsigned int>(std::lround(width * scale))),
+            std::max(1u, static_cast<unsigned int>(std::lround(height * scale))),
+            AttachmentType::COLOR_ONLY
+        };
+    }
+
+    void SeparableBlur::UpdateKernel(const Settings& settings)
+    {
+        if (m_kernel.radius != settings.radius || m_kernel.sigma != settings.sigma)
+        {
+            m_kernel = MakeGaussianKernel(settings.radius, settings.sigma);
+            // Keep the requested sigma so an unchanged setting does not rebuild every frame
+            m_kernel.sigma = settings.sigma;
+        }
+    }
+
+    void SeparableBlur::Blur(const FrameBuffer& source, FrameBuffer& temp, FrameBuffer& target, const Settings& settings)
+    {
+        UpdateKernel(settings);
+        bool compute = settings.path == Path::Compute && HasComputePath();
+
+        const FrameBuffer* input = &source;
+        for (int iteration = 0; iteration < std::max(1, settings.iterations); ++iteration)
+        {
+            if (compute)
+            {
+                ComputePass(*input, temp, true);
+                ComputePass(temp, target, false);
+            }
+            else
+            {
+                FragmentPass(*input, temp, true);
+                FragmentPass(temp, target, false);
+            }
+            input = &target;
+        }
+    }
+
+    FrameGraph::Handle SeparableBlur::AddPass(FrameGraph& graph, const std::string& name, FrameGraph::Handle source,
+                                              unsigned int width, unsigned int height, const Settings& settings)
+    {
+        FrameBufferSpecifications specs = GetTargetSpecs(width, height, settings);
+        FrameGraph::Handle temp = graph.CreateTarget(name + "Temp", specs);
+        FrameGraph::Handle target = graph.CreateTarget(name, specs);
+
+        graph.AddPass(name,
+            [source, temp, target](FrameGraph::Builder& builder)
+            {
+                builder.Read(source);
+                builder.Write(builder.Read(temp));
+                builder.Write(target);
+            },
+            [this, source, temp, target, settings](const FrameGraph::Resources& resources)
+            {
+                Blur(resources.Get(source), resources.Get(temp), resources.Get(target), settings);
+            });
+        return target;
+    }
+
+    void SeparableBlur::FragmentPass(const FrameBuffer& source, FrameBuffer& target, bool horizontal)
+    {
+        target.Bind();
+        glViewport(0, 0, target.GetWidth(), target.GetHeight());
+
+        m_fragmentShader->use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source.GetColorAttachment());
+        m_fragmentShader->setInt("sourceTexture", 0);
+        m_fragmentShader->setVec2("sourceUVScale", source.GetUVScaleX(), source.GetUVScaleY());
+
+        // One target texel along the blur direction, in source texture coordinates
+        if (horizontal)
+            m_fragmentShader->setVec2("texelStep", source.GetUVScaleX() / target.GetWidth(), 0.0f);
+        else
+            m_fragmentShader->setVec2("texelStep", 0.0f, source.GetUVScaleY() / target.GetHeight());
+
+        m_fragmentShader->setInt("tapCount", m_kernel.mergedCount);
+        glUniform1fv(glGetUniformLocation(m_fragmentShader->ID, "weights"), m_kernel.mergedCount, m_kernel.mergedWeights);
+        glUniform1fv(glGetUniformLocation(m_fragmentShader->ID, "offsets"), m_kernel.mergedCount, m_kernel.mergedOffsets);
+
+        glBindVertexArray(m_emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        RenderStats::RecordDraw(GL_TRIANGLES, 3);
+        glBindVertexArray(0);
+    }
+
+    void SeparableBlur::ComputePass(const FrameBuffer& source, FrameBuffer& target, bool horizontal)
+    {
+        glUseProgram(m_computeProgram);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source.GetColorAttachment());
+        glUniform1i(glGetUniformLocation(m_computeProgram, "sourceTexture"), 0);
+        glUniform2f(glGetUniformLocation(m_computeProgram, "sourceUVScale"), source.GetUVScaleX(), source.GetUVScaleY());
+        glUniform2i(glGetUniformLocation(m_computeProgram, "targetSize"), target.GetWidth(), target.GetHeight());
+        glUniform1i(glGetUniformLocation(m_computeProgram, "horizontal"), horizontal);
+        glUniform1i(glGetUniformLocation(m_computeProgram, "radius"), m_kernel.radius);
+        glUniform1fv(glGetUniformLocation(m_computeProgram, "weights"), m_kernel.radius + 1, m_kernel.weights);
+        glBindImageTexture(0, target.GetColorAttachment(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+        unsigned int lineLength = horizontal ? target.GetWidth() : target.GetHeight();
+        unsigned int lineCount = horizontal ? target.GetHeight() : target.GetWidth();
+        glDispatchCompute((lineLength + COMPUTE_GROUP_SIZE - 1) / COMPUTE_GROUP_SIZE, lineCount, 1);
+
+        // The next pass samples the result, or renders over it
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    }
+} // namespace core
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "blurKernel.h"
+#include "frameBuffer.h"
+#include "frameGraph.h"
+#include "shader.h"
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+
+namespace core
+{
+    /// <summary>
+    /// Reusable separable Gaussian blur: a horizontal then a vertical pass, repeated per iteration.
+    /// <para>
+    /// The fragment path samples with the bilinear merged taps of the kernel (see BlurKernel). The
+    /// compute path caches a line segment plus its apron in shared memory and applies the discrete
+    /// weights from there, one fetch per texel. Both sample the used part of the source, so the
+    /// blurred target can be smaller than the source (resolution scale).
+    /// </para>
+    /// </summary>
+    class SeparableBlur
+    {
+    public:
+        static constexpr int COMPUTE_GROUP_SIZE = 128;
+
+        enum class Path
+        {
+            Fragment,   // Full screen passes with merged bilinear taps
+            Compute     // Shared memory line cache, falls back to Fragment if the program failed
+        };
+
+        struct Settings
+        {
+            int radius = DEFAULT_BLUR_KERNEL.radius;    // Texels on each side, at the target resolution
+            float sigma = 0.0f;                         // Zero picks radius / 2
+            float resolutionScale = 1.0f;               // Size of the blurred target relative to the source
+            int iterations = 1;                         // Horizontal and vertical pass pairs
+            Path path = Path::Fragment;
+        };
+
+        SeparableBlur();
+        ~SeparableBlur();
+
+        SeparableBlur(const SeparableBlur&) = delete;
+        SeparableBlur& operator=(const SeparableBlur&) = delete;
+
+        /// <summary>
+        /// Gets the specification of the blurred target (and the temporary) for a source size.
+        /// </summary>
+        static FrameBufferSpecifications GetTargetSpecs(unsigned int width, unsigned int height, const Settings& settings);
+
+        /// <summary>
+        /// Blurs the used part of the source into the target, ping-ponging through temp.
+        /// Temp and target must both have the GetTargetSpecs() size.
+        /// </summary>
+        void Blur(const FrameBuffer& source, FrameBuffer& temp, FrameBuffer& target, const Settings& settings);
+
+        /// <summary>
+        /// Declares the blurred target and its temporary as frame graph transients and adds the blur pass.
+        /// </summary>
+        /// <returns>The handle of the blurred target.</returns>
+        FrameGraph::Handle AddPass(FrameGraph& graph, const std::string& name, FrameGraph::Handle source,
+                                   unsigned int width, unsigned int height, const Settings& settings);
+
+        /// <summary>
+        /// Gets the kernel used by the last Blur(), rebuilt whenever the radius or sigma change.
+        /// </summary>
+        const BlurKernel& GetKernel() const { return m_kernel; }
+
+        bool HasComputePath() const { return m_computeProgram != 0; }
+
+    private:
+        void UpdateKernel(const Settings& settings);
+        void FragmentPass(const FrameBuffer& source, FrameBuffer& target, bool horizontal);
+        void ComputePass(const FrameBuffer& source, FrameBuffer& target, bool horizontal);
+
+        BlurKernel m_kernel = DEFAULT_BLUR_KERNEL;
+        std::unique_ptr<Shader> m_fragmentShader;
+        GLuint m_computeProgram = 0;
+        GLuint m_emptyVAO = 0;          // The full screen triangle is generated from gl_VertexID
+    };
+} // namespace core
@@ -1,12 +1,19 @@
 #pragma once
 
-#include <fstream>
+#include "../profiler.h"
+#include "shaderCache.h"
+#include "shaderHotReloader.h"
+#include "shaderPreprocessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <glad/glad.h>
-#include <ios>
+#include <glm/glm.hpp>
 #include <iostream>
-#include <regex>
-#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace core
 {
@@ -20,70 +27,152 @@ namespace core
         /// <summary>
         /// The OpenGL shader program ID.
         /// </summary>
-        unsigned int ID;
+        unsigned int ID = 0;
 
         Shader() = default;
 
+        // Registered with the hot reloader by address, so shaders can be moved but not copied
+        Shader(const Shader&) = delete;
+        Shader& operator=(const Shader&) = delete;
+
+        Shader(Shader&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        Shader& operator=(Shader&& other) noexcept
+        {
+            if (this == &other) return *this;
+
+            ShaderHotReloader::Unregister(this);
+            ShaderHotReloader::Unregister(&other);
+
+            ID = other.ID;
+            m_vertexPath = std::move(other.m_vertexPath);
+            m_fragmentPath = std::move(other.m_fragmentPath);
+            m_geometryPath = std::move(other.m_geometryPath);
+            m_defines = std::move(other.m_defines);
+            m_dependencies = std::move(other.m_dependencies);
+            other.ID = 0;
+
+            if (!m_vertexPath.empty())
+                ShaderHotReloader::Register(this);
+            return *this;
+        }
+
+        ~Shader()
+        {
+            ShaderHotReloader::Unregister(this);
+        }
+
         /// <summary>
         /// Constructs a shader program from vertex and fragment shader files.
         /// </summary>
         /// <param name="vertexPath">Path to the vertex shader source file.</param>
         /// <param name="fragmentPath">Path to the fragment shader source file.</param>
-        Shader(const char* vertexPath, const char* fragmentPath)
+        /// <param name="defines">Optional defines injected after the #version directive of both stages.</param>
+        Shader(const char* vertexPath, const char* fragmentPath, const ShaderPreprocessor::Defines& defines = {})
+            : Shader(vertexPath, fragmentPath, nullptr, defines)
         {
-            // 1. retrieve the vertex/fragment source code from filePath
-            std::string vertexCode;
-            std::string fragmentCode;
-            std::ifstream vShaderFile;
-            std::ifstream fShaderFile;
-            // ensure ifstream objects can throw exceptions:
-            vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-            fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-            try
-            {
-                // open files
-                vShaderFile.open(vertexPath);
-                fShaderFile.open(fragmentPath);
-                std::stringstream vShaderStream, fShaderStream;
-                // read file's buffer contents into streams
-                vShaderStream << vShaderFile.rdbuf();
-                fShaderStream << fShaderFile.rdbuf();
-                // close file handlers
-                vShaderFile.close();
-                fShaderFile.close();
-                // convert stream into string
-                vertexCode = ProcessShaderIncludes(vShaderStream.str());
-                fragmentCode = ProcessShaderIncludes(fShaderStream.str());
-            }
-            catch (std::ifstream::failure& e)
-            {
-                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-            }
-            const char* vShaderCode = vertexCode.c_str();
-            const char* fShaderCode = fragmentCode.c_str();
-            // 2. compile shaders
+        }
+
+        /// <summary>
+        /// Constructs a shader program from vertex, fragment and geometry shader files.
+        /// </summary>
+        /// <param name="vertexPath">Path to the vertex shader source file.</param>
+        /// <param name="fragmentPath">Path to the fragment shader source file.</param>
+        /// <param name="geometryPath">Path to the geometry shader source file, or nullptr for none.</param>
+        /// <param name="defines">Defines injected after the #version directive of every stage.</param>
+        Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, const ShaderPreprocessor::Defines& defines)
+            : m_vertexPath(vertexPath), m_fragmentPath(fragmentPath), m_geometryPath(geometryPath ? geometryPath : ""), m_defines(defines)
+        {
+            FINALENGINE_PROFILE_ZONE("Shader::Build");
+            ShaderHotReloader::Register(this);
+
+            // 1. expand the stage sources, includes are parsed once and cached
+            ShaderPreprocessor preprocessor;
+            ShaderSource vertexSource;
+            ShaderSource fragmentSource;
+            ShaderSource geometrySource;
+            if (!preprocessor.Process(m_vertexPath, m_defines, vertexSource))
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << m_vertexPath << std::endl;
+            if (!preprocessor.Process(m_fragmentPath, m_defines, fragmentSource))
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << m_fragmentPath << std::endl;
+            if (HasGeometryStage() && !preprocessor.Process(m_geometryPath, m_defines, geometrySource))
+                std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << m_geometryPath << std::endl;
+
+            SetDependencies(vertexSource, fragmentSource, geometrySource);
+
+            // 2. try to restore the linked program from the on-disk binary cache
+            std::uint64_t cacheKey = ShaderCache::ComputeKey(GetStageCode(vertexSource, fragmentSource, geometrySource));
+            ID = glCreateProgram();
+            if (ShaderCache::TryLoad(cacheKey, ID))
+                return;
+
+            // Cache miss or rejected binary: start over with a fresh program object
+            glDeleteProgram(ID);
+            auto compileStart = std::chrono::steady_clock::now();
+
+            const char* vShaderCode = vertexSource.code.c_str();
+            const char* fShaderCode = fragmentSource.code.c_str();
+            // 3. compile shaders
             unsigned int vertex, fragment;
             // vertex shader
             vertex = glCreateShader(GL_VERTEX_SHADER);
             glShaderSource(vertex, 1, &vShaderCode, NULL);
             glCompileShader(vertex);
-            checkCompileErrors(vertex, "VERTEX");
+            checkCompileErrors(vertex, "VERTEX", &vertexSource);
             // fragment Shader
             fragment = glCreateShader(GL_FRAGMENT_SHADER);
             glShaderSource(fragment, 1, &fShaderCode, NULL);
             glCompileShader(fragment);
-            checkCompileErrors(fragment, "FRAGMENT");
+            checkCompileErrors(fragment, "FRAGMENT", &fragmentSource);
+            // geometry shader
+            unsigned int geometry = 0;
+            if (HasGeometryStage())
+            {
+                const char* gShaderCode = geometrySource.code.c_str();
+                geometry = glCreateShader(GL_GEOMETRY_SHADER);
+                glShaderSource(geometry, 1, &gShaderCode, NULL);
+                glCompileShader(geometry);
+                checkCompileErrors(geometry, "GEOMETRY", &geometrySource);
+            }
             // shader Program
             ID = glCreateProgram();
+            glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
             glAttachShader(ID, vertex);
             glAttachShader(ID, fragment);
+            if (geometry != 0)
+                glAttachShader(ID, geometry);
             glLinkProgram(ID);
-            checkCompileErrors(ID, "PROGRAM");
+            bool linked = checkCompileErrors(ID, "PROGRAM");
             // delete the shaders as they're linked into our program now and no longer necessary
             glDeleteShader(vertex);
             glDeleteShader(fragment);
+            if (geometry != 0)
+                glDeleteShader(geometry);
+
+            std::chrono::duration<double, std::milli> compileTime = std::chrono::steady_clock::now() - compileStart;
+            ShaderCache::RecordCompile(compileTime.count());
+
+            // 4. only cache programs that actually linked
+            if (linked)
+                ShaderCache::Store(cacheKey, ID);
+        }
+
+        /// <summary>
+        /// Gets every file this program was built from (stage roots and all their includes).
+        /// </summary>
+        const std::vector<std::string>& GetDependencies() const { return m_dependencies; }
 
+        /// <summary>
+        /// Recompiles the program from disk and swaps it in, keeping the same program ID.
+        /// If compiling or linking fails, the previous program stays in use.
+        /// </summary>
+        /// <returns>True if the new program was swapped in.</returns>
+        bool Reload()
+        {
+            return BeginReload() && FinishReload();
         }
 
         /// <summary>
@@ -221,13 +310,150 @@ namespace core
         }
 
     private:
+        friend class ShaderHotReloader;
+
+        std::string m_vertexPath;
+        std::string m_fragmentPath;
+        std::string m_geometryPath;     // Empty when the program has no geometry stage
+        ShaderPreprocessor::Defines m_defines;
+        std::vector<std::string> m_dependencies;
+
+        // Stages compiled by BeginReload() and consumed by FinishReload()
+        GLuint m_pendingVertex = 0;
+        GLuint m_pendingFragment = 0;
+        GLuint m_pendingGeometry = 0;
+        ShaderSource m_pendingVertexSource;
+        ShaderSource m_pendingFragmentSource;
+        ShaderSource m_pendingGeometrySource;
+
+        bool HasGeometryStage() const { return !m_geometryPath.empty(); }
+
+        /// <summary>
+        /// Gets the code of every stage, used as the binary cache key.
+        /// </summary>
+        std::vector<std::string> GetStageCode(const ShaderSource& vertexSource, const ShaderSource& fragmentSource, const ShaderSource& geometrySource) const
+        {
+            std::vector<std::string> code = { vertexSource.code, fragmentSource.code };
+            if (HasGeometryStage())
+                code.push_back(geometrySource.code);
+            return code;
+        }
+
+        void SetDependencies(const ShaderSource& vertexSource, const ShaderSource& fragmentSource, const ShaderSource& geometrySource)
+        {
+            m_dependencies = vertexSource.dependencies;
+            for (const ShaderSource* source : { &fragmentSource, &geometrySource })
+                for (const auto& dependency : source->dependencies)
+                    if (std::find(m_dependencies.begin(), m_dependencies.end(), dependency) == m_dependencies.end())
+                        m_dependencies.push_back(dependency);
+        }
+
+        /// <summary>
+        /// Preprocesses the stage files again and submits them for compilation without
+        /// waiting for the result, so several programs can compile in parallel.
+        /// </summary>
+        /// <returns>False if a stage file could not be read.</returns>
+        bool BeginReload()
+        {
+            ShaderPreprocessor preprocessor;
+            if (!preprocessor.Process(m_vertexPath, m_defines, m_pendingVertexSource) ||
+                !preprocessor.Process(m_fragmentPath, m_defines, m_pendingFragmentSource) ||
+                (HasGeometryStage() && !preprocessor.Process(m_geometryPath, m_defines, m_pendingGeometrySource)))
+            {
+                printf("[SHADER] Could not read %s / %s, keeping the previous program\n", m_vertexPath.c_str(), m_fragmentPath.c_str());
+                return false;
+            }
+
+            const char* vShaderCode = m_pendingVertexSource.code.c_str();
+            const char* fShaderCode = m_pendingFragmentSource.code.c_str();
+            m_pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(m_pendingVertex, 1, &vShaderCode, NULL);
+            glCompileShader(m_pendingVertex);
+            m_pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(m_pendingFragment, 1, &fShaderCode, NULL);
+            glCompileShader(m_pendingFragment);
+            if (HasGeometryStage())
+            {
+                const char* gShaderCode = m_pendingGeometrySource.code.c_str();
+                m_pendingGeometry = glCreateShader(GL_GEOMETRY_SHADER);
+                glShaderSource(m_pendingGeometry, 1, &gShaderCode, NULL);
+                glCompileShader(m_pendingGeometry);
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// Checks the stages submitted by BeginReload() and, if they compile and link, relinks
+        /// the live program with them. The program ID does not change, so Materials keep working.
+        /// </summary>
+        /// <returns>True if the new program was swapped in.</returns>
+        bool FinishReload()
+        {
+            if (m_pendingVertex == 0 || m_pendingFragment == 0 || (HasGeometryStage() && m_pendingGeometry == 0))
+                return false;
+
+            // Evaluate every stage so errors in any of them are reported
+            bool vertexOk = checkCompileErrors(m_pendingVertex, "VERTEX", &m_pendingVertexSource);
+            bool fragmentOk = checkCompileErrors(m_pendingFragment, "FRAGMENT", &m_pendingFragmentSource);
+            bool geometryOk = !HasGeometryStage() || checkCompileErrors(m_pendingGeometry, "GEOMETRY", &m_pendingGeometrySource);
+
+            bool swapped = false;
+            if (vertexOk && fragmentOk && geometryOk)
+            {
+                // Link into a scratch program first, so a link error never touches the live program
+                GLuint scratch = glCreateProgram();
+                glAttachShader(scratch, m_pendingVertex);
+                glAttachShader(scratch, m_pendingFragment);
+                if (m_pendingGeometry != 0)
+                    glAttachShader(scratch, m_pendingGeometry);
+                glLinkProgram(scratch);
+                bool linked = checkCompileErrors(scratch, "PROGRAM");
+                glDeleteProgram(scratch);
+
+                if (linked)
+                {
+                    GLuint attached[8];
+                    GLsizei count = 0;
+                    glGetAttachedShaders(ID, 8, &count, attached);
+                    for (GLsizei i = 0; i < count; ++i)
+                        glDetachShader(ID, attached[i]);
+
+                    glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+                    glAttachShader(ID, m_pendingVertex);
+                    glAttachShader(ID, m_pendingFragment);
+                    if (m_pendingGeometry != 0)
+                        glAttachShader(ID, m_pendingGeometry);
+                    glLinkProgram(ID);
+                    swapped = checkCompileErrors(ID, "PROGRAM");
+
+                    if (swapped)
+                    {
+                        SetDependencies(m_pendingVertexSource, m_pendingFragmentSource, m_pendingGeometrySource);
+                        ShaderCache::Store(ShaderCache::ComputeKey(GetStageCode(m_pendingVertexSource, m_pendingFragmentSource, m_pendingGeometrySource)), ID);
+                    }
+                }
+            }
+
+            glDeleteShader(m_pendingVertex);
+            glDeleteShader(m_pendingFragment);
+            if (m_pendingGeometry != 0)
+                glDeleteShader(m_pendingGeometry);
+            m_pendingVertex = m_pendingFragment = m_pendingGeometry = 0;
+            m_pendingVertexSource = {};
+            m_pendingFragmentSource = {};
+            m_pendingGeometrySource = {};
+            return swapped;
+        }
+
         /// <summary>
         /// Checks for shader compilation or program linking errors.
         /// Prints error messages to the console if any errors are found.
         /// </summary>
         /// <param name="shader">The shader or program ID to check.</param>
         /// <param name="type">The type of shader ("VERTEX", "FRAGMENT", "GEOMETRY", or "PROGRAM").</param>
-        void checkCompileErrors(GLuint shader, std::string type)
+        /// <param name="source">Optional preprocessed source, used to map error locations back to files.</param>
+        /// <returns>True if compilation or linking succeeded.</returns>
+        bool checkCompileErrors(GLuint shader, std::string type, const ShaderSource* source = nullptr)
         {
             GLint success;
             GLchar infoLog[1024];
@@ -237,7 +463,8 @@ namespace core
                 if (!success)
                 {
                     glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-                    std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+                    std::string log = source ? ShaderPreprocessor::MapErrorLog(infoLog, *source) : std::string(infoLog);
+                    std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << log << "\n -- --------------------------------------------------- -- " << std::endl;
                 }
             }
             else
@@ -249,51 +476,7 @@ namespace core
                     std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
                 }
             }
-        }
-
-        std::string ProcessShaderIncludes(const std::string& source, const std::string& basePath = "assets/shaders/shaderLibrary/")
-        {
-            std::string result = source;
-            std::regex includePattern(R"(#include\s+\"([^\"]+)\")");
-            std::smatch match;
-
-            // Keep processing until no more includes found (supports nested includes)
-            while (std::regex_search(result, match, includePattern))
-            {
-                std::string includeFile = match[1].str();
-                std::string includePath = basePath + includeFile;
-
-                printf("Processing #include \"%s\" from %s\n", includeFile.c_str(), includePath.c_str());
-
-                std::string includeContent = ReadFileToString(includePath);
-
-                if (includeContent.empty())
-                {
-                    printf("Warning: Could not read include file: %s\n", includePath.c_str());
-                }
-                else
-                {
-                    printf("Successfully loaded include: %s (%zu bytes)\n", includeFile.c_str(), includeContent.size());
-                }
-
-                // Replace the #include directive with the file content
-                result = std::regex_replace(result, includePattern, includeContent, std::regex_constants::format_first_only);
-            }
-
-            return result;
-        }
-
-        std::string ReadFileToString(const std::string& filePath)
-        {
-            std::ifstream fileStream(filePath, std::ios::in);
-            if (!fileStream.is_open())
-            {
-                printf("Could not open file: %s\n", filePath.c_str());
-                return "";
-            }
-            std::stringstream buffer;
-            buffer << fileStream.rdbuf();
-            return ProcessShaderIncludes(buffer.str());
+            return success == GL_TRUE;
         }
     };
 } // namespace core
\ No newline at end of file
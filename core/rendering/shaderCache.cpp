@@ -0,0 +1,156 @@
+#include "../hash.h"
+#include "shaderCache.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace core
+{
+    bool ShaderCache::s_enabled = true;
+    std::string ShaderCache::s_directory = "shaderCache";
+    ShaderCache::Stats ShaderCache::s_stats;
+
+    // File layout: [magic][version][key][binaryFormat][length][binary...]
+    static constexpr std::uint32_t CACHE_MAGIC = 0x42504546; // "FEPB"
+    static constexpr std::uint32_t CACHE_VERSION = 1;
+
+    std::uint64_t ShaderCache::ComputeKey(const std::vector<std::string>& sources)
+    {
+        std::uint64_t hash = hash::FNV_OFFSET;
+        for (const auto& source : sources)
+        {
+            // Hash the length too, so moving text between stages changes the key
+            std::uint64_t length = source.size();
+            hash = hash::HashValue(hash, length);
+            hash = hash::HashBytes(hash, source.data(), source.size());
+        }
+
+        const std::string& driver = GetDriverSignature();
+        return hash::HashBytes(hash, driver.data(), driver.size());
+    }
+
+    bool ShaderCache::IsEnabled()
+    {
+        if (!s_enabled) return false;
+
+        static GLint numFormats = -1;
+        if (numFormats < 0)
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+            if (numFormats <= 0)
+                printf("[SHADERCACHE] Driver exposes no program binary formats, cache disabled.\n");
+        }
+        return numFormats > 0;
+    }
+
+    bool ShaderCache::TryLoad(std::uint64_t key, GLuint program)
+    {
+        if (!IsEnabled()) return false;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::ifstream file(GetPathForKey(key), std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        std::uint32_t magic = 0, version = 0, length = 0;
+        std::uint64_t storedKey = 0;
+        GLenum format = 0;
+        file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        file.read(reinterpret_cast<char*>(&version), sizeof(version));
+        file.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+        file.read(reinterpret_cast<char*>(&format), sizeof(format));
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+
+        if (!file || magic != CACHE_MAGIC || version != CACHE_VERSION || storedKey != key || length == 0)
+            return false;
+
+        std::vector<char> binary(length);
+        file.read(binary.data(), length);
+        if (!file)
+            return false;
+
+        glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+
+        // The driver may reject a binary at any time (e.g. after an update it does not report)
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE)
+        {
+            printf("[SHADERCACHE] Driver rejected cached binary %016llx, recompiling.\n", static_cast<unsigned long long>(key));
+            return false;
+        }
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        s_stats.hits++;
+        s_stats.loadMs += elapsed.count();
+        return true;
+    }
+
+    void ShaderCache::Store(std::uint64_t key, GLuint program)
+    {
+        if (!IsEnabled()) return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+            return;
+
+        std::error_code ec;
+        std::filesystem::create_directories(s_directory, ec);
+        if (ec)
+        {
+            printf("[SHADERCACHE] Could not create cache directory '%s': %s\n", s_directory.c_str(), ec.message().c_str());
+            return;
+        }
+
+        std::ofstream file(GetPathForKey(key), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+
+        std::uint32_t size = static_cast<std::uint32_t>(written);
+        file.write(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+        file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(binary.data(), size);
+
+        s_stats.stores++;
+    }
+
+    void ShaderCache::RecordCompile(double milliseconds)
+    {
+        s_stats.misses++;
+        s_stats.compileMs += milliseconds;
+    }
+
+    const std::string& ShaderCache::GetDriverSignature()
+    {
+        static std::string signature;
+        if (signature.empty())
+        {
+            auto str = [](GLenum name) {
+                const GLubyte* value = glGetString(name);
+                return value ? std::string(reinterpret_cast<const char*>(value)) : std::string("unknown");
+            };
+            signature = str(GL_VENDOR) + "|" + str(GL_RENDERER) + "|" + str(GL_VERSION);
+        }
+        return signature;
+    }
+
+    std::string ShaderCache::GetPathForKey(std::uint64_t key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(s_directory) / name).string();
+    }
+} // namespace core
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// On-disk cache for linked shader program binaries.
+    /// Programs are keyed by a hash of their fully preprocessed sources combined with the
+    /// driver vendor/renderer/version string, so a driver update or any source change
+    /// automatically results in a cache miss and a normal compile.
+    /// </summary>
+    /// <remarks>
+    /// Requires a current OpenGL context with at least one supported program binary format.
+    /// When no format is available the cache silently disables itself.
+    /// </remarks>
+    class ShaderCache
+    {
+    public:
+        /// <summary>
+        /// Timing and hit/miss counters collected since the last ResetStats() call.
+        /// </summary>
+        struct Stats
+        {
+            int hits = 0;               // Programs restored from a cached binary
+            int misses = 0;             // Programs that had to be compiled from source
+            int stores = 0;             // Binaries written to disk
+            double loadMs = 0.0;        // Time spent restoring binaries
+            double compileMs = 0.0;     // Time spent compiling and linking from source
+        };
+
+        /// <summary>
+        /// Computes the cache key for a program from its preprocessed stage sources.
+        /// The driver signature is folded into the key as well.
+        /// </summary>
+        /// <param name="sources">The fully preprocessed source of every stage, in stage order.</param>
+        /// <returns>A 64-bit FNV-1a hash identifying the program.</returns>
+        static std::uint64_t ComputeKey(const std::vector<std::string>& sources);
+
+        /// <summary>
+        /// Attempts to restore a program from the cache into the given program object.
+        /// </summary>
+        /// <param name="key">The key returned by ComputeKey().</param>
+        /// <param name="program">An empty program object to load the binary into.</param>
+        /// <returns>True if the binary was accepted by the driver and the program is linked.</returns>
+        static bool TryLoad(std::uint64_t key, GLuint program);
+
+        /// <summary>
+        /// Retrieves the binary of a successfully linked program and writes it to the cache.
+        /// The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+        /// </summary>
+        /// <param name="key">The key returned by ComputeKey().</param>
+        /// <param name="program">The linked program object.</param>
+        static void Store(std::uint64_t key, GLuint program);
+
+        /// <summary>
+        /// Records the time spent compiling a program from source (cache miss).
+        /// </summary>
+        static void RecordCompile(double milliseconds);
+
+        static void SetEnabled(bool enabled) { s_enabled = enabled; }
+        static bool IsEnabled();
+
+        /// <summary>
+        /// Sets the directory the binaries are stored in. Defaults to "shaderCache".
+        /// </summary>
+        static void SetDirectory(const std::string& directory) { s_directory = directory; }
+        static const std::string& GetDirectory() { return s_directory; }
+
+        static const Stats& GetStats() { return s_stats; }
+        static void ResetStats() { s_stats = {}; }
+
+    private:
+        /// <summary>
+        /// Returns "vendor|renderer|version" for the current context. Queried once.
+        /// </summary>
+        static const std::string& GetDriverSignature();
+
+        static std::string GetPathForKey(std::uint64_t key);
+
+        static bool s_enabled;
+        static std::string s_directory;
+        static Stats s_stats;
+    };
+} // namespace core
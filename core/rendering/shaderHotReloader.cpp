@@ -0,0 +1,272 @@
+#include "../profiler.h"
+#include "shader.h"
+#include "shaderHotReloader.h"
+#include "shaderPreprocessor.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+    std::mutex ShaderHotReloader::s_shadersMutex;
+    std::vector<Shader*> ShaderHotReloader::s_shaders;
+    std::mutex ShaderHotReloader::s_changesMutex;
+    std::unordered_map<std::string, ShaderHotReloader::Clock::time_point> ShaderHotReloader::s_changes;
+    std::string ShaderHotReloader::s_directory;
+    std::string ShaderHotReloader::s_sourceDirectory;
+    std::thread ShaderHotReloader::s_thread;
+    std::atomic<bool> ShaderHotReloader::s_running = false;
+
+    static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(250);
+
+    static std::string NormalizePath(const std::filesystem::path& path)
+    {
+        return path.lexically_normal().generic_string();
+    }
+
+    void ShaderHotReloader::Start(const std::string& directory, const std::string& sourceDirectory)
+    {
+        if (s_running) return;
+
+        if (!std::filesystem::is_directory(directory))
+        {
+            printf("[SHADER] Hot-reload disabled, '%s' is not a directory\n", directory.c_str());
+            return;
+        }
+
+        s_directory = directory;
+        s_sourceDirectory.clear();
+        if (!sourceDirectory.empty())
+        {
+            if (std::filesystem::is_directory(sourceDirectory))
+                s_sourceDirectory = sourceDirectory;
+            else
+                printf("[SHADER] Source directory '%s' not found, watching '%s' instead\n", sourceDirectory.c_str(), directory.c_str());
+        }
+
+        s_running = true;
+        s_thread = std::thread(&ShaderHotReloader::WatchLoop, s_sourceDirectory.empty() ? s_directory : s_sourceDirectory);
+    }
+
+    void ShaderHotReloader::Stop()
+    {
+        s_running = false;
+        if (s_thread.joinable())
+            s_thread.join();
+    }
+
+    void ShaderHotReloader::Register(Shader* shader)
+    {
+        std::lock_guard lock(s_shadersMutex);
+        if (std::find(s_shaders.begin(), s_shaders.end(), shader) == s_shaders.end())
+            s_shaders.push_back(shader);
+    }
+
+    void ShaderHotReloader::Unregister(Shader* shader)
+    {
+        std::lock_guard lock(s_shadersMutex);
+        s_shaders.erase(std::remove(s_shaders.begin(), s_shaders.end(), shader), s_shaders.end());
+    }
+
+    void ShaderHotReloader::Update()
+    {
+        FINALENGINE_PROFILE_ZONE("ShaderHotReloader::Update");
+        std::unordered_map<std::string, Clock::time_point> changes;
+        {
+            std::lock_guard lock(s_changesMutex);
+            if (s_changes.empty()) return;
+            changes.swap(s_changes);
+        }
+
+        Clock::time_point firstDetected = Clock::time_point::max();
+        for (const auto& [path, detected] : changes)
+        {
+            ShaderPreprocessor::Invalidate(path);
+            firstDetected = std::min(firstDetected, detected);
+        }
+
+        // Walk the dependency graph: only programs that include a changed file are rebuilt
+        std::vector<Shader*> affected;
+        {
+            std::lock_guard lock(s_shadersMutex);
+            for (Shader* shader : s_shaders)
+            {
+                const auto& dependencies = shader->GetDependencies();
+                bool dependsOnChange = std::any_of(dependencies.begin(), dependencies.end(),
+                    [&changes](const std::string& dependency) { return changes.contains(dependency); });
+                if (dependsOnChange)
+                    affected.push_back(shader);
+            }
+        }
+
+        if (affected.empty()) return;
+
+        auto start = Clock::now();
+
+        // Submit every compile before querying any status, so drivers with threaded
+        // compilation can work on all affected programs in parallel.
+        std::vector<Shader*> submitted;
+        for (Shader* shader : affected)
+            if (shader->BeginReload())
+                submitted.push_back(shader);
+
+        int reloaded = 0;
+        for (Shader* shader : submitted)
+            if (shader->FinishReload())
+                reloaded++;
+
+        auto end = Clock::now();
+        std::chrono::duration<double, std::milli> compileTime = end - start;
+        std::chrono::duration<double, std::milli> latency = end - firstDetected;
+
+        for (const auto& [path, detected] : changes)
+            printf("[SHADER] Changed: %s\n", path.c_str());
+        printf("[SHADER] Hot-reloaded %d/%zu affected program(s) in %.1f ms (%.1f ms after the change was detected)\n",
+               reloaded, affected.size(), compileTime.count(), latency.count());
+        if (reloaded != static_cast<int>(affected.size()))
+            printf("[SHADER] Programs that failed to rebuild keep their last good version\n");
+    }
+
+    void ShaderHotReloader::QueueChange(const std::string& path)
+    {
+        std::string changed = NormalizePath(path);
+
+        // Shaders are loaded from the runtime copy, bring the edited file over before it is reloaded
+        if (!s_sourceDirectory.empty())
+        {
+            const std::filesystem::path relative = std::filesystem::path(path).lexically_relative(s_sourceDirectory);
+            const std::filesystem::path target = std::filesystem::path(s_directory) / relative;
+
+            std::error_code ec;
+            std::filesystem::create_directories(target.parent_path(), ec);
+            std::filesystem::copy_file(path, target, std::filesystem::copy_options::overwrite_existing, ec);
+            if (ec)
+            {
+                printf("[SHADER] Failed to copy %s to %s: %s\n", path.c_str(), target.string().c_str(), ec.message().c_str());
+                return;
+            }
+            changed = NormalizePath(target);
+        }
+
+        std::lock_guard lock(s_changesMutex);
+        // Keep the first detection time so the logged latency covers repeated save events
+        s_changes.try_emplace(std::move(changed), Clock::now());
+    }
+
+    void ShaderHotReloader::WatchLoop(std::string directory)
+    {
+#ifdef __linux__
+        if (InotifyLoop(directory))
+            return;
+#endif
+        PollLoop(directory);
+    }
+
+    void ShaderHotReloader::PollLoop(const std::string& directory)
+    {
+        printf("[SHADER] Watching %s for changes (polling)\n", directory.c_str());
+
+        std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+        auto scan = [&](bool report) {
+            std::error_code ec;
+            for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+                 !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+            {
+                if (!it->is_regular_file(ec)) continue;
+
+                auto writeTime = it->last_write_time(ec);
+                if (ec) continue;
+
+                auto [entry, inserted] = writeTimes.try_emplace(NormalizePath(it->path()), writeTime);
+                if (!inserted && entry->second != writeTime)
+                {
+                    entry->second = writeTime;
+                    if (report) QueueChange(entry->first);
+                }
+                else if (inserted && report)
+                {
+                    QueueChange(entry->first);
+                }
+            }
+        };
+
+        scan(false);
+        while (s_running)
+        {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            scan(true);
+        }
+    }
+
+#ifdef __linux__
+    bool ShaderHotReloader::InotifyLoop(const std::string& directory)
+    {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) return false;
+
+        // inotify is not recursive, so every subdirectory gets its own watch
+        std::unordered_map<int, std::string> watches;
+        auto addWatch = [&](const std::string& path) {
+            int wd = inotify_add_watch(fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd >= 0) watches[wd] = path;
+        };
+
+        addWatch(directory);
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (it->is_directory(ec))
+                addWatch(it->path().string());
+        }
+
+        if (watches.empty())
+        {
+            close(fd);
+            return false;
+        }
+
+        printf("[SHADER] Watching %s for changes (inotify, %zu directories)\n", directory.c_str(), watches.size());
+
+        alignas(inotify_event) char buffer[4096];
+        while (s_running)
+        {
+            pollfd pfd{ fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 100) <= 0) continue;
+
+            ssize_t length = read(fd, buffer, sizeof(buffer));
+            if (length <= 0) continue;
+
+            for (char* ptr = buffer; ptr < buffer + length; )
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                auto watch = watches.find(event->wd);
+                if (event->len == 0 || watch == watches.end()) continue;
+
+                std::string path = watch->second + "/" + event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    addWatch(path);
+                    continue;
+                }
+
+                // IN_CREATE alone fires before the contents are written; wait for the close
+                if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                    QueueChange(path);
+            }
+        }
+
+        close(fd);
+        return true;
+    }
+#endif
+} // namespace core
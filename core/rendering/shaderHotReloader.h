@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+    class Shader;
+
+    /// <summary>
+    /// Watches the shader directory and recompiles only the programs affected by a changed file.
+    /// <para>
+    /// A background thread detects changes (inotify on Linux, polling of modification times
+    /// elsewhere). The changes are applied on the render thread by Update(), which should be
+    /// called at the start of a frame. Every live Shader registers itself here and exposes its
+    /// include dependency list, so a change to a shared include only touches the programs that
+    /// actually include it. A program that fails to compile keeps its last good version.
+    /// </para>
+    /// <para>
+    /// The shaders are loaded from the copy next to the executable. When a source directory is given,
+    /// that one is watched instead and changed files are copied over the runtime copy before reloading.
+    /// </para>
+    /// </summary>
+    class ShaderHotReloader
+    {
+    public:
+        /// <summary>
+        /// Starts watching the shader directory (recursively) on a background thread.
+        /// </summary>
+        /// <param name="directory">The directory the shaders are loaded from.</param>
+        /// <param name="sourceDirectory">The directory the shaders are edited in, empty if it is <paramref name="directory"/>.</param>
+        static void Start(const std::string& directory = "assets/shaders", const std::string& sourceDirectory = {});
+
+        /// <summary>
+        /// Stops the watcher thread. Safe to call when not started.
+        /// </summary>
+        static void Stop();
+
+        /// <summary>
+        /// Recompiles and swaps in the programs affected by changes detected since the last call.
+        /// Must be called on the thread that owns the OpenGL context, ideally at frame start.
+        /// </summary>
+        static void Update();
+
+        static void Register(Shader* shader);
+        static void Unregister(Shader* shader);
+
+        static bool IsRunning() { return s_running; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static void WatchLoop(std::string directory);
+        static void PollLoop(const std::string& directory);
+#ifdef __linux__
+        static bool InotifyLoop(const std::string& directory);
+#endif
+        static void QueueChange(const std::string& path);
+
+        static std::mutex s_shadersMutex;
+        static std::vector<Shader*> s_shaders;
+
+        static std::mutex s_changesMutex;
+        static std::unordered_map<std::string, Clock::time_point> s_changes;     // Normalized path -> time the change was detected
+
+        static std::string s_directory;
+        static std::string s_sourceDirectory;      // Empty when the runtime directory is watched
+
+        static std::thread s_thread;
+        static std::atomic<bool> s_running;
+    };
+} // namespace core
@@ -0,0 +1,366 @@
+#include "shaderPreprocessor.h"
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace core
+{
+    std::mutex ShaderPreprocessor::s_cacheMutex;
+    std::unordered_map<std::string, std::shared_ptr<const ShaderPreprocessor::ParsedFile>> ShaderPreprocessor::s_cache;
+
+    // Includes nested deeper than this are assumed to be cyclic
+    static constexpr size_t MAX_INCLUDE_DEPTH = 32;
+
+    static std::string NormalizePath(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    static size_t SkipSpaces(const std::string& line, size_t pos)
+    {
+        while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'))
+            ++pos;
+        return pos;
+    }
+
+    static std::string ReadIdentifier(const std::string& line, size_t& pos)
+    {
+        size_t start = pos;
+        while (pos < line.size() && (std::isalnum(static_cast<unsigned char>(line[pos])) || line[pos] == '_'))
+            ++pos;
+        return line.substr(start, pos - start);
+    }
+
+    /// <summary>
+    /// Advances the block comment state over a line, ignoring anything after a line comment.
+    /// </summary>
+    static bool UpdateBlockComment(const std::string& line, bool inBlockComment)
+    {
+        for (size_t i = 0; i + 1 < line.size(); ++i)
+        {
+            if (inBlockComment)
+            {
+                if (line[i] == '*' && line[i + 1] == '/') { inBlockComment = false; ++i; }
+            }
+            else if (line[i] == '/' && line[i + 1] == '/')
+                break;
+            else if (line[i] == '/' && line[i + 1] == '*') { inBlockComment = true; ++i; }
+        }
+        return inBlockComment;
+    }
+
+    ShaderPreprocessor::ShaderPreprocessor(std::string includeDirectory)
+        : m_includeDirectory(std::move(includeDirectory))
+    {
+    }
+
+    bool ShaderPreprocessor::Process(const std::string& path, const Defines& defines, ShaderSource& out) const
+    {
+        out = {};
+
+        Context ctx;
+        ctx.defines = &defines;
+        ctx.out = &out;
+
+        // Rough guess that avoids most reallocations for the files in this repository
+        out.code.reserve(16 * 1024);
+
+        return Emit(NormalizePath(path), ctx);
+    }
+
+    void ShaderPreprocessor::Invalidate(const std::string& path)
+    {
+        std::lock_guard lock(s_cacheMutex);
+        s_cache.erase(NormalizePath(path));
+    }
+
+    void ShaderPreprocessor::InvalidateAll()
+    {
+        std::lock_guard lock(s_cacheMutex);
+        s_cache.clear();
+    }
+
+    std::shared_ptr<const ShaderPreprocessor::ParsedFile> ShaderPreprocessor::GetOrParse(const std::string& path) const
+    {
+        {
+            std::lock_guard lock(s_cacheMutex);
+            auto it = s_cache.find(path);
+            if (it != s_cache.end())
+                return it->second;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+            return nullptr;
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        auto parsed = Parse(path, stream.str());
+
+        std::lock_guard lock(s_cacheMutex);
+        s_cache[path] = parsed;
+        return parsed;
+    }
+
+    std::shared_ptr<const ShaderPreprocessor::ParsedFile> ShaderPreprocessor::Parse(const std::string& path, const std::string& contents) const
+    {
+        auto parsed = std::make_shared<ParsedFile>();
+        bool inBlockComment = false;
+
+        size_t lineStart = 0;
+        while (lineStart <= contents.size())
+        {
+            size_t lineEnd = contents.find('\n', lineStart);
+            if (lineEnd == std::string::npos)
+            {
+                // Do not turn a trailing newline into an extra empty line
+                if (lineStart == contents.size())
+                    break;
+                lineEnd = contents.size();
+            }
+
+            std::string text = contents.substr(lineStart, lineEnd - lineStart);
+            if (!text.empty() && text.back() == '\r')
+                text.pop_back();
+            lineStart = lineEnd + 1;
+
+            Line line;
+            line.kind = Line::Kind::Text;
+
+            size_t pos = SkipSpaces(text, 0);
+            if (!inBlockComment && pos < text.size() && text[pos] == '#')
+            {
+                pos = SkipSpaces(text, pos + 1);
+                std::string directive = ReadIdentifier(text, pos);
+
+                if (directive == "include")
+                {
+                    pos = SkipSpaces(text, pos);
+                    char open = pos < text.size() ? text[pos] : '\0';
+                    char close = open == '<' ? '>' : '"';
+                    size_t end = (open == '"' || open == '<') ? text.find(close, pos + 1) : std::string::npos;
+
+                    if (end != std::string::npos)
+                    {
+                        line.kind = Line::Kind::Include;
+                        line.text = ResolveInclude(path, text.substr(pos + 1, end - pos - 1));
+                    }
+                    else
+                    {
+                        printf("[SHADER] Malformed #include in %s: %s\n", path.c_str(), text.c_str());
+                    }
+                }
+                else if (directive == "pragma")
+                {
+                    pos = SkipSpaces(text, pos);
+                    if (ReadIdentifier(text, pos) == "once")
+                    {
+                        line.kind = Line::Kind::PragmaOnce;
+                        parsed->pragmaOnce = true;
+                    }
+                }
+                else if (directive == "version")
+                {
+                    line.kind = Line::Kind::Version;
+                    parsed->hasVersion = true;
+                }
+            }
+
+            if (line.kind != Line::Kind::Include)
+                line.text = std::move(text);
+
+            inBlockComment = UpdateBlockComment(line.kind == Line::Kind::Include ? std::string() : line.text, inBlockComment);
+            parsed->lines.push_back(std::move(line));
+        }
+
+        // Detect a classic include guard: the first two directives are #ifndef X / #define X
+        // and the last non-empty line is #endif.
+        auto directiveOf = [](const std::string& text, std::string& argument) {
+            size_t pos = SkipSpaces(text, 0);
+            if (pos >= text.size() || text[pos] != '#') return std::string();
+            pos = SkipSpaces(text, pos + 1);
+            std::string name = ReadIdentifier(text, pos);
+            pos = SkipSpaces(text, pos);
+            argument = ReadIdentifier(text, pos);
+            return name;
+        };
+        auto isBlank = [](const Line& line) {
+            return line.kind == Line::Kind::Text && SkipSpaces(line.text, 0) == line.text.size();
+        };
+
+        std::vector<const Line*> significant;
+        for (const auto& line : parsed->lines)
+            if (!isBlank(line))
+                significant.push_back(&line);
+
+        if (significant.size() >= 3)
+        {
+            std::string first, second, unused;
+            if (directiveOf(significant[0]->text, first) == "ifndef" &&
+                directiveOf(significant[1]->text, second) == "define" &&
+                directiveOf(significant.back()->text, unused) == "endif" &&
+                !first.empty() && first == second)
+            {
+                parsed->guard = first;
+            }
+        }
+
+        return parsed;
+    }
+
+    std::string ShaderPreprocessor::ResolveInclude(const std::string& includingFile, const std::string& include) const
+    {
+        std::error_code ec;
+        std::filesystem::path relative = std::filesystem::path(includingFile).parent_path() / include;
+        if (std::filesystem::exists(relative, ec))
+            return NormalizePath(relative.string());
+
+        return NormalizePath((std::filesystem::path(m_includeDirectory) / include).string());
+    }
+
+    bool ShaderPreprocessor::Emit(const std::string& path, Context& ctx) const
+    {
+        auto file = GetOrParse(path);
+        if (!file)
+        {
+            if (ctx.stack.empty())
+                return false;
+
+            printf("[SHADER] Could not open include '%s' (included from %s)\n", path.c_str(), ctx.stack.back().c_str());
+            return true;
+        }
+
+        if (file->pragmaOnce && !ctx.onceFiles.insert(path).second)
+            return true;
+        if (!file->guard.empty() && !ctx.guards.insert(file->guard).second)
+            return true;
+
+        if (ctx.stack.size() >= MAX_INCLUDE_DEPTH)
+        {
+            printf("[SHADER] Include depth exceeded at '%s', probable include cycle\n", path.c_str());
+            return true;
+        }
+
+        ShaderSource& out = *ctx.out;
+        int fileIndex = GetFileIndex(path, ctx);
+        std::string fileIndexString = std::to_string(fileIndex);
+
+        bool isRoot = ctx.stack.empty();
+        ctx.stack.push_back(path);
+
+        if (isRoot && !file->hasVersion)
+        {
+            EmitDefines(ctx);
+            out.code += "#line 1 " + fileIndexString + "\n";
+        }
+        else if (!isRoot)
+        {
+            out.code += "#line 1 " + fileIndexString + "\n";
+        }
+
+        // "#line N" sets the number of the line that follows it, so after line i (0-based)
+        // the next line is i + 2.
+        auto resumeLine = [&](size_t i) {
+            out.code += "#line " + std::to_string(i + 2) + " " + fileIndexString + "\n";
+        };
+
+        for (size_t i = 0; i < file->lines.size(); ++i)
+        {
+            const Line& line = file->lines[i];
+            switch (line.kind)
+            {
+            case Line::Kind::Text:
+                out.code += line.text;
+                out.code += '\n';
+                break;
+            case Line::Kind::Version:
+                out.code += line.text;
+                out.code += '\n';
+                if (isRoot)
+                {
+                    EmitDefines(ctx);
+                    resumeLine(i);
+                }
+                break;
+            case Line::Kind::PragmaOnce:
+                // Keep the line so line numbers stay intact
+                out.code += '\n';
+                break;
+            case Line::Kind::Include:
+                Emit(line.text, ctx);
+                resumeLine(i);
+                break;
+            }
+        }
+
+        ctx.stack.pop_back();
+        return true;
+    }
+
+    void ShaderPreprocessor::EmitDefines(Context& ctx)
+    {
+        for (const auto& [name, value] : *ctx.defines)
+        {
+            ctx.out->code += "#define " + name;
+            if (!value.empty())
+                ctx.out->code += " " + value;
+            ctx.out->code += '\n';
+        }
+    }
+
+    int ShaderPreprocessor::GetFileIndex(const std::string& path, Context& ctx)
+    {
+        auto& files = ctx.out->files;
+        for (size_t i = 0; i < files.size(); ++i)
+            if (files[i] == path)
+                return static_cast<int>(i);
+
+        files.push_back(path);
+        ctx.out->dependencies.push_back(path);
+        return static_cast<int>(files.size() - 1);
+    }
+
+    std::string ShaderPreprocessor::MapErrorLog(const std::string& log, const ShaderSource& source)
+    {
+        // Handles the two common formats: "0(12) : error" (NVIDIA) and "0:12: error" / "ERROR: 0:12:" (Mesa, AMD, Intel)
+        std::string result;
+        result.reserve(log.size());
+
+        size_t i = 0;
+        while (i < log.size())
+        {
+            bool atToken = i == 0 || !std::isalnum(static_cast<unsigned char>(log[i - 1]));
+            if (atToken && std::isdigit(static_cast<unsigned char>(log[i])))
+            {
+                size_t end = i;
+                while (end < log.size() && std::isdigit(static_cast<unsigned char>(log[end])))
+                    ++end;
+
+                bool followedByLine = end + 1 < log.size() &&
+                    (log[end] == '(' || log[end] == ':') &&
+                    std::isdigit(static_cast<unsigned char>(log[end + 1]));
+
+                // Other numbers in the log (addresses, counts) are copied as they are, however long
+                size_t index = 0;
+                if (followedByLine && end - i <= 9 &&
+                    std::from_chars(log.data() + i, log.data() + end, index).ec == std::errc() &&
+                    index < source.files.size())
+                {
+                    result += source.files[index];
+                    i = end;
+                    continue;
+                }
+
+                result.append(log, i, end - i);
+                i = end;
+                continue;
+            }
+
+            result += log[i++];
+        }
+        return result;
+    }
+} // namespace core
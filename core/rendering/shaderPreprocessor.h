@@ -0,0 +1,137 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// Output of the shader preprocessor for a single shader stage.
+    /// </summary>
+    struct ShaderSource
+    {
+        /// <summary>
+        /// The expanded source code, ready to hand to glShaderSource.
+        /// </summary>
+        std::string code;
+
+        /// <summary>
+        /// Files indexed by the source-string number used in the emitted #line directives.
+        /// Index 0 is always the root file.
+        /// </summary>
+        std::vector<std::string> files;
+
+        /// <summary>
+        /// Every file that contributed to the code (root first, then includes in visiting order).
+        /// </summary>
+        std::vector<std::string> dependencies;
+    };
+
+    /// <summary>
+    /// Single-pass GLSL preprocessor that expands #include directives.
+    /// <para>
+    /// Each file is read and tokenized into lines once and cached, so an include that is
+    /// referenced from several places or several programs is never re-read or re-scanned.
+    /// Honors #pragma once and classic #ifndef/#define/#endif include guards, injects
+    /// #define directives right after #version and emits #line directives so driver
+    /// errors can be mapped back to the real file and line.
+    /// </para>
+    /// </summary>
+    class ShaderPreprocessor
+    {
+    public:
+        /// <summary>
+        /// Ordered list of NAME/VALUE pairs injected as "#define NAME VALUE".
+        /// An empty value defines the name without a value.
+        /// </summary>
+        using Defines = std::vector<std::pair<std::string, std::string>>;
+
+        /// <summary>
+        /// Creates a preprocessor that falls back to the given directory for includes that
+        /// cannot be resolved relative to the including file.
+        /// </summary>
+        /// <param name="includeDirectory">The shader library directory.</param>
+        explicit ShaderPreprocessor(std::string includeDirectory = "assets/shaders/shaderLibrary/");
+
+        /// <summary>
+        /// Expands the given root file.
+        /// </summary>
+        /// <param name="path">Path to the root shader file.</param>
+        /// <param name="defines">Defines to inject after the #version directive.</param>
+        /// <param name="out">Receives the expanded code, file table and dependency list.</param>
+        /// <returns>False if the root file could not be read.</returns>
+        bool Process(const std::string& path, const Defines& defines, ShaderSource& out) const;
+
+        /// <summary>
+        /// Drops a file from the parse cache so the next Process() call re-reads it.
+        /// </summary>
+        /// <param name="path">The path of the file that changed on disk.</param>
+        static void Invalidate(const std::string& path);
+
+        /// <summary>
+        /// Drops every cached file.
+        /// </summary>
+        static void InvalidateAll();
+
+        /// <summary>
+        /// Rewrites the source-string numbers in a driver info log ("0(12)" or "0:12:") to
+        /// the file names recorded in the given source.
+        /// </summary>
+        /// <param name="log">The compile info log.</param>
+        /// <param name="source">The source the log belongs to.</param>
+        /// <returns>The log with file names substituted where possible.</returns>
+        static std::string MapErrorLog(const std::string& log, const ShaderSource& source);
+
+    private:
+        /// <summary>
+        /// A single classified source line.
+        /// </summary>
+        struct Line
+        {
+            enum class Kind { Text, Version, Include, PragmaOnce };
+
+            Kind kind = Kind::Text;
+            std::string text;       // Original text for Text/Version lines, resolved path for Include lines
+        };
+
+        /// <summary>
+        /// A file split into classified lines. Immutable once cached.
+        /// </summary>
+        struct ParsedFile
+        {
+            std::vector<Line> lines;
+            bool pragmaOnce = false;
+            bool hasVersion = false;
+            std::string guard;      // Name of the detected include guard macro, if any
+        };
+
+        /// <summary>
+        /// Per-Process() state.
+        /// </summary>
+        struct Context
+        {
+            const Defines* defines = nullptr;
+            ShaderSource* out = nullptr;
+            std::unordered_set<std::string> onceFiles;
+            std::unordered_set<std::string> guards;
+            std::vector<std::string> stack;
+        };
+
+        std::shared_ptr<const ParsedFile> GetOrParse(const std::string& path) const;
+        std::shared_ptr<const ParsedFile> Parse(const std::string& path, const std::string& contents) const;
+        std::string ResolveInclude(const std::string& includingFile, const std::string& include) const;
+        bool Emit(const std::string& path, Context& ctx) const;
+        static void EmitDefines(Context& ctx);
+        static int GetFileIndex(const std::string& path, Context& ctx);
+
+        std::string m_includeDirectory;
+
+        static std::mutex s_cacheMutex;
+        static std::unordered_map<std::string, std::shared_ptr<const ParsedFile>> s_cache;
+    };
+} // namespace core
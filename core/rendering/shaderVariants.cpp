@@ -0,0 +1,64 @@
+#include "shaderVariants.h"
+#include <cstdio>
+#include <utility>
+
+namespace core
+{
+    int ShaderVariants::s_maxDirectionalLights = 1;
+    bool ShaderVariants::s_legacyShadowFiltering = false;
+
+    ShaderVariants::ShaderVariants(std::string vertexPath, std::string fragmentPath)
+        : m_vertexPath(std::move(vertexPath)), m_fragmentPath(std::move(fragmentPath))
+    {
+    }
+
+    GLuint ShaderVariants::Get(std::uint32_t keywords)
+    {
+        std::uint64_t key = keywords | (static_cast<std::uint64_t>(s_maxDirectionalLights) << LIGHT_BUCKET_SHIFT)
+                                     | (static_cast<std::uint64_t>(s_legacyShadowFiltering) << LEGACY_SHADOW_SHIFT);
+
+        auto it = m_variants.find(key);
+        if (it != m_variants.end())
+            return it->second->ID;
+
+        ShaderPreprocessor::Defines defines = BuildDefines(keywords);
+
+        std::string description;
+        for (const auto& [name, value] : defines)
+            description += " " + (value.empty() ? name : name + "=" + value);
+        printf("[SHADER] Compiling variant of %s:%s\n", m_fragmentPath.c_str(), description.c_str());
+
+        auto shader = std::make_unique<Shader>(m_vertexPath.c_str(), m_fragmentPath.c_str(), defines);
+        GLuint program = shader->ID;
+        m_variants.emplace(key, std::move(shader));
+        return program;
+    }
+
+    void ShaderVariants::SetDirectionalLightCount(int count)
+    {
+        // Round up to a power of two so a handful of permutations covers every scene
+        int bucket = 0;
+        if (count > 0)
+        {
+            bucket = 1;
+            while (bucket < count)
+                bucket <<= 1;
+        }
+        s_maxDirectionalLights = bucket;
+    }
+
+    ShaderPreprocessor::Defines ShaderVariants::BuildDefines(std::uint32_t keywords) const
+    {
+        ShaderPreprocessor::Defines defines;
+        for (std::uint32_t bit = 0; bit < static_cast<std::uint32_t>(ShaderKeyword::Count); ++bit)
+        {
+            auto keyword = static_cast<ShaderKeyword>(1u << bit);
+            if (keywords & static_cast<std::uint32_t>(keyword))
+                defines.emplace_back(ToString(keyword), "");
+        }
+        defines.emplace_back("MAX_DIRECTIONAL_LIGHTS", std::to_string(s_maxDirectionalLights));
+        if (s_legacyShadowFiltering)
+            defines.emplace_back("SHADOW_LEGACY_PCF", "");
+        return defines;
+    }
+} // namespace core
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "shader.h"
+#include "shaderPreprocessor.h"
+#include <cstdint>
+#include <glad/glad.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace core
+{
+    /// <summary>
+    /// Feature keywords a material can enable. Each keyword becomes a #define in the
+    /// compiled variant, so shaders can strip the code of features that are not used.
+    /// </summary>
+    enum class ShaderKeyword : std::uint32_t
+    {
+        NormalMap = 1u << 0,        // NORMAL_MAP: sample the tangent space normal map
+        ShadowReceive = 1u << 1,    // SHADOW_RECEIVE: sample the shadow atlas and cubes for every shadowing light
+
+        // Helpful for iterating over the keywords
+        Count = 2
+    };
+
+    // Helper function to convert a keyword to the define it injects
+    inline const char* ToString(ShaderKeyword keyword)
+    {
+        switch (keyword)
+        {
+            case ShaderKeyword::NormalMap:     return "NORMAL_MAP";
+            case ShaderKeyword::ShadowReceive: return "SHADOW_RECEIVE";
+            default:                           return "UNKNOWN";
+        }
+    }
+
+    /// <summary>
+    /// A vertex/fragment shader pair compiled into #define-specialized permutations.
+    /// <para>
+    /// Variants are built lazily the first time a keyword combination is requested and cached
+    /// by a bitmask of the enabled keywords plus the current light count bucket. The light
+    /// count bucket is scene-wide and is set by the Scene before rendering, so the loop over the
+    /// directional lights has a compile-time upper bound (MAX_DIRECTIONAL_LIGHTS). Point and
+    /// spot lights are clustered and do not affect the variant. The shadow filtering mode is
+    /// scene-wide as well (SHADOW_LEGACY_PCF).
+    /// </para>
+    /// </summary>
+    class ShaderVariants
+    {
+    public:
+        /// <summary>
+        /// Creates a variant collection. No program is compiled until Get() is called.
+        /// </summary>
+        /// <param name="vertexPath">Path to the vertex shader source file.</param>
+        /// <param name="fragmentPath">Path to the fragment shader source file.</param>
+        ShaderVariants(std::string vertexPath, std::string fragmentPath);
+
+        /// <summary>
+        /// Returns the program for the given keywords and the current light count bucket,
+        /// compiling it on first use.
+        /// </summary>
+        /// <param name="keywords">Bitmask of ShaderKeyword values.</param>
+        /// <returns>
+        /// The OpenGL program ID. If compilation failed this is the unlinked program, which is kept
+        /// so hot-reloading can still fix it.
+        /// </returns>
+        GLuint Get(std::uint32_t keywords);
+
+        /// <summary>
+        /// Gets the number of permutations compiled so far.
+        /// </summary>
+        size_t GetVariantCount() const { return m_variants.size(); }
+
+        /// <summary>
+        /// Sets the number of active directional lights, used to select the light count bucket.
+        /// Called by the Scene before rendering.
+        /// </summary>
+        static void SetDirectionalLightCount(int count);
+
+        /// <summary>
+        /// Gets the upper bound of the current light count bucket (0 or a power of two).
+        /// </summary>
+        static int GetMaxDirectionalLights() { return s_maxDirectionalLights; }
+
+        /// <summary>
+        /// Selects the manual 3x3 PCF shadow lookup instead of the hardware comparison samplers.
+        /// Called by the Scene before rendering, kept for comparing the cost of both paths.
+        /// </summary>
+        static void SetLegacyShadowFiltering(bool legacy) { s_legacyShadowFiltering = legacy; }
+        static bool GetLegacyShadowFiltering() { return s_legacyShadowFiltering; }
+
+    private:
+        static constexpr int LIGHT_BUCKET_SHIFT = 32;
+        static constexpr int LEGACY_SHADOW_SHIFT = 48;
+
+        ShaderPreprocessor::Defines BuildDefines(std::uint32_t keywords) const;
+
+        std::string m_vertexPath;
+        std::string m_fragmentPath;
+        std::unordered_map<std::uint64_t, std::unique_ptr<Shader>> m_variants;  // Keyed by keywords | bucket << LIGHT_BUCKET_SHIFT | legacy << LEGACY_SHADOW_SHIFT
+
+        static int s_maxDirectionalLights;
+        static bool s_legacyShadowFiltering;
+    };
+} // namespace core
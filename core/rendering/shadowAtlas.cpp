@@ -0,0 +1,208 @@
+#include "shadowAtlas.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+namespace core
+{
+    // Storage buffer binding point, must match lighting.glsl
+    static constexpr GLuint SHADOW_BUFFER_BINDING = 4;
+
+    ShadowAtlas::ShadowAtlas(int size) : m_size(size)
+    {
+        m_depthTexture = CreateDepthTexture(m_size);
+        m_framebuffer = CreateFramebuffer(m_depthTexture);
+        m_staticDepthTexture = CreateDepthTexture(m_size);
+        m_staticFramebuffer = CreateFramebuffer(m_staticDepthTexture);
+
+        // The tile count is capped, so the buffer never has to grow
+        glGenBuffers(1, &m_shadowBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_shadowBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, MAX_TILES * sizeof(GpuShadow), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ShadowAtlas::~ShadowAtlas()
+    {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteFramebuffers(1, &m_staticFramebuffer);
+        glDeleteTextures(1, &m_depthTexture);
+        glDeleteTextures(1, &m_staticDepthTexture);
+        glDeleteBuffers(1, &m_shadowBuffer);
+    }
+
+    GLuint ShadowAtlas::CreateDepthTexture(int size)
+    {
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        // Samples are clamped to their tile in the shader, edges never show
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        SetComparison(GL_TEXTURE_2D, texture, true);
+        return texture;
+    }
+
+    void ShadowAtlas::SetComparison(GLenum target, GLuint texture, bool enabled)
+    {
+        // A comparison sampler returns the bilinear-filtered result of four depth compares
+        glBindTexture(target, texture);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, enabled ? GL_COMPARE_REF_TO_TEXTURE : GL_NONE);
+        glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, enabled ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, enabled ? GL_LINEAR : GL_NEAREST);
+        glBindTexture(target, 0);
+    }
+
+    void ShadowAtlas::SetComparisonSampling(bool enabled)
+    {
+        SetComparison(GL_TEXTURE_2D, m_depthTexture, enabled);
+    }
+
+    GLuint ShadowAtlas::CreateFramebuffer(GLuint depthTexture)
+    {
+        GLuint framebuffer = 0;
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            printf("[ERROR] Shadow atlas framebuffer not complete! Status: 0x%x\n", status);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return framebuffer;
+    }
+
+    /// <summary>
+    /// Rounds a requested tile size up to a power of two within the tile size limits.
+    /// Requests of 0 or less stay 0 (no tile).
+    /// </summary>
+    static int RoundToTileSize(int size)
+    {
+        if (size <= 0) return 0;
+        int tileSize = ShadowAtlas::MIN_TILE_SIZE;
+        while (tileSize < size && tileSize < ShadowAtlas::MAX_TILE_SIZE)
+            tileSize <<= 1;
+        return tileSize;
+    }
+
+    /// <summary>
+    /// Extracts the even bits of a Morton code.
+    /// </summary>
+    static unsigned CompactBits(unsigned value)
+    {
+        value &= 0x55555555u;
+        value = (value | (value >> 1)) & 0x33333333u;
+        value = (value | (value >> 2)) & 0x0F0F0F0Fu;
+        value = (value | (value >> 4)) & 0x00FF00FFu;
+        value = (value | (value >> 8)) & 0x0000FFFFu;
+        return value;
+    }
+
+    bool ShadowAtlas::Pack(const std::vector<int>& requestedSizes)
+    {
+        std::vector<int> sizes(requestedSizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i)
+            sizes[i] = i < MAX_TILES ? RoundToTileSize(requestedSizes[i]) : 0;
+
+        if (sizes == m_packedSizes)
+            return false;
+        m_packedSizes = sizes;
+
+        // Halve the least important of the largest tiles until the total area fits
+        long long capacity = static_cast<long long>(m_size) * m_size;
+        long long totalArea = 0;
+        for (int size : sizes)
+            totalArea += static_cast<long long>(size) * size;
+
+        while (totalArea > capacity)
+        {
+            int largest = -1;
+            for (int i = 0; i < static_cast<int>(sizes.size()); ++i)
+            {
+                if (sizes[i] > 0 && (largest < 0 || sizes[i] >= sizes[largest]))
+                    largest = i;
+            }
+
+            int oldSize = sizes[largest];
+            int newSize = oldSize / 2 >= MIN_TILE_SIZE ? oldSize / 2 : 0;
+            totalArea -= static_cast<long long>(oldSize) * oldSize - static_cast<long long>(newSize) * newSize;
+            sizes[largest] = newSize;
+        }
+
+        // Largest first, so every tile starts on a Z-order cursor aligned to its own size
+        std::vector<int> order(sizes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&sizes](int a, int b) { return sizes[a] > sizes[b]; });
+
+        m_tiles.assign(sizes.size(), Tile{});
+        unsigned cursor = 0; // In MIN_TILE_SIZE cells along the Z-order curve
+        for (int index : order)
+        {
+            int size = sizes[index];
+            if (size == 0) break;
+
+            Tile& tile = m_tiles[index];
+            tile.x = static_cast<int>(CompactBits(cursor)) * MIN_TILE_SIZE;
+            tile.y = static_cast<int>(CompactBits(cursor >> 1)) * MIN_TILE_SIZE;
+            tile.size = size;
+
+            unsigned cells = static_cast<unsigned>(size / MIN_TILE_SIZE);
+            cursor += cells * cells;
+        }
+
+        return true;
+    }
+
+    glm::vec4 ShadowAtlas::GetTileRect(int index) const
+    {
+        const Tile& tile = m_tiles[index];
+        float scale = 1.0f / static_cast<float>(m_size);
+        return glm::vec4(tile.x * scale, tile.y * scale, tile.size * scale, tile.size * scale);
+    }
+
+    void ShadowAtlas::BeginStaticTile(int index)
+    {
+        const Tile& tile = m_tiles[index];
+        glBindFramebuffer(GL_FRAMEBUFFER, m_staticFramebuffer);
+        glViewport(tile.x, tile.y, tile.size, tile.size);
+
+        // Only clear this tile, the other lights keep their cached shadows
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(tile.x, tile.y, tile.size, tile.size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    void ShadowAtlas::BeginTile(int index)
+    {
+        const Tile& tile = m_tiles[index];
+        glCopyImageSubData(m_staticDepthTexture, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+                           m_depthTexture, GL_TEXTURE_2D, 0, tile.x, tile.y, 0,
+                           tile.size, tile.size, 1);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glViewport(tile.x, tile.y, tile.size, tile.size);
+    }
+
+    void ShadowAtlas::Upload(const std::vector<GpuShadow>& shadows)
+    {
+        size_t count = std::min<size_t>(shadows.size(), MAX_TILES);
+        if (count == 0) return;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_shadowBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(GpuShadow), shadows.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void ShadowAtlas::Bind() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SHADOW_BUFFER_BINDING, m_shadowBuffer);
+    }
+} // namespace core
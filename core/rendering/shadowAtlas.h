@@ -0,0 +1,127 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace core
+{
+    /// <summary>
+    /// A single large depth texture holding the shadow maps of every shadowing light.
+    /// <para>
+    /// Each light gets a square, power-of-two tile. Tiles are packed largest first in Z-order,
+    /// which never fragments for power-of-two squares, so a request set always fits as long
+    /// as its total area does. When it does not, the least important of the largest tiles is
+    /// halved until everything fits. All tiles are rendered into the same framebuffer by
+    /// switching viewports.
+    /// </para>
+    /// <para>
+    /// A second atlas with the same layout holds the static caster layer, see Scene.
+    /// </para>
+    /// </summary>
+    /// <remarks>
+    /// GPU bindings (std430 shader storage buffer, see lighting.glsl):
+    /// - 4: ShadowBuffer, light-space matrix and atlas rectangle per tile
+    /// </remarks>
+    class ShadowAtlas
+    {
+    public:
+        static constexpr int ATLAS_SIZE = 4096;
+        static constexpr int MIN_TILE_SIZE = 256;
+        static constexpr int MAX_TILE_SIZE = 2048;
+        static constexpr int MAX_TILES = 32;
+
+        /// <summary>
+        /// Tile placement in pixels. A size of 0 means the tile did not fit.
+        /// </summary>
+        struct Tile
+        {
+            int x = 0;
+            int y = 0;
+            int size = 0;
+        };
+
+        /// <summary>
+        /// Tile layout in the ShadowBuffer SSBO.
+        /// </summary>
+        struct GpuShadow
+        {
+            glm::mat4 lightSpaceMatrix;
+            glm::vec4 atlasRect;        // xy = uv offset of the tile, zw = uv size of the tile
+            glm::vec4 cascadeRange;     // xy = view depth range covered by a directional light cascade
+
+            bool operator==(const GpuShadow&) const = default;
+        };
+
+        explicit ShadowAtlas(int size = ATLAS_SIZE);
+        ~ShadowAtlas();
+
+        ShadowAtlas(const ShadowAtlas&) = delete;
+        ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+        /// <summary>
+        /// Assigns a tile to every request. Requests are ordered by importance, so on overflow
+        /// later requests are shrunk first.
+        /// </summary>
+        /// <param name="requestedSizes">Desired tile size per light, rounded to a power of two and clamped.</param>
+        /// <returns>True if the layout differs from the previous call.</returns>
+        bool Pack(const std::vector<int>& requestedSizes);
+
+        int GetTileCount() const { return static_cast<int>(m_tiles.size()); }
+        const Tile& GetTile(int index) const { return m_tiles[index]; }
+
+        /// <summary>
+        /// Gets the tile rectangle in atlas uv space (xy = offset, zw = size).
+        /// </summary>
+        glm::vec4 GetTileRect(int index) const;
+
+        /// <summary>
+        /// Binds the static layer, sets the viewport to the tile and clears its depth.
+        /// </summary>
+        void BeginStaticTile(int index);
+
+        /// <summary>
+        /// Copies the tile of the static layer into the final atlas, then binds the final atlas
+        /// with the viewport set to the tile.
+        /// </summary>
+        void BeginTile(int index);
+
+        /// <summary>
+        /// Uploads the per-tile shader data. Only the first GetTileCount() entries are used.
+        /// </summary>
+        void Upload(const std::vector<GpuShadow>& shadows);
+
+        /// <summary>
+        /// Binds the ShadowBuffer storage buffer.
+        /// </summary>
+        void Bind() const;
+
+        /// <summary>
+        /// Switches the atlas between hardware depth comparison (sampler2DShadow, the default)
+        /// and raw depth reads for the legacy PCF path (sampler2D).
+        /// </summary>
+        void SetComparisonSampling(bool enabled);
+
+        GLuint GetTexture() const { return m_depthTexture; }
+        int GetSize() const { return m_size; }
+
+        /// <summary>
+        /// Sets the comparison mode and the matching filter of a depth texture.
+        /// </summary>
+        static void SetComparison(GLenum target, GLuint texture, bool enabled);
+
+    private:
+        static GLuint CreateDepthTexture(int size);
+        static GLuint CreateFramebuffer(GLuint depthTexture);
+
+        int m_size;
+        std::vector<Tile> m_tiles;
+        std::vector<int> m_packedSizes;     // Requests of the current layout
+
+        GLuint m_depthTexture = 0;
+        GLuint m_framebuffer = 0;
+        GLuint m_staticDepthTexture = 0;
+        GLuint m_staticFramebuffer = 0;
+        GLuint m_shadowBuffer = 0;
+    };
+} // namespace core
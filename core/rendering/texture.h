@@ -7,11 +7,28 @@ namespace core {
 
     class Texture {
     private:
-        GLuint id;
+        GLuint id = 0;
+
+        // Decoded in the constructor and uploaded on the first getId(), so textures can be
+        // loaded on a thread without a GL context
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int components = 0;
+        bool uploaded = false;
+
+        void Upload();
 
     public:
         Texture(const std::string& path);
+        ~Texture();
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
 
+        /// <summary>
+        /// Gets the GL texture, uploading the image on the first call. Call it on the render thread.
+        /// </summary>
         GLuint getId();
     };
 
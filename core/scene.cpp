@@ -1,8 +1,19 @@
 #include "ObjectSystems/Components/Light.h"
 #include "ObjectSystems/Components/Renderer.h"
 #include "ObjectSystems/GameObject.h"
+#include "Rendering/clusteredLighting.h"
+#include "Rendering/cubeShadowArray.h"
+#include "Rendering/gpuProfiler.h"
+#include "Rendering/shaderVariants.h"
+#include "Rendering/shadowAtlas.h"
 #include "Scene.h"
+#include "hash.h"
+#include "profiler.h"
 #include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <glad/glad.h>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
@@ -18,31 +29,47 @@
 namespace core
 {
     Scene::Scene(std::string name)
+        : m_componentStorage(std::make_shared<ComponentStorage>())
     {
         SetName(std::move(name));
-        depthShader = Shader("assets/shaders/depthVertex.vert", "assets/shaders/depthFragment.frag");
         // printf("[Scene] Created scene: %s\n", m_name.c_str());
     }
 
+    void Scene::CreateGpuResources()
+    {
+        FINALENGINE_PROFILE_ZONE("Scene::CreateGpuResources");
+        depthShader = Shader("assets/shaders/depthVertex.vert", "assets/shaders/depthFragment.frag");
+        cubeDepthShader = Shader("assets/shaders/depthCube.vert", "assets/shaders/depthCube.frag", "assets/shaders/depthCube.geom", {});
+        prepassShader = Shader("assets/shaders/depthPrepass.vert", "assets/shaders/depthFragment.frag");
+        m_clusteredLighting = std::make_unique<ClusteredLighting>();
+        m_shadowAtlas = std::make_unique<ShadowAtlas>();
+        m_cubeShadows = std::make_unique<CubeShadowArray>();
+        m_shadowAtlas->SetComparisonSampling(!m_legacyShadowFiltering);
+        m_cubeShadows->SetComparisonSampling(!m_legacyShadowFiltering);
+    }
+
+    Scene::~Scene() = default;
+
     void Scene::SetName(std::string name) { m_name = std::move(name); }
     const std::string& Scene::GetName() const { return m_name; }
 
     void Scene::AddRootGameObject(const std::shared_ptr<GameObject>& go)
     {
         if (!go) return;
-        if (std::find(m_roots.begin(), m_roots.end(), go) == m_roots.end())
+        if (m_rootSet.insert(go.get()).second)
             m_roots.push_back(go);
     }
 
     void Scene::RemoveRootGameObject(const std::shared_ptr<GameObject>& go)
     {
-        if (!go) return;
+        // Every new child passes through here, skip the search unless it really is a root
+        if (!go || m_rootSet.erase(go.get()) == 0) return;
         m_roots.erase(std::remove(m_roots.begin(), m_roots.end(), go), m_roots.end());
     }
 
     std::shared_ptr<GameObject> Scene::CreateObject(const std::string& name, const std::shared_ptr<core::GameObject> parent)
     {
-        auto newObject = GameObject::Create(name);
+        auto newObject = GameObject::Create(name, shared_from_this());
         if (parent)
         {
             newObject->SetParent(parent);
@@ -56,8 +83,27 @@ namespace core
 
     const std::vector<std::shared_ptr<GameObject>>& Scene::Roots() const { return m_roots; }
 
+    void Scene::Update(const float deltaTime)
+    {
+        FINALENGINE_PROFILE_ZONE("Scene::Update");
+        for (const auto& callback : m_updateCallbacks)
+            callback(deltaTime);
+    }
+
+    void Scene::SetLegacyShadowFiltering(bool legacy)
+    {
+        if (legacy == m_legacyShadowFiltering) return;
+        m_legacyShadowFiltering = legacy;
+        if (!m_shadowAtlas) return;    // Applied once the GPU resources exist
+
+        // The legacy path reads raw depth, comparison samplers would return 0 or 1 instead
+        m_shadowAtlas->SetComparisonSampling(!legacy);
+        m_cubeShadows->SetComparisonSampling(!legacy);
+    }
+
     void Scene::Render(const glm::mat4& view, const glm::mat4& projection)
     {
+        FINALENGINE_PROFILE_ZONE("Scene::Render");
         // printf("\n=== Scene::Render START ===\n");
         // printf("[Render] Renderers: %zu, Lights: %zu\n", m_renderers.size(), m_lights.size());
         
@@ -67,15 +113,8 @@ namespace core
             return;
         }
 
-        // Setting light data UBO
-        LightData lightData = {};
-        lightData.numLights = static_cast<int>(m_lights.size() < 4 ? m_lights.size() : 4);
-
-        if (m_depthMaps.size() < lightData.numLights)
-        {
-            // printf("[Render] Generating depth maps for %d lights\n", lightData.numLights);
-            GenerateDepthMaps(lightData.numLights, SHADOW_WIDTH, SHADOW_HEIGHT);
-        }
+        if (!m_clusteredLighting)
+            CreateGpuResources();
 
         // Save current viewport dimensions AND framebuffer binding
         GLint viewport[4];
@@ -85,8 +124,39 @@ namespace core
         // printf("[Render] Current viewport: %d x %d at (%d, %d), Framebuffer: %d\n", 
         //        viewport[2], viewport[3], viewport[0], viewport[1], previousFramebuffer);
 
-        // Pass 1: Render shadow maps
-        for (size_t i = 0; i < m_lights.size() && i < 4; ++i)
+        // Pass 1: Update the shadow atlas and cubes, only shadows whose light or casters changed are re-rendered
+        GpuProfiler::Begin("Shadows");
+        FINALENGINE_PROFILE_ZONE("Scene::UpdateShadows");
+        CollectShadowCasters();
+        AssignShadowTiles(view, projection);
+        m_shadowMapUpdates = 0;
+        m_shadowCasterCounts.assign(m_lights.size(), -1);
+        m_gpuShadows.resize(m_shadowTiles.size());
+        for (int tile = 0; tile < static_cast<int>(m_shadowTiles.size()); ++tile)
+        {
+            // printf("[Render] Rendering shadow tile %d for light %d\n", tile, m_shadowTiles[tile].lightIndex);
+            UpdateShadowMap(tile, view, projection);
+        }
+        UpdateCubeShadowMaps();
+        GpuProfiler::End();
+
+        if (m_gpuShadows != m_uploadedShadows)
+        {
+            m_shadowAtlas->Upload(m_gpuShadows);
+            m_uploadedShadows = m_gpuShadows;
+        }
+        m_shadowAtlas->Bind();
+
+        // Restore viewport AND framebuffer
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        // printf("[Render] Restored viewport: %d x %d, Framebuffer: %d\n", 
+        //        viewport[2], viewport[3], previousFramebuffer);
+
+        // Collect every light for the clustered lighting, directional lights are not clustered
+        LightData lightData = {};
+        m_clusteredLighting->Clear();
+        for (size_t i = 0; i < m_lights.size(); ++i)
         {
             auto light = m_lights[i];
             if (!light || !light->isEnabled) continue;
@@ -94,29 +164,45 @@ namespace core
             auto lightGO = light->GetOwner();
             if (!lightGO || !lightGO->transform) continue;
 
-            lightData.positions[i] = glm::vec4(lightGO->transform->position, 1.0f);
-            lightData.directions[i] = glm::vec4(lightGO->transform->forward(), 0.0f);
-            
             glm::vec4 lightColor = light->GetColor();
             lightColor.w = light->intensity.Get(); // Store intensity in alpha channel
-            lightData.colors[i] = lightColor;
-            
-            lightData.lightTypes[i] = glm::ivec4(ToInt(light->lightType.Get()), 0, 0, 0);
+            const glm::ivec4& shadow = m_lightShadows[i];
 
-            // printf("[Render] Rendering shadow map for light %zu (type: %d)\n", i, ToInt(light->lightType.Get()));
-            RenderShadowMap(i);
+            switch (light->lightType.Get())
+            {
+            case LightType::Directional:
+                m_clusteredLighting->AddDirectional(lightGO->transform->forward(), lightColor, shadow);
+                break;
+            case LightType::Point:
+                m_clusteredLighting->AddLocal(lightGO->transform->position, lightGO->transform->forward(), lightColor, light->range.Get(), POINT_LIGHT_CUTOFF, shadow);
+                break;
+            case LightType::Spot:
+                m_clusteredLighting->AddLocal(lightGO->transform->position, lightGO->transform->forward(), lightColor, light->range.Get(), SPOT_LIGHT_CUTOFF, shadow);
+                break;
+            default:
+                break;
+            }
         }
 
-        // Restore viewport AND framebuffer
-        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
-        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
-        // printf("[Render] Restored viewport: %d x %d, Framebuffer: %d\n", 
-        //        viewport[2], viewport[3], previousFramebuffer);
+        {
+            FINALENGINE_PROFILE_ZONE("ClusteredLighting::Build");
+            m_clusteredLighting->Build(view, projection, viewport[2], viewport[3], lightData);
+        }
+        m_clusteredLighting->Bind();
 
-        // Upload light data to UBO
-        glBindBuffer(GL_UNIFORM_BUFFER, m_uboLights);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightData), &lightData);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        // Selects the MAX_DIRECTIONAL_LIGHTS bucket of the shader variants used by this frame
+        ShaderVariants::SetDirectionalLightCount(m_clusteredLighting->GetDirectionalCount());
+        ShaderVariants::SetLegacyShadowFiltering(m_legacyShadowFiltering);
+
+        // Upload light data to UBO, skipped while the camera and lights stand still
+        if (!m_lightDataUploaded || std::memcmp(&lightData, &m_uploadedLightData, sizeof(LightData)) != 0)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, m_uboLights);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightData), &lightData);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            m_uploadedLightData = lightData;
+            m_lightDataUploaded = true;
+        }
 
         // Check for OpenGL errors before final render
         GLenum err = glGetError();
@@ -139,111 +225,504 @@ namespace core
         // printf("=== Scene::Render END ===\n\n");
     }
 
-    void Scene::RenderShadowMap(int lightIndex)
+    void Scene::CollectShadowCasters()
     {
-        // printf("  [ShadowMap] Rendering shadow map for light %d\n", lightIndex);
-        
-        if (lightIndex >= m_lights.size()) return;
-        auto light = m_lights[lightIndex];
-        if (!light || !light->isEnabled) return;
+        m_shadowCasters.clear();
+        Query<Renderer>([this](const GameObject& go, const Renderer& renderer)
+        {
+            if (!go.isEnabled || !renderer.isEnabled || !renderer.castShadows.Get()) return;
+
+            ShadowCaster caster;
+            caster.renderer = &renderer;
+            caster.worldMatrix = CalculateWorldMatrix(go);
+            caster.worldBounds = renderer.GetWorldBounds(caster.worldMatrix);
+            caster.isStatic = renderer.isStatic.Get();
+            m_shadowCasters.push_back(caster);
+        });
+    }
 
-        auto lightGO = light->GetOwner();
-        if (!lightGO || !lightGO->transform) return;
+    glm::mat4 Scene::CalculateLightSpaceMatrix(const Light& light, const GameObject& lightGO) const
+    {
+        // Spot lights only, the frustum matches the cone and the range of the light
+        float near_plane = 0.1f, far_plane = std::max(light.range.Get(), near_plane * 2.0f);
+        float fieldOfView = 2.0f * std::acos(SPOT_LIGHT_CUTOFF);
+        glm::mat4 lightProjection = glm::perspective(fieldOfView, 1.0f, near_plane, far_plane);
+
+        glm::vec3 forward = lightGO.transform->forward();
+        glm::vec3 up = std::abs(forward.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(lightGO.transform->position, lightGO.transform->position + forward, up);
+        return lightProjection * lightView;
+    }
 
-        glm::mat4 lightProjection, lightView, lightSpaceMatrix;
-        float near_plane = 1.0f, far_plane = 25.0f;
+    float Scene::CalculateCascadeSplit(int cascade, int cascadeCount, float nearPlane, float farPlane) const
+    {
+        // Practical split scheme: blend of the logarithmic and the uniform split
+        float fraction = static_cast<float>(cascade) / static_cast<float>(cascadeCount);
+        float logSplit = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float uniformSplit = nearPlane + (farPlane - nearPlane) * fraction;
+        return m_cascadeSplitLambda * logSplit + (1.0f - m_cascadeSplitLambda) * uniformSplit;
+    }
+
+    glm::mat4 Scene::CalculateCascadeMatrix(const glm::vec3& lightDir, float splitNear, float splitFar, int tileSize,
+                                            const glm::mat4& view, const glm::mat4& projection) const
+    {
+        // World-space corners of the camera frustum slice
+        glm::mat4 inverseView = glm::inverse(view);
+        float tanHalfX = 1.0f / projection[0][0];
+        float tanHalfY = 1.0f / projection[1][1];
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 8; ++i)
+        {
+            float depth = i & 4 ? splitFar : splitNear;
+            float x = (i & 1 ? 1.0f : -1.0f) * tanHalfX * depth;
+            float y = (i & 2 ? 1.0f : -1.0f) * tanHalfY * depth;
+            corners[i] = glm::vec3(inverseView * glm::vec4(x, y, -depth, 1.0f));
+            center += corners[i] / 8.0f;
+        }
+
+        // Bounding sphere of the slice, its size does not change when the camera rotates
+        float radius = 0.0f;
+        for (const auto& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // A fixed light orientation gives a stable frame to snap in
+        glm::vec3 up = std::abs(lightDir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), lightDir, up);
+
+        // Snap the center to whole texels so the shadow edges do not shimmer when the camera moves
+        glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+        float texelSize = 2.0f * radius / static_cast<float>(tileSize);
+        lightCenter.x = std::floor(lightCenter.x / texelSize) * texelSize;
+        lightCenter.y = std::floor(lightCenter.y / texelSize) * texelSize;
+
+        // The depth range covers the slice, extended toward the light (+z) by the casters that can shade it
+        float minZ = lightCenter.z - radius;
+        float maxZ = lightCenter.z + radius;
+        float casterMaxZ = maxZ;
+        for (const auto& caster : m_shadowCasters)
+        {
+            Bounds bounds = caster.worldBounds.Transformed(lightView);
+            if (bounds.max.x < lightCenter.x - radius || bounds.min.x > lightCenter.x + radius ||
+                bounds.max.y < lightCenter.y - radius || bounds.min.y > lightCenter.y + radius ||
+                bounds.max.z < minZ)
+                continue;
+            casterMaxZ = std::max(casterMaxZ, bounds.max.z);
+        }
+
+        // Grow in coarse steps, so small caster movements keep the matrix (and the cached static layer)
+        float zStep = radius * 0.5f;
+        maxZ += std::ceil((casterMaxZ - maxZ) / zStep) * zStep;
+
+        glm::mat4 lightProjection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+                                               lightCenter.y - radius, lightCenter.y + radius,
+                                               -maxZ, -minZ);
+        return lightProjection * lightView;
+    }
+
+    /// <summary>
+    /// Conservative test whether a world-space box can land inside the clip volume of a light,
+    /// the ortho box of a directional light or the frustum of a spot light.
+    /// </summary>
+    static bool IntersectsLightVolume(const Bounds& bounds, const glm::mat4& lightSpaceMatrix)
+    {
+        if (!bounds.IsValid()) return false;
 
+        // The six clip planes are the last row of the matrix plus or minus one of the others
+        glm::vec4 lastRow(lightSpaceMatrix[0][3], lightSpaceMatrix[1][3], lightSpaceMatrix[2][3], lightSpaceMatrix[3][3]);
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            int axis = plane / 2;
+            glm::vec4 row(lightSpaceMatrix[0][axis], lightSpaceMatrix[1][axis], lightSpaceMatrix[2][axis], lightSpaceMatrix[3][axis]);
+            glm::vec4 equation = plane % 2 == 0 ? lastRow + row : lastRow - row;
+
+            // The box corner furthest along the plane normal, if it is outside the whole box is
+            glm::vec3 corner(equation.x >= 0.0f ? bounds.max.x : bounds.min.x,
+                             equation.y >= 0.0f ? bounds.max.y : bounds.min.y,
+                             equation.z >= 0.0f ? bounds.max.z : bounds.min.z);
+            if (glm::dot(glm::vec3(equation), corner) + equation.w < 0.0f)
+                return false;
+        }
+
+        return true;
+    }
+
+    int Scene::CalculateShadowTileSize(const Light& light, const GameObject& lightGO, const glm::mat4& view, const glm::mat4& projection) const
+    {
+        // Directional lights cover everything the camera sees
+        if (light.lightType.Get() == LightType::Directional)
+            return ShadowAtlas::MAX_TILE_SIZE;
+
+        // Spot lights are sized by the screen height covered by their range sphere
+        constexpr int maxLocalSize = ShadowAtlas::MAX_TILE_SIZE / 2;
+        float distance = glm::length(glm::vec3(view * glm::vec4(lightGO.transform->position, 1.0f)));
+        float range = light.range.Get();
+        if (distance <= range)
+            return maxLocalSize;
+
+        float coverage = range * projection[1][1] / std::sqrt(distance * distance - range * range);
+        return std::min(static_cast<int>(coverage * maxLocalSize), maxLocalSize);
+    }
+
+    void Scene::AssignShadowTiles(const glm::mat4& view, const glm::mat4& projection)
+    {
+        struct ShadowRequest
+        {
+            int lightIndex;
+            int tileSize;
+            int tileCount;  // Cascades of a directional light, 1 otherwise
+        };
+
+        // The first MAX_SHADOW_LIGHTS enabled lights cast shadows, every light is shaded through the clusters.
+        // Point lights get a shadow cube, the other lights get atlas tiles.
+        std::vector<ShadowRequest> requests;
+        m_shadowCubes.clear();
+        int freeTiles = ShadowAtlas::MAX_TILES;
+        for (size_t i = 0; i < m_lights.size() && requests.size() + m_shadowCubes.size() < MAX_SHADOW_LIGHTS; ++i)
+        {
+            auto light = m_lights[i];
+            if (!light || !light->isEnabled) continue;
+
+            auto lightGO = light->GetOwner();
+            if (!lightGO || !lightGO->transform) continue;
+
+            if (light->lightType.Get() == LightType::Point)
+            {
+                if (m_shadowCubes.size() < CubeShadowArray::MAX_CUBES)
+                    m_shadowCubes.push_back(static_cast<int>(i));
+                continue;
+            }
+
+            int tileCount = 1;
+            if (light->lightType.Get() == LightType::Directional)
+                tileCount = std::clamp(light->shadowCascades.Get(), MIN_SHADOW_CASCADES, MAX_SHADOW_CASCADES);
+            if (tileCount > freeTiles) break;
+            freeTiles -= tileCount;
+
+            requests.push_back({ static_cast<int>(i), CalculateShadowTileSize(*light, *lightGO, view, projection), tileCount });
+        }
+
+        // Most important first, the atlas shrinks the tiles at the end of the list on overflow.
+        // The cascades of a light stay next to each other, the shader indexes them from the first one.
+        std::stable_sort(requests.begin(), requests.end(), [](const ShadowRequest& a, const ShadowRequest& b) { return a.tileSize > b.tileSize; });
+
+        m_shadowTiles.clear();
+        std::vector<int> requestedSizes;
+        for (const auto& request : requests)
+        {
+            for (int cascade = 0; cascade < request.tileCount; ++cascade)
+            {
+                m_shadowTiles.push_back({ request.lightIndex, cascade, request.tileCount });
+                requestedSizes.push_back(request.tileSize);
+            }
+        }
+
+        m_shadowAtlas->Pack(requestedSizes);
+
+        // Lights whose tiles did not fit render without shadows, cascades that did not fit are dropped
+        m_lightShadows.assign(m_lights.size(), glm::ivec4(-1, 0, 0, 0));
+        int firstTile = 0;
+        for (const auto& request : requests)
+        {
+            int fittedTiles = 0;
+            while (fittedTiles < request.tileCount && m_shadowAtlas->GetTile(firstTile + fittedTiles).size > 0)
+                ++fittedTiles;
+
+            if (fittedTiles > 0)
+            {
+                bool blend = request.tileCount > 1 && m_lights[request.lightIndex]->blendCascades.Get();
+                m_lightShadows[request.lightIndex] = glm::ivec4(firstTile, fittedTiles, blend ? 1 : 0, 0);
+            }
+            firstTile += request.tileCount;
+        }
+
+        // Marked with w = 1, the shader samples the cube array instead of the atlas
+        for (int cube = 0; cube < static_cast<int>(m_shadowCubes.size()); ++cube)
+            m_lightShadows[m_shadowCubes[cube]] = glm::ivec4(cube, 0, 0, 1);
+
+        if (m_shadowCache.size() < m_shadowTiles.size())
+            m_shadowCache.resize(m_shadowTiles.size());
+        if (m_cubeShadowCache.size() < m_shadowCubes.size())
+            m_cubeShadowCache.resize(m_shadowCubes.size());
+    }
+
+    void Scene::UpdateShadowMap(int tileIndex, const glm::mat4& view, const glm::mat4& projection)
+    {
+        const ShadowTileAssignment& assignment = m_shadowTiles[tileIndex];
+        auto light = m_lights[assignment.lightIndex];
+        auto lightGO = light->GetOwner();
+        const ShadowAtlas::Tile& tile = m_shadowAtlas->GetTile(tileIndex);
+
+        glm::mat4 lightSpaceMatrix;
+        glm::vec4 cascadeRange(0.0f);
         if (light->lightType.Get() == LightType::Directional)
         {
-            lightProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, near_plane, far_plane);
-            glm::vec3 lightDir = lightGO->transform->forward();
-            glm::vec3 lightPos = -lightDir * 10.0f;
-            lightView = glm::lookAt(lightPos, lightPos + lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
-            // printf("  [ShadowMap] Using directional light projection\n");
+            // Camera clip planes, recovered from the perspective matrix
+            float cameraNear = projection[3][2] / (projection[2][2] - 1.0f);
+            float cameraFar = projection[3][2] / (projection[2][2] + 1.0f);
+            float shadowFar = std::min(cameraFar, m_shadowDistance);
+
+            float splitNear = CalculateCascadeSplit(assignment.cascade, assignment.cascadeCount, cameraNear, shadowFar);
+            float splitFar = CalculateCascadeSplit(assignment.cascade + 1, assignment.cascadeCount, cameraNear, shadowFar);
+            cascadeRange = glm::vec4(splitNear, splitFar, 0.0f, 0.0f);
+
+            int tileSize = tile.size > 0 ? tile.size : ShadowAtlas::MIN_TILE_SIZE;
+            lightSpaceMatrix = CalculateCascadeMatrix(lightGO->transform->forward(), splitNear, splitFar, tileSize, view, projection);
         }
         else
         {
-            lightProjection = glm::perspective(glm::radians(90.0f), 1.0f, near_plane, far_plane);
-            lightView = glm::lookAt(lightGO->transform->position,
-                                    lightGO->transform->position + lightGO->transform->forward(),
-                                    glm::vec3(0.0f, 1.0f, 0.0f));
-            // printf("  [ShadowMap] Using perspective projection\n");
+            lightSpaceMatrix = CalculateLightSpaceMatrix(*light, *lightGO);
         }
 
-        lightSpaceMatrix = lightProjection * lightView;
+        m_gpuShadows[tileIndex] = { lightSpaceMatrix, m_shadowAtlas->GetTileRect(tileIndex), cascadeRange };
+        if (tile.size == 0) return;
+
+        // Sign everything that ends up in this tile, split into the static and dynamic layer
+        std::uint64_t lightHash = hash::HashValue(hash::FNV_OFFSET, lightSpaceMatrix);
+        lightHash = hash::HashValue(lightHash, tile);
+        std::uint64_t staticHash = hash::FNV_OFFSET;
+        std::uint64_t dynamicHash = hash::FNV_OFFSET;
+        m_staticCasters.clear();
+        m_dynamicCasters.clear();
+        for (const auto& caster : m_shadowCasters)
+        {
+            if (!IntersectsLightVolume(caster.worldBounds, lightSpaceMatrix)) continue;
+
+            std::uint64_t& layerHash = caster.isStatic ? staticHash : dynamicHash;
+            layerHash = hash::HashValue(layerHash, caster.renderer);
+            layerHash = hash::HashValue(layerHash, caster.worldMatrix);
+            for (const auto& mesh : caster.renderer->GetMeshes())
+                layerHash = hash::HashValue(layerHash, mesh.GetVertexArray());
+
+            (caster.isStatic ? m_staticCasters : m_dynamicCasters).push_back(&caster);
+        }
+
+        int& casterCount = m_shadowCasterCounts[assignment.lightIndex];
+        casterCount = std::max(casterCount, 0) + static_cast<int>(m_staticCasters.size() + m_dynamicCasters.size());
+
+        ShadowCacheEntry& cache = m_shadowCache[tileIndex];
+        bool staticDirty = !cache.valid || cache.lightHash != lightHash || cache.staticHash != staticHash;
+        bool dynamicDirty = staticDirty || cache.dynamicHash != dynamicHash;
+        if (!dynamicDirty) return; // Nothing relevant changed, the previous tile is still correct
+
+        // Timed per light, the cascades of a directional light add up under its name
+        GpuProfiler::Scope profileScope("Shadow " + lightGO->name);
 
         // Render scene from light's point of view
         depthShader.use();
         depthShader.setMat4("lightSpaceMatrix", lightSpaceMatrix);
+        glCullFace(GL_FRONT);
 
-        glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-        glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBOs[lightIndex]);
-        
-        // Check framebuffer status
-        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-        if (status != GL_FRAMEBUFFER_COMPLETE)
+        if (staticDirty)
         {
-            printf("  [ERROR] Shadow map framebuffer incomplete! Status: 0x%x\n", status);
+            m_shadowAtlas->BeginStaticTile(tileIndex);
+            DrawShadowCasters(m_staticCasters);
         }
-        
-        glClear(GL_DEPTH_BUFFER_BIT);
 
-        glCullFace(GL_FRONT);
+        // The final tile starts as a copy of the static layer, the dynamic casters go on top
+        m_shadowAtlas->BeginTile(tileIndex);
+        DrawShadowCasters(m_dynamicCasters);
 
-        // int renderedCount = 0;
-        for (const auto& renderer : m_renderers)
-        {
-            if (!renderer) continue;
-            auto go = renderer->GetOwner();
-            if (!go || !go->isEnabled || !renderer->isEnabled) continue;
-            glm::mat4 modelMatrix = CalculateWorldMatrix(go);
-            depthShader.setMat4("modelMatrix", modelMatrix);
+        glCullFace(GL_BACK);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-            for (auto& mesh : renderer->GetMeshes())
+        cache.lightHash = lightHash;
+        cache.staticHash = staticHash;
+        cache.dynamicHash = dynamicHash;
+        cache.valid = true;
+        m_shadowMapUpdates++;
+    }
+
+    void Scene::DrawShadowCasters(const std::vector<const ShadowCaster*>& casters)
+    {
+        for (const ShadowCaster* caster : casters)
+        {
+            depthShader.setMat4("modelMatrix", caster->worldMatrix);
+            for (auto& mesh : caster->renderer->GetMeshes())
             {
                 mesh.Render(GL_TRIANGLES);
-                // renderedCount++;
             }
         }
-        // printf("  [ShadowMap] Rendered %d meshes to shadow map\n", renderedCount);
+    }
+
+    /// <summary>
+    /// Whether a world-space box overlaps the range sphere of a point light.
+    /// </summary>
+    static bool IntersectsSphere(const Bounds& bounds, const glm::vec3& center, float radius)
+    {
+        if (!bounds.IsValid()) return false;
+
+        glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+        glm::vec3 offset = closest - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+
+    void Scene::UpdateCubeShadowMaps()
+    {
+        m_casterCubeMasks.assign(m_shadowCasters.size(), 0u);
+
+        // Sign every cube, and record which cubes each caster can shade
+        unsigned staticDirtyMask = 0;
+        unsigned dynamicDirtyMask = 0;
+        glm::vec4 cubeLights[CubeShadowArray::MAX_CUBES] = {};
+        for (int cube = 0; cube < static_cast<int>(m_shadowCubes.size()); ++cube)
+        {
+            auto light = m_lights[m_shadowCubes[cube]];
+            auto lightGO = light->GetOwner();
+            cubeLights[cube] = glm::vec4(lightGO->transform->position, light->range.Get());
+
+            std::uint64_t lightHash = hash::HashValue(hash::FNV_OFFSET, cubeLights[cube]);
+            std::uint64_t staticHash = hash::FNV_OFFSET;
+            std::uint64_t dynamicHash = hash::FNV_OFFSET;
+            int& casterCount = m_shadowCasterCounts[m_shadowCubes[cube]];
+            casterCount = 0;
+            for (size_t i = 0; i < m_shadowCasters.size(); ++i)
+            {
+                const ShadowCaster& caster = m_shadowCasters[i];
+                if (!IntersectsSphere(caster.worldBounds, glm::vec3(cubeLights[cube]), cubeLights[cube].w)) continue;
+
+                std::uint64_t& layerHash = caster.isStatic ? staticHash : dynamicHash;
+                layerHash = hash::HashValue(layerHash, caster.renderer);
+                layerHash = hash::HashValue(layerHash, caster.worldMatrix);
+                for (const auto& mesh : caster.renderer->GetMeshes())
+                    layerHash = hash::HashValue(layerHash, mesh.GetVertexArray());
+
+                m_casterCubeMasks[i] |= 1u << cube;
+                casterCount++;
+            }
+
+            ShadowCacheEntry& cache = m_cubeShadowCache[cube];
+            bool staticDirty = !cache.valid || cache.lightHash != lightHash || cache.staticHash != staticHash;
+            bool dynamicDirty = staticDirty || cache.dynamicHash != dynamicHash;
+            if (staticDirty) staticDirtyMask |= 1u << cube;
+            if (dynamicDirty) dynamicDirtyMask |= 1u << cube;
+
+            cache.lightHash = lightHash;
+            cache.staticHash = staticHash;
+            cache.dynamicHash = dynamicHash;
+            cache.valid = true;
+        }
+
+        if (dynamicDirtyMask == 0) return; // Every cube is still correct
+
+        // All dirty cubes render in one layered pass, so they share one timing
+        GpuProfiler::Scope profileScope("Point Shadow Cubes");
+
+        cubeDepthShader.use();
+        glUniform4fv(glGetUniformLocation(cubeDepthShader.ID, "cubeLights"), CubeShadowArray::MAX_CUBES, &cubeLights[0][0]);
+        glCullFace(GL_FRONT);
+
+        if (staticDirtyMask != 0)
+        {
+            m_cubeShadows->BeginStaticPass(staticDirtyMask);
+            DrawCubeShadowCasters(true, staticDirtyMask);
+        }
+
+        // The final cubes start as a copy of the static layer, the dynamic casters go on top
+        m_cubeShadows->BeginPass(dynamicDirtyMask);
+        DrawCubeShadowCasters(false, dynamicDirtyMask);
 
         glCullFace(GL_BACK);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        m_lightSpaceMatrices[lightIndex] = lightSpaceMatrix;
+        m_shadowMapUpdates += std::popcount(dynamicDirtyMask);
+    }
+
+    void Scene::DrawCubeShadowCasters(bool isStatic, unsigned cubeMask)
+    {
+        GLint cubeSlotsLocation = glGetUniformLocation(cubeDepthShader.ID, "cubeSlots");
+        for (size_t i = 0; i < m_shadowCasters.size(); ++i)
+        {
+            const ShadowCaster& caster = m_shadowCasters[i];
+            unsigned casterCubes = m_casterCubeMasks[i] & cubeMask;
+            if (caster.isStatic != isStatic || casterCubes == 0) continue;
+
+            // One instance per cube that sees the caster
+            GLint cubeSlots[CubeShadowArray::MAX_CUBES];
+            int instanceCount = 0;
+            for (int cube = 0; cube < CubeShadowArray::MAX_CUBES; ++cube)
+            {
+                if (casterCubes & (1u << cube))
+                    cubeSlots[instanceCount++] = cube;
+            }
+
+            cubeDepthShader.setMat4("modelMatrix", caster.worldMatrix);
+            glUniform1iv(cubeSlotsLocation, instanceCount, cubeSlots);
+            for (auto& mesh : caster.renderer->GetMeshes())
+            {
+                mesh.RenderInstanced(GL_TRIANGLES, instanceCount);
+            }
+        }
+    }
+
+    void Scene::RenderDepthPrepass(const glm::mat4& view, const glm::mat4& projection)
+    {
+        GpuProfiler::Scope profileScope("Depth Prepass");
+
+        // Front to back, so the prepass itself rejects most hidden fragments early
+        m_prepassOrder.clear();
+        for (const auto& draw : m_sceneDraws)
+            m_prepassOrder.push_back(&draw);
+        std::sort(m_prepassOrder.begin(), m_prepassOrder.end(),
+                  [](const SceneDraw* a, const SceneDraw* b) { return a->viewDepth < b->viewDepth; });
+
+        prepassShader.use();
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+        for (const SceneDraw* draw : m_prepassOrder)
+        {
+            prepassShader.setMat4("mvpMatrix", projection * view * draw->worldMatrix);
+            for (auto& mesh : draw->renderer->GetMeshes())
+            {
+                mesh.Render(GL_TRIANGLES);
+            }
+        }
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     }
 
     void Scene::RenderFinalScene(const glm::mat4& view, const glm::mat4& projection)
     {
+        FINALENGINE_PROFILE_ZONE("Scene::RenderFinalScene");
+        m_sceneDraws.clear();
+        Query<Renderer>([this, &view](const GameObject& go, const Renderer& renderer)
+        {
+            if (!go.isEnabled) return;
+            if (!renderer.isEnabled) return;
+            if (!renderer.GetMaterial()) return;
+
+            SceneDraw draw;
+            draw.renderer = &renderer;
+            draw.worldMatrix = CalculateWorldMatrix(go);
+            Bounds bounds = renderer.GetWorldBounds(draw.worldMatrix);
+            glm::vec3 center = bounds.IsValid() ? bounds.GetCenter() : glm::vec3(draw.worldMatrix[3]);
+            draw.viewDepth = -(view * glm::vec4(center, 1.0f)).z;
+            m_sceneDraws.push_back(draw);
+        });
+
+        // With the depth laid down, the lit pass only shades fragments that match it
+        if (m_depthPrepass)
+        {
+            RenderDepthPrepass(view, projection);
+            glDepthMask(GL_FALSE);
+            glDepthFunc(GL_LEQUAL);
+        }
+
         // Rendering all renderers
-        for (const auto& renderer : m_renderers)
+        GpuProfiler::Scope profileScope("Forward");
+        for (const auto& draw : m_sceneDraws)
         {
-            if (!renderer) continue;
-            
+            const Renderer* renderer = draw.renderer;
             auto go = renderer->GetOwner();
-            if (!go) continue;
-            
-            if (!go->isEnabled) continue;
-            if (!renderer->isEnabled) continue;
-
-            glm::mat4 worldMatrix = CalculateWorldMatrix(go);
+            const glm::mat4& worldMatrix = draw.worldMatrix;
             glm::mat4 mvp = projection * view * worldMatrix;
 
             auto material = renderer->GetMaterial();
-            if (!material) continue;
 
             // Set matrices
             material->SetMat4("mvpMatrix", mvp);
             material->SetMat4("modelMatrix", worldMatrix);
             
-            // Set bloom threshold for materials that use it
-            material->SetFloat("bloomThreshold", m_bloomThreshold);
-            
-            // Pass light space matrix and shadow map only if we have lights
-            if (!m_lightSpaceMatrices.empty() && !m_depthMaps.empty())
-            {
-                material->SetMat4("lightSpaceMatrix", m_lightSpaceMatrices[0]);
-            }
-            
             // Check OpenGL error before rendering
             GLenum err = glGetError();
             if (err != GL_NO_ERROR)
@@ -254,18 +733,24 @@ namespace core
             // Call material->Use() which will bind textures and set uniforms
             material->Use();
             
-            // IMPORTANT: Bind shadow map AFTER Material::Use() because Material::Use() binds its textures
-            if (!m_depthMaps.empty())
+            // IMPORTANT: Bind the shadow atlas AFTER Material::Use() because Material::Use() binds its textures
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, m_shadowAtlas->GetTexture());
+
+            // Set the uniform to point to texture unit 3
+            GLint shadowMapLoc = glGetUniformLocation(material->GetShaderProgram(), "shadowMap");
+            if (shadowMapLoc != -1)
+            {
+                glUniform1i(shadowMapLoc, 3);
+            }
+
+            // Point light shadow cubes on texture unit 4
+            glActiveTexture(GL_TEXTURE4);
+            glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_cubeShadows->GetTexture());
+            GLint pointShadowMapsLoc = glGetUniformLocation(material->GetShaderProgram(), "pointShadowMaps");
+            if (pointShadowMapsLoc != -1)
             {
-                glActiveTexture(GL_TEXTURE3);
-                glBindTexture(GL_TEXTURE_2D, m_depthMaps[0]);
-                
-                // Set the uniform to point to texture unit 3
-                GLint shadowMapLoc = glGetUniformLocation(material->GetShaderProgram(), "shadowMap");
-                if (shadowMapLoc != -1)
-                {
-                    glUniform1i(shadowMapLoc, 3);
-                }
+                glUniform1i(pointShadowMapsLoc, 4);
             }
             
             // Now render the meshes
@@ -281,85 +766,32 @@ namespace core
                 printf("  [ERROR] OpenGL error after rendering %s: 0x%x\n", go->name.c_str(), err);
             }
         }
+
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
     }
 
     glm::mat4 Scene::CalculateWorldMatrix(const std::shared_ptr<GameObject>& go)
     {
         if (!go) return glm::mat4(1.0f);
+        return CalculateWorldMatrix(*go);
+    }
 
+    glm::mat4 Scene::CalculateWorldMatrix(const GameObject& go)
+    {
         // Get local transform
         glm::mat4 localMatrix = glm::mat4(1.0f);
-        if (go->transform)
+        if (go.transform)
         {
-            localMatrix = go->transform->GetLocalMatrix();
+            localMatrix = go.transform->GetLocalMatrix();
         }
 
         // If has parent, multiply by parent's world matrix
-        if (auto parent = go->GetParent().lock())
+        if (auto parent = go.GetParent().lock())
         {
-            return CalculateWorldMatrix(parent) * localMatrix;
+            return CalculateWorldMatrix(*parent) * localMatrix;
         }
 
         return localMatrix;
     }
-
-    void Scene::GenerateDepthMaps(int numLights, int width_resolution, int height_resolution)
-    {
-        // printf("[GenerateDepthMaps] Creating %d depth maps (%dx%d)\n", numLights, width_resolution, height_resolution);
-        
-        // Clean up old maps if they exist
-        if (!m_depthMapFBOs.empty()) {
-            // printf("[GenerateDepthMaps] Cleaning up old depth maps\n");
-            glDeleteFramebuffers(m_depthMapFBOs.size(), m_depthMapFBOs.data());
-            glDeleteTextures(m_depthMaps.size(), m_depthMaps.data());
-            m_depthMapFBOs.clear();
-            m_depthMaps.clear();
-        }
-
-        // Resize vectors to hold the number of lights
-        m_depthMapFBOs.resize(numLights);
-        m_depthMaps.resize(numLights);
-        m_lightSpaceMatrices.resize(numLights);
-
-        // Generate framebuffers and textures
-        glGenFramebuffers(numLights, m_depthMapFBOs.data());
-        glGenTextures(numLights, m_depthMaps.data());
-
-        for (int i = 0; i < numLights; ++i)
-        {
-            // printf("[GenerateDepthMaps] Setting up depth map %d: FBO=%d, Texture=%d\n", 
-            //        i, m_depthMapFBOs[i], m_depthMaps[i]);
-            
-            // Configure depth texture
-            glBindTexture(GL_TEXTURE_2D, m_depthMaps[i]);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
-                width_resolution, height_resolution, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-            float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-            glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-
-            // Attach depth texture to framebuffer
-            glBindFramebuffer(GL_FRAMEBUFFER, m_depthMapFBOs[i]);
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthMaps[i], 0);
-            glDrawBuffer(GL_NONE);
-            glReadBuffer(GL_NONE);
-
-            // Check framebuffer completeness
-            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-            if (status != GL_FRAMEBUFFER_COMPLETE)
-            {
-                printf("[ERROR] Framebuffer %d not complete! Status: 0x%x\n", i, status);
-            }
-            // else
-            // {
-            //     printf("[GenerateDepthMaps] Framebuffer %d complete\n", i);
-            // }
-        }
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        // printf("[GenerateDepthMaps] Depth maps created successfully\n");
-    }
 }
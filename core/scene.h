@@ -1,10 +1,19 @@
 #pragma once
 #include <glad/glad.h>
+#include <cstdint>
+#include <functional>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_int4.hpp>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
+#include "Rendering/bounds.h"
+#include "Rendering/cubeShadowArray.h"
 #include "Rendering/shader.h"
+#include "Rendering/shadowAtlas.h"
+#include "ObjectSystems/componentStorage.h"
+#include "ObjectSystems/Components/Light.h"
 
 namespace core // Forward declaration
 {
@@ -12,6 +21,7 @@ namespace core // Forward declaration
     class GameObject;
     class Renderer;
     class Light;
+    class ClusteredLighting;
 }
 
 namespace core
@@ -22,14 +32,19 @@ namespace core
     /// <remarks>
     /// Must keep:
     /// - Scene holds strong refs to root GameObjects so they stay alive.
+    /// - Building a scene makes no GL calls, its GPU resources are created by the first Render().
+    ///   That lets a scene be built on a loading thread while another one renders.
+    /// - The render passes walk the ComponentStorage, which holds every Renderer of the scene's GameObjects.
+    ///   The registered renderer and light lists stay the source of GetRenderers() and the light indices.
     /// </remarks>
-    class Scene
+    class Scene : public std::enable_shared_from_this<Scene>
     {
     public:
         /// <summary>
         /// Construct a scene. Name optional.
         /// </summary>
         explicit Scene(std::string name = { });
+        ~Scene();
 
         /// <summary>
         /// Set the scene name
@@ -55,7 +70,8 @@ namespace core
         void RemoveRootGameObject(const std::shared_ptr<GameObject>& go);
 
         /// <summary>
-        /// Create a new GameObject and set it's parent. If parent is nullptr, it's a root.
+        /// Create a new GameObject owned by this scene and set it's parent. If parent is nullptr, it's a root.
+        /// The scene must be held by a shared_ptr.
         /// </summary>
         /// <param name="name">The name of the Object to create</param>
         /// <param name="parent">The parent GameObject</param>
@@ -68,11 +84,47 @@ namespace core
         /// <param name="projection">The projection matrix to pass to the TheRenderGameObject method</param>
         void Render(const glm::mat4& view, const glm::mat4& projection);
 
+        /// <summary>
+        /// Callback run once per frame by Update(), with the frame delta time in seconds.
+        /// </summary>
+        using UpdateCallback = std::function<void(float)>;
+
+        /// <summary>
+        /// Registers a callback that Update() runs every frame, for scene scripted behaviour.
+        /// </summary>
+        void AddUpdateCallback(UpdateCallback callback) { m_updateCallbacks.push_back(std::move(callback)); }
+
+        /// <summary>
+        /// Advances the scene by one frame, call before Render().
+        /// </summary>
+        /// <param name="deltaTime">Time since the last frame in seconds.</param>
+        void Update(float deltaTime);
+
         /// <summary>
         /// Return all root GameObjects.
         /// </summary>
         const std::vector<std::shared_ptr<GameObject>>& Roots() const;
 
+        /// <summary>
+        /// Calculate the world matrix for a GameObject by walking up its parents.
+        /// </summary>
+        /// <param name="go">The GameObject, nullptr gives the identity.</param>
+        static glm::mat4 CalculateWorldMatrix(const std::shared_ptr<GameObject>& go);
+        static glm::mat4 CalculateWorldMatrix(const GameObject& go);
+
+        /// <summary>
+        /// Gets the archetype storage of the components of the GameObjects created in this scene.
+        /// </summary>
+        const std::shared_ptr<ComponentStorage>& GetComponentStorage() const { return m_componentStorage; }
+
+        /// <summary>
+        /// Calls func(GameObject&amp;, Ts&amp;...) for every GameObject of this scene that has all
+        /// component types Ts, e.g. <c>scene->Query&lt;Transform, Renderer&gt;(...)</c>.
+        /// Disabled objects and components are included.
+        /// </summary>
+        template<typename... Ts, typename Func>
+        void Query(Func&& func) const { m_componentStorage->Query<Ts...>(std::forward<Func>(func)); }
+
         // Convenience methods for specific component types
         void RegisterRenderer(const std::shared_ptr<Renderer>& renderer) { RegisterComponent(renderer, m_renderers); }
         void UnregisterRenderer(const std::shared_ptr<Renderer>& renderer) { UnregisterComponent(renderer, m_renderers); }
@@ -83,17 +135,60 @@ namespace core
         void SetLightUBO(GLuint ubo) { m_uboLights = ubo; }
 
         /// <summary>
-        /// Sets the bloom threshold value for all lit materials in the scene.
-        /// This controls which pixels contribute to the bloom effect in the MRT output.
+        /// Makes the next Render() upload the light data even if it did not change.
+        /// The light UBO is shared by all loaded scenes, call this when the scene becomes current.
+        /// </summary>
+        void InvalidateLightUpload() { m_lightDataUploaded = false; }
+
+        /// <summary>
+        /// Sets the view distance up to which directional lights cast shadows.
+        /// The cascades of every directional light are spread over this distance.
+        /// </summary>
+        void SetShadowDistance(float distance) { m_shadowDistance = distance; }
+        float GetShadowDistance() const { return m_shadowDistance; }
+
+        /// <summary>
+        /// Sets the blend between logarithmic (1) and uniform (0) cascade splits.
         /// </summary>
-        /// <param name="threshold">The brightness threshold (default: 1.0)</param>
-        void SetBloomThreshold(float threshold) { m_bloomThreshold = threshold; }
+        void SetCascadeSplitLambda(float lambda) { m_cascadeSplitLambda = lambda; }
+        float GetCascadeSplitLambda() const { return m_cascadeSplitLambda; }
+
+        /// <summary>
+        /// Switches shadow sampling back to the manual 3x3 PCF with raw depth reads, instead of the
+        /// 4-tap rotated Poisson kernel on hardware comparison samplers. Kept for benchmarking.
+        /// </summary>
+        void SetLegacyShadowFiltering(bool legacy);
+        bool GetLegacyShadowFiltering() const { return m_legacyShadowFiltering; }
+
+        /// <summary>
+        /// Enables a depth-only pass over all renderers (front to back) before the lit pass.
+        /// The lit pass then only shades the visible fragment of every pixel.
+        /// </summary>
+        void SetDepthPrepass(bool enabled) { m_depthPrepass = enabled; }
+        bool GetDepthPrepass() const { return m_depthPrepass; }
 
         // Accessor methods
         const std::vector<std::shared_ptr<Renderer>>& GetRenderers() const { return m_renderers; }
         const std::vector<std::shared_ptr<Light>>& GetLights() const { return m_lights; }
 
+        /// <summary>
+        /// Gets the number of shadow maps that were re-rendered by the last Render() call.
+        /// Shadow maps whose light and casters did not change are reused from the previous frame.
+        /// </summary>
+        int GetShadowMapUpdateCount() const { return m_shadowMapUpdates; }
+
+        /// <summary>
+        /// Gets the number of casters inside the shadow volume of every light during the last Render() call,
+        /// in the order of GetLights(). Casters are counted once per cascade; -1 for lights without a shadow.
+        /// </summary>
+        const std::vector<int>& GetShadowCasterCounts() const { return m_shadowCasterCounts; }
+
     private:
+        /// <summary>
+        /// Compiles the depth shaders and creates the shadow and light buffers, on the first Render().
+        /// </summary>
+        void CreateGpuResources();
+
         /// <summary>
         /// Generic registration for components
         /// </summary>
@@ -102,7 +197,8 @@ namespace core
         {
             if (!component) return;
 
-            if (std::find(container.begin(), container.end(), component) == container.end())
+            // Set lookup instead of searching the container, scenes can hold up to millions of components
+            if (m_registeredComponents.insert(component.get()).second)
                 container.push_back(component);
         }
 
@@ -112,33 +208,119 @@ namespace core
         template<typename T>
         void UnregisterComponent(const std::shared_ptr<T>& component, std::vector<std::shared_ptr<T>>& container)
         {
-            if (!component) return;
+            if (!component || m_registeredComponents.erase(component.get()) == 0) return;
             container.erase(std::remove(container.begin(), container.end(), component), container.end());
         }
 
-        void RenderShadowMap(int lightIndex);
-        void RenderFinalScene(const glm::mat4& view, const glm::mat4& projection);
-        void GenerateDepthMaps(int numLights, int width_resolution, int height_resolution);
+        /// <summary>
+        /// A renderer that can cast shadows this frame, with its world matrix and bounds.
+        /// </summary>
+        struct ShadowCaster
+        {
+            const Renderer* renderer;
+            glm::mat4 worldMatrix;
+            Bounds worldBounds;
+            bool isStatic;
+        };
 
         /// <summary>
-        /// Calculate the world matrix for a GameObject.
+        /// A renderer drawn by the final scene pass.
         /// </summary>
-        /// <param name="go"></param>
-        /// <returns></returns>
-        glm::mat4 CalculateWorldMatrix(const std::shared_ptr<GameObject>& go);
+        struct SceneDraw
+        {
+            const Renderer* renderer;
+            glm::mat4 worldMatrix;
+            float viewDepth;    // Distance of the bounds center along the view direction
+        };
+
+        /// <summary>
+        /// The light (and cascade) a shadow atlas tile belongs to.
+        /// </summary>
+        struct ShadowTileAssignment
+        {
+            int lightIndex;
+            int cascade;        // 0 for spot lights
+            int cascadeCount;   // 1 for spot lights
+        };
+
+        /// <summary>
+        /// Signatures of what was last rendered into a shadow atlas tile or shadow cube.
+        /// </summary>
+        struct ShadowCacheEntry
+        {
+            std::uint64_t lightHash = 0;      // Light-space matrix and atlas tile, or light sphere
+            std::uint64_t staticHash = 0;     // Static casters inside the light volume
+            std::uint64_t dynamicHash = 0;    // Dynamic casters inside the light volume
+            bool valid = false;
+        };
+
+        int CalculateShadowTileSize(const Light& light, const GameObject& lightGO, const glm::mat4& view, const glm::mat4& projection) const;
+        void AssignShadowTiles(const glm::mat4& view, const glm::mat4& projection);
+        void CollectShadowCasters();
+        void UpdateShadowMap(int tileIndex, const glm::mat4& view, const glm::mat4& projection);
+        void DrawShadowCasters(const std::vector<const ShadowCaster*>& casters);
+
+        /// <summary>
+        /// Re-renders the shadow cubes of the point lights whose light or casters changed.
+        /// Every caster is drawn once for all cubes it overlaps, the geometry shader spreads it over the faces.
+        /// </summary>
+        void UpdateCubeShadowMaps();
+        void DrawCubeShadowCasters(bool isStatic, unsigned cubeMask);
+        glm::mat4 CalculateLightSpaceMatrix(const Light& light, const GameObject& lightGO) const;
+        float CalculateCascadeSplit(int cascade, int cascadeCount, float nearPlane, float farPlane) const;
+
+        /// <summary>
+        /// Fits an orthographic light projection to a slice of the camera frustum.
+        /// The slice's bounding sphere is snapped to shadow map texels, and the depth range is
+        /// extended toward the light to include the casters that can shade the slice.
+        /// </summary>
+        glm::mat4 CalculateCascadeMatrix(const glm::vec3& lightDir, float splitNear, float splitFar, int tileSize,
+                                         const glm::mat4& view, const glm::mat4& projection) const;
+        void RenderFinalScene(const glm::mat4& view, const glm::mat4& projection);
+        void RenderDepthPrepass(const glm::mat4& view, const glm::mat4& projection);
 
         std::string m_name;
+        std::shared_ptr<ComponentStorage> m_componentStorage;       // Shared with its GameObjects, which can outlive the scene
         std::vector<std::shared_ptr<GameObject>> m_roots;
+        std::unordered_set<const GameObject*> m_rootSet;            // Membership of m_roots
+        std::unordered_set<const void*> m_registeredComponents;     // Membership of m_renderers and m_lights
+        std::vector<UpdateCallback> m_updateCallbacks;
         std::vector<std::shared_ptr<Light>> m_lights;
         GLuint m_uboLights{ 0 };
         std::vector<std::shared_ptr<Renderer>> m_renderers;
-        std::vector<glm::mat4> m_lightSpaceMatrices;
         core::Shader depthShader;
-        std::vector<unsigned int> m_depthMapFBOs;
-        std::vector<unsigned int> m_depthMaps;
-        const int SHADOW_WIDTH = 1024;
-        const int SHADOW_HEIGHT = 1024;
-        float m_bloomThreshold = 1.0f;  // Default bloom threshold
+        core::Shader cubeDepthShader;
+        core::Shader prepassShader;
+        std::unique_ptr<ShadowAtlas> m_shadowAtlas;
+        std::unique_ptr<CubeShadowArray> m_cubeShadows;
+        std::vector<int> m_shadowCubes;                     // Light index per shadow cube
+        std::vector<ShadowTileAssignment> m_shadowTiles;    // Per atlas tile
+        std::vector<glm::ivec4> m_lightShadows;             // Per light, see ClusteredLighting::GpuLight::shadow
+        std::vector<ShadowAtlas::GpuShadow> m_gpuShadows;
+        std::vector<ShadowAtlas::GpuShadow> m_uploadedShadows;
+        std::vector<ShadowCacheEntry> m_shadowCache;    // Per atlas tile
+        std::vector<ShadowCacheEntry> m_cubeShadowCache;    // Per shadow cube
+        std::vector<ShadowCaster> m_shadowCasters;
+        std::vector<unsigned> m_casterCubeMasks;        // Per shadow caster, bit i set if it overlaps the sphere of cube i
+        std::vector<SceneDraw> m_sceneDraws;            // Scratch list of the final scene pass
+        std::vector<const SceneDraw*> m_prepassOrder;
+        std::vector<const ShadowCaster*> m_staticCasters;  // Scratch lists, reused every light
+        std::vector<const ShadowCaster*> m_dynamicCasters;
+        int m_shadowMapUpdates = 0;
+        std::vector<int> m_shadowCasterCounts;          // Per light, see GetShadowCasterCounts()
+        LightData m_uploadedLightData{};
+        bool m_lightDataUploaded = false;
+        std::unique_ptr<ClusteredLighting> m_clusteredLighting;
+        float m_shadowDistance = 50.0f;
+        float m_cascadeSplitLambda = 0.75f;
+        bool m_legacyShadowFiltering = false;
+        bool m_depthPrepass = true;
+
+        static constexpr size_t MAX_SHADOW_LIGHTS = 16;
+        static constexpr int MIN_SHADOW_CASCADES = 2;
+        static constexpr int MAX_SHADOW_CASCADES = 4;
+        static constexpr float SPOT_LIGHT_CUTOFF = 0.9f;    // Cosine of the spot light half angle
+        static constexpr float POINT_LIGHT_CUTOFF = -2.0f;  // Below any cosine, so the cone test always passes
     };
 
 } // namespace core
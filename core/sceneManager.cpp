@@ -1,27 +1,106 @@
+#include "profiler.h"
 #include "sceneManager.h"
-#include <editor/editor.h>
+#include <chrono>
+#include <cstdio>
 
 namespace core
 {
+    std::shared_ptr<Scene> SceneManager::BuildScene(const std::string& sceneName, const SceneFactory& factory, GLuint uboLights)
+    {
+        FINALENGINE_PROFILE_ZONE("SceneManager::BuildScene");
+        auto scene = std::make_shared<core::Scene>(sceneName);
+        scene->SetLightUBO(uboLights);
+
+        // Population of the scene after bare scene creation.
+        factory(scene);
+        return scene;
+    }
+
     bool SceneManager::LoadScene(const std::string& sceneName, GLuint uboLights)
     {
+        FINALENGINE_PROFILE_ZONE("SceneManager::LoadScene");
         if (sceneName.empty()) return false;
 
         auto it = m_sceneFactories.find(sceneName);
         if (it == m_sceneFactories.end())
             return false;
         
-        m_currentScene = std::make_shared<core::Scene>(sceneName);
-        editor::Editor::editorCtx.currentScene = m_currentScene;
-        editor::Editor::editorCtx.currentSelectedGameObject = nullptr;
-        
         if(m_internalUbo != uboLights)
             m_internalUbo = uboLights;
 
-        m_currentScene->SetLightUBO(uboLights);
+        m_currentScene = BuildScene(sceneName, it->second, uboLights);
+        m_loadedScenes[sceneName] = m_currentScene;
+        return true;
+    }
 
-        // Population of the scene after bare scene creation.
-        it->second(m_currentScene);
+    bool SceneManager::LoadSceneAsync(const std::string& sceneName, GLuint uboLights)
+    {
+        if (sceneName.empty() || IsLoading()) return false;
+
+        auto it = m_sceneFactories.find(sceneName);
+        if (it == m_sceneFactories.end())
+            return false;
+
+        if(m_internalUbo != uboLights)
+            m_internalUbo = uboLights;
+
+        printf("[SCENEMANAGER] Loading %s in the background\n", sceneName.c_str());
+        m_pendingSceneName = sceneName;
+        m_pendingLoad = std::async(std::launch::async, [sceneName, factory = it->second, uboLights]()
+        {
+            FINALENGINE_PROFILE_THREAD("Scene Loader");
+            return BuildScene(sceneName, factory, uboLights);
+        });
+        return true;
+    }
+
+    bool SceneManager::Update()
+    {
+        if (!IsLoading() || m_pendingLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+
+        m_currentScene = m_pendingLoad.get();
+        m_currentScene->InvalidateLightUpload();
+        m_loadedScenes[m_pendingSceneName] = m_currentScene;
+        printf("[SCENEMANAGER] Loaded %s\n", m_pendingSceneName.c_str());
+        return true;
+    }
+
+    bool SceneManager::SetCurrentScene(const std::string& sceneName)
+    {
+        auto it = m_loadedScenes.find(sceneName);
+        if (it == m_loadedScenes.end())
+            return false;
+
+        // Another scene may have written the shared light UBO since this one last rendered
+        m_currentScene = it->second;
+        m_currentScene->InvalidateLightUpload();
+        return true;
+    }
+
+    std::shared_ptr<Scene> SceneManager::GetLoadedScene(const std::string& sceneName) const
+    {
+        auto it = m_loadedScenes.find(sceneName);
+        return it != m_loadedScenes.end() ? it->second : nullptr;
+    }
+
+    std::vector<std::string> SceneManager::GetLoadedSceneNames() const
+    {
+        std::vector<std::string> sceneNames;
+        sceneNames.reserve(m_loadedScenes.size());
+        for (auto& kvp : m_loadedScenes)
+            sceneNames.push_back(kvp.first);
+
+        return sceneNames;
+    }
+
+    bool SceneManager::UnloadScene(const std::string& sceneName)
+    {
+        auto it = m_loadedScenes.find(sceneName);
+        if (it == m_loadedScenes.end() || it->second == m_currentScene)
+            return false;
+
+        m_loadedScenes.erase(it);
         return true;
     }
 
@@ -2,17 +2,25 @@
 
 #include "scene.h"
 #include <functional>
+#include <future>
+#include <unordered_map>
 
 namespace core
 {
     /// <summary>
     /// Manages scene registration and lifecycle.
+    /// <para>
+    /// Loaded scenes stay alive until unloaded, so switching back to one does not rebuild it.
+    /// A scene can be built on a loading thread (LoadSceneAsync) while the current one keeps rendering.
+    /// </para>
     /// </summary>
     class SceneManager
     {
     public:
         /// <summary>
-        /// Factory function that creates a scene instance.
+        /// Factory function that populates a new scene instance.
+        /// May run on a loading thread: it must not make GL calls itself. Meshes, textures and the scene
+        /// create their GPU resources on first use, shaders are created up front when registering.
         /// </summary>
         using SceneFactory = std::function<void(std::shared_ptr<Scene>)>;
 
@@ -23,11 +31,12 @@ namespace core
 
         /// <summary>
         /// Destroys the scene manager and cleans up resources.
+        /// Waits for a running background load to finish.
         /// </summary>
         ~SceneManager() = default;
 
         /// <summary>
-        /// Loads the scene with the specified name.
+        /// Builds the scene with the specified name and makes it current, replacing a loaded one of the same name.
         /// </summary>
         /// <param name="sceneName">Name of the scene to load.</param>
         /// <param name="uboLights">OpenGL uniform buffer object for lights.</param>
@@ -44,6 +53,49 @@ namespace core
             return LoadScene(sceneName, m_internalUbo);
         }
 
+        /// <summary>
+        /// Starts building the scene on a loading thread. The current scene stays current,
+        /// Update() makes the new one current once it is built.
+        /// </summary>
+        /// <param name="sceneName">Name of the scene to load.</param>
+        /// <param name="uboLights">OpenGL uniform buffer object for lights.</param>
+        /// <returns>False if the scene is unknown or another load is still running.</returns>
+        bool LoadSceneAsync(const std::string& sceneName, GLuint uboLights);
+
+        /// <summary>
+        /// Makes a finished background load the current scene. Call once per frame on the render thread.
+        /// </summary>
+        /// <returns>True if the current scene changed.</returns>
+        bool Update();
+
+        /// <summary>
+        /// Whether a background load is running.
+        /// </summary>
+        bool IsLoading() const { return m_pendingLoad.valid(); }
+
+        /// <summary>
+        /// Makes an already loaded scene current without rebuilding it.
+        /// </summary>
+        /// <returns>False if no scene of that name is loaded.</returns>
+        bool SetCurrentScene(const std::string& sceneName);
+
+        /// <summary>
+        /// Gets a loaded scene by name.
+        /// </summary>
+        /// <returns>The scene, or nullptr if it is not loaded.</returns>
+        std::shared_ptr<Scene> GetLoadedScene(const std::string& sceneName) const;
+
+        /// <summary>
+        /// Gets the names of all loaded scenes.
+        /// </summary>
+        std::vector<std::string> GetLoadedSceneNames() const;
+
+        /// <summary>
+        /// Releases a loaded scene. The current scene cannot be unloaded.
+        /// </summary>
+        /// <returns>True if the scene was unloaded.</returns>
+        bool UnloadScene(const std::string& sceneName);
+
         /// <summary>
         /// Registers a scene factory with the given name.
         /// </summary>
@@ -64,6 +116,11 @@ namespace core
         std::vector<std::string> GetSceneNames() const;
 
     private:
+        /// <summary>
+        /// Creates a scene and runs its factory, on the calling thread.
+        /// </summary>
+        static std::shared_ptr<Scene> BuildScene(const std::string& sceneName, const SceneFactory& factory, GLuint uboLights);
+
         /// <summary>
         /// The currently active scene.
         /// </summary>
@@ -71,6 +128,14 @@ namespace core
 
         GLuint m_internalUbo = 0;
 
+        /// <summary>
+        /// Loaded scenes by name, the current one included.
+        /// </summary>
+        std::unordered_map<std::string, std::shared_ptr<Scene>> m_loadedScenes;
+
+        std::future<std::shared_ptr<Scene>> m_pendingLoad;
+        std::string m_pendingSceneName;
+
         /// <summary>
         /// Map of scene names to their factory functions.
         /// </summary>
@@ -0,0 +1,225 @@
+#include "material.h"
+#include "objectSystems/components/Light.h"
+#include "objectSystems/components/Renderer.h"
+#include "objectSystems/GameObject.h"
+#include "profiler.h"
+#include "rendering/mesh.h"
+#include "rendering/shaderVariants.h"
+#include "rendering/texture.h"
+#include "stressSceneGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace core
+{
+    namespace
+    {
+        /// <summary>
+        /// Uniform float in [min, max). std::mt19937 is specified exactly but the standard distributions
+        /// are not, mapping the raw output here keeps a seed producing the same scene on every compiler.
+        /// </summary>
+        float Random(std::mt19937& rng, float min, float max)
+        {
+            return min + (max - min) * static_cast<float>(rng() >> 8) / 16777216.0f;
+        }
+
+        /// <summary>
+        /// Uniform point in the box [min, max). The components are drawn in order, x first, which a
+        /// glm::vec3(Random(), Random(), Random()) would not guarantee.
+        /// </summary>
+        glm::vec3 Random(std::mt19937& rng, const glm::vec3& min, const glm::vec3& max)
+        {
+            float x = Random(rng, min.x, max.x);
+            float y = Random(rng, min.y, max.y);
+            float z = Random(rng, min.z, max.z);
+            return glm::vec3(x, y, z);
+        }
+
+        int PoolSize(float diversity, int objectCount)
+        {
+            int size = static_cast<int>(std::lround(diversity * objectCount));
+            return std::clamp(size, 1, std::min(objectCount, StressSceneGenerator::MAX_POOL_SIZE));
+        }
+
+        struct MovingObject
+        {
+            std::shared_ptr<Transform> transform;
+            glm::vec3 basePosition;
+            float phase;
+        };
+
+        struct Node
+        {
+            std::shared_ptr<GameObject> object;
+            glm::vec3 worldPosition;
+            bool moving;    // The object or one of its ancestors moves
+        };
+    } // namespace
+
+    SceneManager::SceneFactory StressSceneGenerator::CreateFactory(const Settings& settings)
+    {
+        auto litSurfaceShader = std::make_shared<ShaderVariants>("assets/shaders/vertex.vert", "assets/shaders/litFragment.frag");
+
+        return [settings, litSurfaceShader](std::shared_ptr<Scene> scene)
+        {
+            FINALENGINE_PROFILE_ZONE("StressSceneGenerator::Build");
+            const int objectCount = std::max(1, settings.objectCount);
+            const int depth = std::max(1, settings.hierarchyDepth);
+            const int fanOut = std::max(1, settings.fanOut);
+            std::mt19937 rng(settings.seed);
+
+            // Boxes of different proportions, each one uploaded as its own vertex array
+            std::vector<Mesh> meshes;
+            const int meshCount = PoolSize(settings.meshDiversity, objectCount);
+            meshes.reserve(meshCount);
+            meshes.push_back(Mesh::GenerateCube(glm::vec3(0.5f)));
+            for (int i = 1; i < meshCount; ++i)
+                meshes.push_back(Mesh::GenerateCube(Random(rng, glm::vec3(0.2f), glm::vec3(0.6f))));
+
+            std::vector<std::shared_ptr<Texture>> albedoTextures = { std::make_shared<Texture>("assets/textures/rockTexture.jpeg"),
+                                                                     std::make_shared<Texture>("assets/textures/CMGaTo_crop.png") };
+            auto aoTexture = std::make_shared<Texture>("assets/textures/rockAO.jpeg");
+
+            std::vector<std::shared_ptr<Material>> materials;
+            const int materialCount = PoolSize(settings.materialDiversity, objectCount);
+            materials.reserve(materialCount);
+            for (int i = 0; i < materialCount; ++i)
+            {
+                auto material = std::make_shared<Material>(litSurfaceShader);
+                material->SetTexture("albedoMap", albedoTextures[i % albedoTextures.size()], 0);
+                material->SetTexture("aoMap", aoTexture, 1);
+                material->SetVec3("albedoTint", i == 0 ? glm::vec3(1.0f) : Random(rng, glm::vec3(0.3f), glm::vec3(1.0f)));
+                material->EnableKeyword(ShaderKeyword::ShadowReceive);
+                materials.push_back(material);
+            }
+
+            // Scatter covers the same footprint as the grid, so both layouts have the same density
+            const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(objectCount))));
+            const float halfExtent = side * settings.spacing * 0.5f;
+            std::vector<MovingObject> movingObjects;
+            int created = 0;
+            int rootCount = 0;
+
+            auto createNode = [&](const Node* parent)
+            {
+                const int index = created++;
+                glm::vec3 worldPosition = settings.layout == Layout::Grid
+                    ? glm::vec3((index % side + 0.5f) * settings.spacing - halfExtent, 0.5f, (index / side + 0.5f) * settings.spacing - halfExtent)
+                    : Random(rng, glm::vec3(-halfExtent, 0.5f, -halfExtent), glm::vec3(halfExtent, settings.spacing, halfExtent));
+                const bool moving = Random(rng, 0.0f, 1.0f) < settings.movingFraction;
+
+                // Parents are never rotated or scaled, the local position is the offset from the parent
+                auto object = scene->CreateObject("Stress " + std::to_string(index), parent ? parent->object : nullptr);
+                object->transform->position = parent ? worldPosition - parent->worldPosition : worldPosition;
+
+                Node node{ object, worldPosition, moving || (parent && parent->moving) };
+                auto renderer = object->AddComponent<Renderer>();
+                renderer->SetMesh(meshes[index % meshCount]);
+                renderer->SetMaterial(materials[index % materialCount]);
+                renderer->isStatic = !node.moving;
+
+                if (moving)
+                    movingObjects.push_back({ object->transform, object->transform->position, Random(rng, 0.0f, 6.2831853f) });
+                return node;
+            };
+
+            // One tree at a time, breadth first, until the object budget is spent
+            while (created < objectCount)
+            {
+                std::vector<Node> level = { createNode(nullptr) };
+                rootCount++;
+                for (int d = 1; d < depth && created < objectCount; ++d)
+                {
+                    std::vector<Node> nextLevel;
+                    for (const Node& parent : level)
+                    {
+                        for (int child = 0; child < fanOut && created < objectCount; ++child)
+                            nextLevel.push_back(createNode(&parent));
+                    }
+                    level = std::move(nextLevel);
+                }
+            }
+
+            for (int i = 0; i < settings.directionalLights; ++i)
+            {
+                auto lightGO = scene->CreateObject("Stress Directional Light " + std::to_string(i));
+                lightGO->transform->rotation = Random(rng, glm::vec3(-80.0f, 0.0f, 0.0f), glm::vec3(-40.0f, 360.0f, 0.0f));
+                auto light = lightGO->AddComponent<Light>();
+                light->lightType = LightType::Directional;
+                light->color = glm::vec4(1.0f, 0.95f, 0.85f, 1.0f);
+                light->intensity = 0.5f;
+            }
+
+            for (int i = 0; i < settings.pointLights; ++i)
+            {
+                auto lightGO = scene->CreateObject("Stress Point Light " + std::to_string(i));
+                lightGO->transform->position = Random(rng, glm::vec3(-halfExtent, 1.0f, -halfExtent), glm::vec3(halfExtent, 3.0f, halfExtent));
+                auto light = lightGO->AddComponent<Light>();
+                light->color = glm::vec4(Random(rng, glm::vec3(0.2f), glm::vec3(1.0f)), 1.0f);
+                light->intensity = 2.0f;
+                light->range = settings.spacing * 3.0f;
+            }
+
+            for (int i = 0; i < settings.spotLights; ++i)
+            {
+                auto lightGO = scene->CreateObject("Stress Spot Light " + std::to_string(i));
+                lightGO->transform->position = Random(rng, glm::vec3(-halfExtent, settings.spacing * 3.0f, -halfExtent), glm::vec3(halfExtent, settings.spacing * 3.0f, halfExtent));
+                lightGO->transform->rotation = glm::vec3(-90.0f, 0.0f, 0.0f);  // Pointing down
+                auto light = lightGO->AddComponent<Light>();
+                light->lightType = LightType::Spot;
+                light->color = glm::vec4(Random(rng, glm::vec3(0.2f), glm::vec3(1.0f)), 1.0f);
+                light->intensity = 4.0f;
+                light->range = settings.spacing * 6.0f;
+            }
+
+            printf("[SCENES] Generated %d objects in %d trees, %d meshes, %d materials, %d lights, %zu moving\n",
+                   created, rootCount, meshCount, materialCount,
+                   settings.directionalLights + settings.pointLights + settings.spotLights, movingObjects.size());
+
+            if (!movingObjects.empty())
+            {
+                scene->AddUpdateCallback([movingObjects = std::move(movingObjects), time = 0.0f](float deltaTime) mutable
+                {
+                    time += deltaTime;
+                    for (MovingObject& moving : movingObjects)
+                        moving.transform->position.y = moving.basePosition.y + std::sin(time * 2.0f + moving.phase) * 0.5f;
+                });
+            }
+        };
+    }
+
+    void StressSceneGenerator::RegisterPresets(SceneManager& sceneManager)
+    {
+        Settings grid1k;
+        sceneManager.RegisterScene("Stress Grid 1k", CreateFactory(grid1k));
+
+        Settings diverse10k;
+        diverse10k.objectCount = 10000;
+        diverse10k.meshDiversity = 0.1f;
+        diverse10k.materialDiversity = 0.1f;
+        diverse10k.pointLights = 64;
+        diverse10k.spotLights = 8;
+        diverse10k.movingFraction = 0.1f;
+        sceneManager.RegisterScene("Stress Grid 10k (Diverse)", CreateFactory(diverse10k));
+
+        Settings hierarchy100k;
+        hierarchy100k.objectCount = 100000;
+        hierarchy100k.layout = Layout::Scatter;
+        hierarchy100k.hierarchyDepth = 4;
+        hierarchy100k.fanOut = 4;
+        hierarchy100k.pointLights = 256;
+        hierarchy100k.movingFraction = 0.05f;
+        sceneManager.RegisterScene("Stress Scatter 100k (Hierarchy)", CreateFactory(hierarchy100k));
+
+        Settings grid1m;
+        grid1m.objectCount = 1000000;
+        grid1m.spacing = 1.5f;
+        grid1m.pointLights = 1024;
+        grid1m.movingFraction = 0.01f;
+        sceneManager.RegisterScene("Stress Grid 1M", CreateFactory(grid1m));
+    }
+} // namespace core
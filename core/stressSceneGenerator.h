@@ -0,0 +1,60 @@
+#pragma once
+
+#include "sceneManager.h"
+#include <cstdint>
+#include <string>
+
+namespace core
+{
+    /// <summary>
+    /// Builds parameterized stress scenes for scaling tests, from a thousand up to millions of GameObjects.
+    /// <para>
+    /// Objects are laid out on a grid or scattered over the same footprint and grouped into trees of
+    /// the configured depth and fan-out. Meshes and materials come from pools whose size is a ratio of
+    /// the object count, so the same scene can share one mesh and material or give every object its own.
+    /// Everything random is drawn from one generator seeded with Settings::seed, the same settings always
+    /// produce the same scene.
+    /// </para>
+    /// </summary>
+    class StressSceneGenerator
+    {
+    public:
+        static constexpr int MAX_POOL_SIZE = 16384;  // Bounds the unique meshes and materials on the GPU
+
+        enum class Layout
+        {
+            Grid,       // Regular grid, one cell per object
+            Scatter     // Uniformly random over the footprint of the grid
+        };
+
+        struct Settings
+        {
+            int objectCount = 1000;
+            Layout layout = Layout::Grid;
+            float spacing = 2.0f;               // Grid cell size in world units
+
+            int hierarchyDepth = 1;             // Levels per tree, 1 makes every object a root
+            int fanOut = 4;                     // Children per parent below the roots
+
+            float meshDiversity = 0.0f;         // Unique meshes as a fraction of the objects, 0 shares one mesh
+            float materialDiversity = 0.0f;     // Unique materials as a fraction of the objects, 0 shares one
+
+            int pointLights = 16;
+            int spotLights = 0;
+            int directionalLights = 1;
+
+            float movingFraction = 0.0f;        // Objects bobbing every frame, the rest are marked static
+            std::uint32_t seed = 1337;
+        };
+
+        /// <summary>
+        /// Creates a scene factory building a stress scene with the given settings.
+        /// </summary>
+        static SceneManager::SceneFactory CreateFactory(const Settings& settings);
+
+        /// <summary>
+        /// Registers the preset stress scenes, from 1k to 1M objects.
+        /// </summary>
+        static void RegisterPresets(SceneManager& sceneManager);
+    };
+} // namespace core
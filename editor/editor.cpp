@@ -1,10 +1,5 @@
-#include "core/assimpLoader.h"
-#include "core/material.h"
-#include "core/model.h"
+#include "core/defaultScenes.h"
 #include "core/objectSystems/components/Light.h"
-#include "core/objectSystems/components/Renderer.h"
-#include "core/rendering/mesh.h"
-#include "core/rendering/texture.h"
 #include "core/sceneManager.h"
 #include "Editor.h"
 #include "inputManager.h"
@@ -12,9 +7,16 @@
 #include "panels/hierarchyPanel.h"
 #include "panels/inspectorPanel.h"
 #include "panels/postProcessingPanel.h"
+#include "panels/profilerPanel.h"
 #include "panels/ViewportPanel.h"
 #include <core/camera.h>
+#include <core/profiler.h>
 #include <core/rendering/frameBuffer.h>
+#include <core/rendering/gpuProfiler.h>
+#include <core/rendering/renderStats.h>
+#include <core/rendering/shaderCache.h>
+#include <core/rendering/shaderHotReloader.h>
+#include <chrono>
 #include <cstdio>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -24,6 +26,7 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <iostream>
+#include <string>
 
 namespace editor
 {
@@ -91,6 +94,8 @@ namespace editor
 
     bool Editor::init(const char* glsl_version)
     {
+        auto startupBegin = std::chrono::steady_clock::now();
+
         // Initialize GLFW
         if (!glfwInit())
         {
@@ -145,11 +150,14 @@ namespace editor
         m_postProcessingManager = std::make_shared<core::postProcessing::PostProcessingManager>();
         m_postProcessingManager->Initialize();
 
+        m_dynamicResolution = std::make_unique<core::DynamicResolution>();
+
         // Initialize panels
         addPanel<ViewportPanel>(*this);
         addPanel<HierarchyPanel>();
         addPanel<InspectorPanel>();
         addPanel<PostProcessingPanel>(m_postProcessingManager.get());
+        addPanel<ProfilerPanel>();
 
         // Initialize ImGui
         IMGUI_CHECKVERSION();
@@ -181,8 +189,7 @@ namespace editor
             "SceneFBO", 
             core::FrameBufferSpecifications{
                 800, 600,
-                core::AttachmentType::COLOR_DEPTH,
-                2
+                core::AttachmentType::COLOR_DEPTH
             }
         );
 
@@ -205,7 +212,24 @@ namespace editor
             loadDefaultScene();
         }
 
+        // Watch the shader sources so edits are picked up without restarting the editor.
+        // The shaders are loaded from the copy next to the executable, edits happen in the source tree.
+#ifdef FINALENGINE_SHADER_SOURCE_DIR
+        core::ShaderHotReloader::Start("assets/shaders", FINALENGINE_SHADER_SOURCE_DIR);
+#else
+        core::ShaderHotReloader::Start("assets/shaders");
+#endif
+
         m_initialized = true;
+
+        // Report startup cost so cold (empty shader cache) and warm runs can be compared
+        std::chrono::duration<double, std::milli> startupTime = std::chrono::steady_clock::now() - startupBegin;
+        const auto& cacheStats = core::ShaderCache::GetStats();
+        printf("[EDITOR] Startup took %.1f ms (%s shader cache: %d hits / %d misses, %.1f ms loading binaries, %.1f ms compiling)\n",
+               startupTime.count(),
+               cacheStats.misses == 0 && cacheStats.hits > 0 ? "warm" : "cold",
+               cacheStats.hits, cacheStats.misses, cacheStats.loadMs, cacheStats.compileMs);
+
         printf("[EDITOR] Successfully initialized\n");
         return true;
     }
@@ -214,6 +238,12 @@ namespace editor
     {
         if (!m_initialized) return;
 
+        core::ShaderHotReloader::Stop();
+
+        // Timer queries belong to the context, release them while it exists
+        m_dynamicResolution.reset();
+        core::GpuProfiler::Shutdown();
+
         // Cleanup UBO
         if (m_uboLights != 0)
         {
@@ -254,16 +284,32 @@ namespace editor
         // Main editor loop
         while (m_isRunning && !glfwWindowShouldClose(m_window))
         {
+            // Frame boundary of the CPU profiler, before the zone of this frame opens
+            core::Profiler::EndFrame();
+            FINALENGINE_PROFILE_ZONE("Frame");
+
             glfwPollEvents();
 
+            // Swap in any shader programs rebuilt since the last frame
+            core::ShaderHotReloader::Update();
+
+            // Switch to a scene finished loading in the background, the selection belonged to the previous one
+            if (editorCtx.sceneManager && editorCtx.sceneManager->Update())
+                editorCtx.currentSelectedGameObject = nullptr;
+
             beginFrame();
+            if (ImGui::IsKeyPressed(ImGuiKey_F9, false))
+                core::Profiler::CaptureFrames(m_captureFrameCount);
             draw();
 
             // Render the 3D scene
             renderScene(deltaTime);
 
             endFrame();
-            glfwSwapBuffers(m_window);
+            {
+                FINALENGINE_PROFILE_ZONE("SwapBuffers");
+                glfwSwapBuffers(m_window);
+            }
 
             // Calculate delta time
             double finishFrameTime = glfwGetTime();
@@ -276,50 +322,86 @@ namespace editor
 
     void Editor::renderScene(float deltaTime)
     {
+        FINALENGINE_PROFILE_FUNCTION();
         auto currentScene = editorCtx.sceneManager ? editorCtx.sceneManager->GetCurrentScene() : nullptr;
 
         int vw = getViewportWidth();
         int vh = getViewportHeight();
 
-        if (!m_sceneRenderBuffer)
+        if (!m_sceneRenderBuffer || !m_dynamicResolution)
             return;
 
-        m_sceneRenderBuffer->Resize(vw, vh);
+        // The scene and post-processing run at the dynamic resolution, upscaled into the viewport at the end
+        int rw = m_dynamicResolution->GetScaledSize(vw);
+        int rh = m_dynamicResolution->GetScaledSize(vh);
+        m_sceneRenderBuffer->Resize(rw, rh);
 
         core::FrameBuffer* viewportFrameBuffer = GetFrameBuffer();
 
         if (vw > 0 && vh > 0)
         {
-            m_sceneRenderBuffer->BindAndClear(vw, vh);
-
             // Process input if viewport is focused
             if (viewportFocused() && m_inputManager && m_editorCamera)
                 m_inputManager->ProcessInput(m_window, m_editorCamera.get(), deltaTime);
 
-            // Render 3D scene
-            if (currentScene && m_editorCamera)
-            {
-                glm::mat4 view = m_editorCamera->GetViewMatrix();
-                glm::mat4 projection = m_editorCamera->GetProjectionMatrix(vw, vh);
-                currentScene->Render(view, projection);
-            }
+            m_dynamicResolution->BeginFrame();
+            core::GpuProfiler::BeginFrame();
+            core::RenderStats::Reset();
+
+            if (currentScene)
+                currentScene->Update(deltaTime);
+
+            m_frameGraph.Reset();
+            core::FrameGraph::Handle sceneTarget = m_frameGraph.Import("SceneColor", *m_sceneRenderBuffer);
+
+            // Render 3D scene, the shadow and depth prepasses run inside Scene::Render
+            m_frameGraph.AddPass("Scene",
+                [sceneTarget](core::FrameGraph::Builder& builder)
+                {
+                    builder.Write(sceneTarget);
+                },
+                [this, currentScene, sceneTarget, vw, vh, rw, rh](const core::FrameGraph::Resources& resources)
+                {
+                    resources.Get(sceneTarget).BindAndClear(rw, rh);
+
+                    if (currentScene && m_editorCamera)
+                    {
+                        glm::mat4 view = m_editorCamera->GetViewMatrix();
+                        glm::mat4 projection = m_editorCamera->GetProjectionMatrix(vw, vh);
+                        currentScene->SetDepthPrepass(m_depthPrepass);
+                        currentScene->Render(view, projection);
+                    }
+                });
 
             // Apply post-processing if effects are registered
             if (m_postProcessingManager && viewportFrameBuffer)
             {
-                m_postProcessingManager->ProcessStack(
-                    *m_sceneRenderBuffer, 
-                    *viewportFrameBuffer,
-                    vw, vh
-                );
+                core::FrameGraph::Handle viewportTarget = m_frameGraph.Import("Viewport", *viewportFrameBuffer);
+                if (rw == vw && rh == vh)
+                {
+                    m_postProcessingManager->AddPasses(m_frameGraph, sceneTarget, viewportTarget, vw, vh);
+                }
+                else
+                {
+                    core::FrameGraph::Handle scaledTarget = m_frameGraph.CreateTarget("ScaledOutput",
+                        core::FrameBufferSpecifications{ static_cast<unsigned>(rw), static_cast<unsigned>(rh), core::AttachmentType::COLOR_ONLY });
+                    m_postProcessingManager->AddPasses(m_frameGraph, sceneTarget, scaledTarget, rw, rh);
+                    m_dynamicResolution->AddUpscalePass(m_frameGraph, scaledTarget, viewportTarget, vw, vh);
+                }
             }
 
+            m_frameGraph.Compile();
+            m_frameGraph.Execute();
+
             m_sceneRenderBuffer->Unbind();
+            core::GpuProfiler::EndFrame();
+            m_dynamicResolution->EndFrame();
         }
     }
 
     void Editor::beginFrame()
     {
+        FINALENGINE_PROFILE_FUNCTION();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -367,17 +449,93 @@ namespace editor
             {
                 if (editorCtx.sceneManager)
                 {
-                    auto sceneNames = editorCtx.sceneManager->GetSceneNames();
+                    // Loaded scenes switch at once, others are built in the background while this one renders
+                    auto& sceneManager = *editorCtx.sceneManager;
+                    auto currentScene = sceneManager.GetCurrentScene();
+                    auto sceneNames = sceneManager.GetSceneNames();
                     for (const auto& sceneName : sceneNames)
                     {
-                        if (ImGui::MenuItem(sceneName.c_str()))
+                        auto loadedScene = sceneManager.GetLoadedScene(sceneName);
+                        bool isCurrent = loadedScene && loadedScene == currentScene;
+                        if (ImGui::MenuItem(sceneName.c_str(), loadedScene ? "Loaded" : nullptr, isCurrent, !sceneManager.IsLoading()))
                         {
-                            editorCtx.sceneManager->LoadScene(sceneName, m_uboLights);
+                            if (loadedScene)
+                            {
+                                if (!isCurrent && sceneManager.SetCurrentScene(sceneName))
+                                    editorCtx.currentSelectedGameObject = nullptr;
+                            }
+                            else
+                            {
+                                sceneManager.LoadSceneAsync(sceneName, m_uboLights);
+                            }
                         }
                     }
+
+                    ImGui::Separator();
+                    if (sceneManager.IsLoading())
+                        ImGui::TextDisabled("Loading...");
+                    if (ImGui::MenuItem("Reload Current Scene", nullptr, false, currentScene && !sceneManager.IsLoading()))
+                        sceneManager.LoadSceneAsync(currentScene->GetName(), m_uboLights);
+                    if (ImGui::MenuItem("Unload Other Scenes"))
+                    {
+                        for (const auto& sceneName : sceneManager.GetLoadedSceneNames())
+                            sceneManager.UnloadScene(sceneName);
+                    }
                 }
                 ImGui::EndMenu();
             }
+            if (ImGui::BeginMenu("Rendering"))
+            {
+                ImGui::Checkbox("Depth Prepass", &m_depthPrepass);
+                ImGui::Text("Frame time: %.2f ms", 1000.0f / ImGui::GetIO().Framerate);
+                ImGui::Text("Draw calls: %llu, triangles: %llu",
+                            static_cast<unsigned long long>(core::RenderStats::Get().drawCalls),
+                            static_cast<unsigned long long>(core::RenderStats::Get().triangles));
+
+                ImGui::SeparatorText("Frame Graph");
+                bool aliasing = m_frameGraph.GetAliasing();
+                if (ImGui::Checkbox("Alias Transient Targets", &aliasing))
+                    m_frameGraph.SetAliasing(aliasing);
+
+                const auto& graphStats = m_frameGraph.GetStats();
+                ImGui::Text("Passes: %d (%d culled)", graphStats.passCount, graphStats.culledPassCount);
+                ImGui::Text("Transient targets: %d in %d framebuffers", graphStats.transientCount, graphStats.physicalCount);
+                ImGui::Text("Transient memory: %.2f MB aliased, %.2f MB unaliased",
+                            graphStats.aliasedBytes / (1024.0f * 1024.0f), graphStats.unaliasedBytes / (1024.0f * 1024.0f));
+                ImGui::Text("Pooled targets: %zu (%zu allocated so far)",
+                            m_frameGraph.GetPool().GetTargetCount(), m_frameGraph.GetPool().GetAllocationCount());
+
+                ImGui::SeparatorText("Dynamic Resolution");
+                auto& resolution = m_dynamicResolution->GetSettings();
+                ImGui::Checkbox("Enabled", &resolution.enabled);
+                ImGui::SliderFloat("Target GPU Time (ms)", &resolution.targetFrameTimeMs, 2.0f, 50.0f, "%.1f");
+                ImGui::SliderFloat("Min Scale", &resolution.minScale, 0.25f, 1.0f, "%.2f");
+                ImGui::SliderFloat("Max Scale", &resolution.maxScale, 0.25f, 1.0f, "%.2f");
+                ImGui::SliderFloat("Damping", &resolution.damping, 0.01f, 1.0f, "%.2f");
+                if (ImGui::IsItemHovered())
+                    ImGui::SetTooltip("Fraction of the step towards the ideal scale taken per frame");
+                ImGui::SliderFloat("Sharpness", &resolution.sharpness, 0.0f, 2.0f, "%.2f");
+
+                ImGui::Text("Scale: %.2f (%dx%d of %dx%d), GPU: %.2f ms", m_dynamicResolution->GetScale(),
+                            m_dynamicResolution->GetScaledSize(getViewportWidth()), m_dynamicResolution->GetScaledSize(getViewportHeight()),
+                            getViewportWidth(), getViewportHeight(), m_dynamicResolution->GetGpuFrameTime());
+                const auto& scaleHistory = m_dynamicResolution->GetScaleHistory();
+                const auto& frameTimeHistory = m_dynamicResolution->GetFrameTimeHistory();
+                ImGui::PlotLines("Scale", scaleHistory.data(), static_cast<int>(scaleHistory.size()),
+                                 m_dynamicResolution->GetHistoryOffset(), nullptr, 0.0f, 1.0f, ImVec2(0, 40));
+                ImGui::PlotLines("GPU ms", frameTimeHistory.data(), static_cast<int>(frameTimeHistory.size()),
+                                 m_dynamicResolution->GetHistoryOffset(), nullptr, 0.0f, resolution.targetFrameTimeMs * 2.0f, ImVec2(0, 40));
+
+                ImGui::SeparatorText("CPU Profiler");
+                ImGui::SliderInt("Capture Frames", &m_captureFrameCount, 1, 600);
+                if (core::Profiler::GetRemainingFrames() > 0)
+                    ImGui::Text("Capturing, %d frames left", core::Profiler::GetRemainingFrames());
+                else if (ImGui::Button("Capture (F9)"))
+                    core::Profiler::CaptureFrames(m_captureFrameCount);
+                if (!core::Profiler::GetLastTracePath().empty())
+                    ImGui::Text("Last trace: %s", core::Profiler::GetLastTracePath().c_str());
+                ImGui::EndMenu();
+            }
             if (ImGui::BeginMenu("Extra Options"))
             {
                 ImGui::DragFloat("Font Scale", &ImGui::GetIO().FontGlobalScale, 0.01f, 0.5f, 3.0f);
@@ -401,18 +559,24 @@ namespace editor
 
     void Editor::draw()
     {
+        FINALENGINE_PROFILE_FUNCTION();
         drawDockspace();
         drawMainMenu();
 
         for (auto& p : m_panels)
-            if (p->isVisible)
-                p->draw(editorCtx);
+        {
+            if (!p->isVisible) continue;
+
+            FINALENGINE_PROFILE_ZONE(p->name());
+            p->draw(editorCtx);
+        }
 
         ImGui::End(); // DockSpaceHost
     }
 
     void Editor::endFrame()
     {
+        FINALENGINE_PROFILE_FUNCTION();
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     }
@@ -430,106 +594,7 @@ namespace editor
             return;
         }
 
-        printf("[EDITOR] Registering default scenes...\n");
-
-        // Load shaders for default scenes
-        m_modelShader = std::make_unique<core::Shader>("assets/shaders/vertex.vert", "assets/shaders/fragment.frag");
-        m_textureShader = std::make_unique<core::Shader>("assets/shaders/vertex.vert", "assets/shaders/texture.frag");
-        m_lightBulbShader = std::make_unique<core::Shader>("assets/shaders/vertex.vert", "assets/shaders/fragmentLightBulb.frag");
-        m_litSurfaceShader = std::make_unique<core::Shader>("assets/shaders/vertex.vert", "assets/shaders/litFragment.frag");
-
-        // Register Default Scene 1
-        editorCtx.sceneManager->RegisterScene("Default Scene 1", [this](auto scene) {
-            auto rockGO = scene->CreateObject("Rock");
-            core::Model rockModel = core::AssimpLoader::loadModel("assets/models/rockModel.fbx");
-            auto rockMaterial = std::make_shared<core::Material>(m_litSurfaceShader->ID);
-
-            auto rockRenderer = rockGO->AddComponent<core::Renderer>();
-            auto rockTexture = std::make_shared<core::Texture>("assets/textures/rockTexture.jpeg");
-            auto rockAO = std::make_shared<core::Texture>("assets/textures/rockAO.jpeg");
-            auto rockNormal = std::make_shared<core::Texture>("assets/textures/rockNormal.jpeg");
-            rockMaterial->SetTexture("albedoMap", rockTexture, 0);
-            rockMaterial->SetTexture("aoMap", rockAO, 1);
-            rockMaterial->SetTexture("normalMap", rockNormal, 2);
-            rockMaterial->SetBool("useNormalMap", true);
-            rockRenderer->SetMeshes(rockModel.GetMeshes());
-            rockRenderer->SetMaterial(rockMaterial);
-            rockGO->transform->rotation = glm::vec3(-90, 0, 0);
-            rockGO->transform->scale = glm::vec3(0.3f, 0.3f, 0.3f);
-
-            auto suzanneGO = scene->CreateObject("Suzanne");
-            core::Model suzanneModel = core::AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
-            auto suzanneMaterial = std::make_shared<core::Material>(m_litSurfaceShader->ID);
-            suzanneMaterial->SetBool("useNormalMap", false);
-            auto suzanneRenderer = suzanneGO->AddComponent<core::Renderer>();
-            suzanneRenderer->SetMeshes(suzanneModel.GetMeshes());
-            suzanneRenderer->SetMaterial(suzanneMaterial);
-
-            auto quadGO = scene->CreateObject("Quad");
-            quadGO->SetParent(suzanneGO);
-            quadGO->transform->position = glm::vec3(0, 0, -2.5f);
-            quadGO->transform->scale = glm::vec3(5, 5, 1);
-            core::Mesh quadMesh = core::Mesh::GenerateQuad();
-            auto quadTexture = std::make_shared<core::Texture>("assets/textures/CMGaTo_crop.png");
-            auto quadMaterial = std::make_shared<core::Material>(m_textureShader->ID);
-            quadMaterial->SetTexture("text", quadTexture, 0);
-            auto quadRenderer = quadGO->AddComponent<core::Renderer>();
-            quadRenderer->SetMesh(quadMesh);
-            quadRenderer->SetMaterial(quadMaterial);
-
-            auto lightGO = scene->CreateObject("Light");
-            core::Model lightModel = core::AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
-            auto lightMaterial = std::make_shared<core::Material>(m_lightBulbShader->ID);
-            auto lightRenderer = lightGO->AddComponent<core::Renderer>();
-            lightRenderer->SetMeshes(lightModel.GetMeshes());
-            lightRenderer->SetMaterial(lightMaterial);
-            lightGO->transform->position = glm::vec3(2.0f, 2.0f, 2.0f);
-            lightGO->transform->scale = glm::vec3(.1f, .1f, .1f);
-            auto lightComp = lightGO->AddComponent<core::Light>();
-            lightComp->color = glm::vec4(1.0f, 0.8f, 0.2f, 1.0f);
-        });
-
-        // Register Default Scene 2
-        editorCtx.sceneManager->RegisterScene("Default Scene 2", [this](auto scene) {
-            auto suzanneGO = scene->CreateObject("Suzanne1");
-            core::Model suzanneModel = core::AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
-            auto suzanneMaterial = std::make_shared<core::Material>(m_litSurfaceShader->ID);
-            auto suzanneRenderer = suzanneGO->AddComponent<core::Renderer>();
-            suzanneRenderer->SetMeshes(suzanneModel.GetMeshes());
-            suzanneRenderer->SetMaterial(suzanneMaterial);
-
-            auto suzanneGO2 = scene->CreateObject("Suzanne2");
-            suzanneGO2->transform->position = glm::vec3(3, 0, 0);
-            core::Model suzanneModel2 = core::AssimpLoader::loadModel("assets/models/nonormalmonkey.obj");
-            auto suzanneMaterial2 = std::make_shared<core::Material>(m_litSurfaceShader->ID);
-            auto suzanneRenderer2 = suzanneGO2->AddComponent<core::Renderer>();
-            suzanneRenderer2->SetMeshes(suzanneModel2.GetMeshes());
-            suzanneRenderer2->SetMaterial(suzanneMaterial2);
-
-            auto lightGO = scene->CreateObject("Light");
-            core::Model lightModel = core::AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
-            auto lightMaterial = std::make_shared<core::Material>(m_lightBulbShader->ID);
-            auto lightRenderer = lightGO->AddComponent<core::Renderer>();
-            lightRenderer->SetMeshes(lightModel.GetMeshes());
-            lightRenderer->SetMaterial(lightMaterial);
-            lightGO->transform->position = glm::vec3(2.0f, 2.0f, 2.0f);
-            lightGO->transform->scale = glm::vec3(.1f, .1f, .1f);
-            auto lightComp = lightGO->AddComponent<core::Light>();
-            lightComp->color = glm::vec4(1.0f, 0.8f, 0.2f, 1.0f);
-
-            auto lightGO2 = scene->CreateObject("Light2");
-            core::Model lightModel2 = core::AssimpLoader::loadModel("assets/models/lightBulbModel.obj");
-            auto lightMaterial2 = std::make_shared<core::Material>(m_lightBulbShader->ID);
-            auto lightRenderer2 = lightGO2->AddComponent<core::Renderer>();
-            lightRenderer2->SetMeshes(lightModel2.GetMeshes());
-            lightRenderer2->SetMaterial(lightMaterial2);
-            lightGO2->transform->position = glm::vec3(-2.0f, 0, -2.0f);
-            lightGO2->transform->scale = glm::vec3(.1f, .1f, .1f);
-            auto lightComp2 = lightGO2->AddComponent<core::Light>();
-            lightComp2->color = glm::vec4(0.2f, 0.8f, 1.0f, 1.0f);
-        });
-
-        printf("[EDITOR] Default scenes registered\n");
+        core::DefaultScenes::Register(*editorCtx.sceneManager);
     }
 
     bool Editor::tryLoadSavedScene()
@@ -1,8 +1,11 @@
 #pragma once
 #include <core/camera.h>
+#include <core/rendering/dynamicResolution.h>
 #include <core/rendering/frameBuffer.h>
+#include <core/rendering/frameGraph.h>
 #include <core/rendering/postProcessing/postProcessingManager.h>
 #include <core/rendering/shader.h>
+#include <core/rendering/shaderVariants.h>
 #include <editor/inputManager.h>
 #include <editor/panel.h>
 #include <glad/glad.h>
@@ -80,12 +83,10 @@ namespace editor
         std::unique_ptr<core::Camera> m_editorCamera;
         std::unique_ptr<core::FrameBuffer> m_sceneRenderBuffer;
         GLuint m_uboLights = 0;
-
-        // Shaders for default scenes
-        std::unique_ptr<core::Shader> m_modelShader;
-        std::unique_ptr<core::Shader> m_textureShader;
-        std::unique_ptr<core::Shader> m_lightBulbShader;
-        std::unique_ptr<core::Shader> m_litSurfaceShader;
+        bool m_depthPrepass = true;     // Applied to the current scene every frame
+        core::FrameGraph m_frameGraph;  // Rebuilt every frame in renderScene
+        std::unique_ptr<core::DynamicResolution> m_dynamicResolution;
+        int m_captureFrameCount = 120;  // Frames recorded by the CPU profiler on F9
 
         friend class ViewportPanel;
     };
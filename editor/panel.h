@@ -16,7 +16,6 @@ namespace editor
     {
         // Scene Management
         std::shared_ptr<core::SceneManager> sceneManager = nullptr;
-        std::shared_ptr<core::Scene> currentScene = nullptr;
 
         // Selection
         std::shared_ptr<core::GameObject> currentSelectedGameObject = nullptr;
@@ -11,16 +11,13 @@ namespace editor
         if (ImGui::BeginPopupContextItem())
         {
             if (ImGui::MenuItem("Add Child")) {
-                auto newChild = core::GameObject::Create("New Child");
-                newChild->SetParent(std::static_pointer_cast<core::GameObject>(go->shared_from_this()));
+                if (auto scene = go->GetScene())
+                    scene->CreateObject("New Child", std::static_pointer_cast<core::GameObject>(go->shared_from_this()));
                 ImGui::CloseCurrentPopup();
             }
             if (ImGui::MenuItem("Duplicate")) { 
-                auto newDuplicate = core::GameObject::Create(go->GetName() + " Copy");
-                if (auto parent = go->GetParent().lock())
-                    newDuplicate->SetParent(parent);
-                else
-                    newDuplicate->SetParent(nullptr);
+                if (auto scene = go->GetScene())
+                    scene->CreateObject(go->GetName() + " Copy", go->GetParent().lock());
                 
                 // TODO: Deep copy components and children.
 
@@ -44,8 +41,7 @@ namespace editor
             {
                 if (ImGui::MenuItem("Create Empty GameObject"))
                 {
-                    auto newObject = core::GameObject::Create("New GameObject");
-                    currentScene->AddRootGameObject(newObject);
+                    auto newObject = currentScene->CreateObject("New GameObject");
                     ctx.currentSelectedGameObject = newObject;
                     ImGui::CloseCurrentPopup();
                 }
@@ -57,12 +53,11 @@ namespace editor
                 {
                     if (ImGui::MenuItem("Light"))
                     {
-                        auto newObject = core::GameObject::Create("Light");
+                        auto newObject = currentScene->CreateObject("Light");
                         
                         auto light = core::ComponentFactory::Create("Light");
                         if (light) newObject->AddComponent(light); // When gizmos are implemented, the light gizmo can show the lights position (currently it will be invisible).
 
-                        currentScene->AddRootGameObject(newObject);
                         ctx.currentSelectedGameObject = newObject;
                     }
 
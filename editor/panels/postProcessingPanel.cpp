@@ -27,6 +27,17 @@ namespace editor
         }
 
         ImGui::Text("Post Processing Stack");
+
+        bool fusion = m_postProcessingManager->GetFusion();
+        if (ImGui::Checkbox("Fuse Per-Pixel Effects", &fusion))
+            m_postProcessingManager->SetFusion(fusion);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Runs consecutive per-pixel effects in a single generated pass");
+        if (fusion)
+        {
+            ImGui::Text("Passes saved: %d, fused programs: %zu",
+                        m_postProcessingManager->GetFusedPassesSaved(), m_postProcessingManager->GetFusedProgramCount());
+        }
         ImGui::Separator();
 
         auto effects = m_postProcessingManager->GetEffects();
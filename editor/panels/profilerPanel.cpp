@@ -0,0 +1,73 @@
+#include "profilerPanel.h"
+#include <core/rendering/gpuProfiler.h>
+#include <imgui.h>
+
+namespace editor
+{
+    ProfilerPanel::ProfilerPanel()
+        : Panel("GPU Profiler", true)
+    {
+    }
+
+    void ProfilerPanel::draw(EditorContext& ctx)
+    {
+        if (!ImGui::Begin(name(), &isVisible))
+        {
+            ImGui::End();
+            return;
+        }
+
+        bool enabled = core::GpuProfiler::IsEnabled();
+        if (ImGui::Checkbox("Enabled", &enabled))
+            core::GpuProfiler::SetEnabled(enabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Reset"))
+            core::GpuProfiler::Reset();
+
+        ImGui::Text("Results read back %d frames late, %d frames dropped",
+                    core::GpuProfiler::FRAME_LATENCY, core::GpuProfiler::GetDroppedFrames());
+
+        ImGui::InputText("##csvPath", m_csvPath, sizeof(m_csvPath));
+        ImGui::SameLine();
+        if (ImGui::Button("Export CSV"))
+            m_exportStatus = core::GpuProfiler::ExportCsv(m_csvPath) ? std::string("Wrote ") + m_csvPath : std::string("Export failed");
+        if (!m_exportStatus.empty())
+            ImGui::TextDisabled("%s", m_exportStatus.c_str());
+
+        ImGui::Separator();
+
+        const auto& passes = core::GpuProfiler::GetPasses();
+        if (passes.empty())
+        {
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No passes recorded yet.");
+        }
+        else if (ImGui::BeginTable("GpuPasses", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp))
+        {
+            ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+            ImGui::TableSetupColumn("Avg ms");
+            ImGui::TableSetupColumn("P50");
+            ImGui::TableSetupColumn("P95");
+            ImGui::TableSetupColumn("P99");
+            ImGui::TableSetupColumn("Max");
+            ImGui::TableHeadersRow();
+
+            for (const auto& pass : passes)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Indent(pass.depth * 12.0f + 1.0f);
+                ImGui::TextUnformatted(pass.name.c_str());
+                ImGui::Unindent(pass.depth * 12.0f + 1.0f);
+
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GetAverage());
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GetPercentile(50.0f));
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GetPercentile(95.0f));
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GetPercentile(99.0f));
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", pass.GetMax());
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+} // namespace editor
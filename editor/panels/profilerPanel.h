@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../panel.h"
+#include <string>
+
+namespace editor
+{
+    /// <summary>
+    /// Shows the GPU time of every profiled pass (see core::GpuProfiler) with its rolling
+    /// average and percentiles, and exports them as CSV.
+    /// </summary>
+    class ProfilerPanel : public Panel
+    {
+    public:
+        ProfilerPanel();
+        ~ProfilerPanel() = default;
+
+        void draw(EditorContext& ctx) override;
+
+    private:
+        char m_csvPath[256] = "gpuProfile.csv";
+        std::string m_exportStatus;
+    };
+} // namespace editor
@@ -33,14 +33,14 @@ namespace editor
 
         m_focused = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
 
-        // Draw the color attachment (flip v)
+        // Draw the used part of the color attachment (flip v)
         if (m_frameBuffer.IsValid())
         {
             ImGui::Image(
                 (ImTextureID)(intptr_t)m_frameBuffer.GetColorAttachment(),
                 avail,
-                ImVec2(0, 1),
-                ImVec2(1, 0)
+                ImVec2(0, m_frameBuffer.GetUVScaleY()),
+                ImVec2(m_frameBuffer.GetUVScaleX(), 0)
             );
         }
 
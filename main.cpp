@@ -1,9 +1,22 @@
-﻿#include "editor/Editor.h"
+﻿#include "core/profiler.h"
+#include "editor/Editor.h"
+#include <cstdlib>
+#include <cstring>
 
 using namespace editor;
 
-int main()
+int main(int argc, char** argv)
 {
+    // --capture-frames N records a CPU trace of the first N frames, startup included
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--capture-frames") == 0)
+        {
+            core::Profiler::CaptureFrames(std::atoi(argv[i + 1]));
+            core::Profiler::EndFrame();
+        }
+    }
+
     Editor editor;
     
     if (!editor.init("#version 430"))